@@ -0,0 +1,134 @@
+/*
+ *
+ * Copyright (C) 2024 Intel Corporation
+ *
+ * Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+ * See LICENSE.TXT
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ *
+ * @file benchmark.hpp
+ *
+ * Minimal timing and reporting helpers shared by the microbenchmarks.
+ *
+ */
+
+#ifndef UR_BENCHMARK_HPP
+#define UR_BENCHMARK_HPP 1
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace ur_bench {
+
+using clock = std::chrono::steady_clock;
+
+inline uint64_t elapsed_ns(clock::time_point start, clock::time_point end) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count());
+}
+
+struct options {
+    size_t repetitions = 10;
+    size_t scale = 1;
+    bool json = false;
+
+    // Accepts --repetitions=N, --scale=N and --json, everything else is
+    // ignored so that individual benchmarks can add their own arguments.
+    static options parse(int argc, char *argv[]) {
+        options opts;
+        for (int i = 1; i < argc; i++) {
+            if (std::strncmp(argv[i], "--repetitions=", 14) == 0) {
+                opts.repetitions = std::strtoull(argv[i] + 14, nullptr, 10);
+            } else if (std::strncmp(argv[i], "--scale=", 8) == 0) {
+                opts.scale = std::strtoull(argv[i] + 8, nullptr, 10);
+            } else if (std::strcmp(argv[i], "--json") == 0) {
+                opts.json = true;
+            }
+        }
+        opts.repetitions = std::max<size_t>(opts.repetitions, 1);
+        opts.scale = std::max<size_t>(opts.scale, 1);
+        return opts;
+    }
+};
+
+// Runs `fn` `repetitions` times and returns the median wall time in
+// nanoseconds.
+template <typename F> uint64_t measure(size_t repetitions, F &&fn) {
+    std::vector<uint64_t> samples;
+    samples.reserve(repetitions);
+    for (size_t i = 0; i < repetitions; i++) {
+        auto start = clock::now();
+        fn();
+        samples.push_back(elapsed_ns(start, clock::now()));
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+struct result {
+    std::string name;
+    double value;
+    std::string unit;
+};
+
+class reporter {
+  public:
+    void add(std::string name, double value, std::string unit) {
+        results.push_back({std::move(name), value, std::move(unit)});
+    }
+
+    // Prints the results as a table, or as a JSON array of objects with
+    // "name", "value" and "unit" members so that runs can be compared by
+    // scripts.
+    void print(const options &opts) const {
+        if (opts.json) {
+            print_json();
+            return;
+        }
+        size_t width = 0;
+        for (const auto &r : results) {
+            width = std::max(width, r.name.size());
+        }
+        for (const auto &r : results) {
+            std::printf("%-*s %14.3f %s\n", static_cast<int>(width),
+                        r.name.c_str(), r.value, r.unit.c_str());
+        }
+    }
+
+  private:
+    void print_json() const {
+        std::printf("[\n");
+        for (size_t i = 0; i < results.size(); i++) {
+            std::printf("  {\"name\": \"%s\", \"value\": %.3f, "
+                        "\"unit\": \"%s\"}%s\n",
+                        escape(results[i].name).c_str(), results[i].value,
+                        escape(results[i].unit).c_str(),
+                        i + 1 < results.size() ? "," : "");
+        }
+        std::printf("]\n");
+    }
+
+    static std::string escape(const std::string &str) {
+        std::string escaped;
+        for (char c : str) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    std::vector<result> results;
+};
+
+} // namespace ur_bench
+
+#endif // UR_BENCHMARK_HPP
@@ -0,0 +1,298 @@
+/*
+ *
+ * Copyright (C) 2024 Intel Corporation
+ *
+ * Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+ * See LICENSE.TXT
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ *
+ * @file api_overhead.cpp
+ *
+ * Measures what the loader and the layers cost per call. Hot entry points are
+ * called on the mock adapter, which does next to no work, so the time is
+ * spent dispatching through the loader and whichever layers are enabled.
+ * Every configuration reports the median latency of a single call and the
+ * throughput of the calls made from an increasing number of host threads.
+ *
+ * Configurations can be selected with --configs=name[,name...]. Layers that
+ * weren't built are skipped, and so are entry points that a configuration
+ * can't serve on the mock adapter.
+ *
+ */
+
+#include "benchmark.hpp"
+#include "ur_api.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define UR_BENCH_CHECK(call)                                                   \
+    do {                                                                       \
+        ur_result_t result = (call);                                           \
+        if (result != UR_RESULT_SUCCESS) {                                     \
+            std::fprintf(stderr, "%s failed with %d (%s:%d)\n", #call,         \
+                         static_cast<int>(result), __FILE__, __LINE__);        \
+            std::exit(1);                                                      \
+        }                                                                      \
+    } while (0)
+
+namespace {
+
+struct configuration {
+    const char *name;
+    // Layer to enable, if any
+    const char *layer;
+    // Whether the loader translates handles, as it does with several
+    // adapters, rather than handing out the adapter's DDI tables.
+    bool intercept;
+};
+
+constexpr configuration configurations[] = {
+    {"passthrough", nullptr, false},
+    {"intercept", nullptr, true},
+    {"validation", "UR_LAYER_PARAMETER_VALIDATION", false},
+    {"tracing", "UR_LAYER_TRACING", false},
+    {"sanitizer", "UR_LAYER_ASAN", false},
+};
+
+// The objects the entry points are called on. Every thread gets its own
+// kernel, since setting kernel arguments isn't thread-safe.
+struct environment {
+    ur_loader_config_handle_t config = nullptr;
+    ur_adapter_handle_t adapter = nullptr;
+    ur_platform_handle_t platform = nullptr;
+    ur_device_handle_t device = nullptr;
+    ur_context_handle_t context = nullptr;
+    ur_queue_handle_t queue = nullptr;
+    ur_program_handle_t program = nullptr;
+    std::vector<ur_kernel_handle_t> kernels;
+};
+
+void set_intercept(bool intercept) {
+#ifdef _WIN32
+    _putenv_s("UR_ENABLE_LOADER_INTERCEPT", intercept ? "1" : "0");
+#else
+    setenv("UR_ENABLE_LOADER_INTERCEPT", intercept ? "1" : "0", 1);
+#endif
+}
+
+// Initializes the loader for `config` and creates the objects in `env`.
+// Returns false if the configuration's layer isn't available.
+bool setup(const configuration &config, size_t numKernels, environment &env) {
+    UR_BENCH_CHECK(urLoaderConfigCreate(&env.config));
+    UR_BENCH_CHECK(urLoaderConfigSetMockingEnabled(env.config, true));
+    if (config.layer) {
+        ur_result_t result =
+            urLoaderConfigEnableLayer(env.config, config.layer);
+        if (result == UR_RESULT_ERROR_LAYER_NOT_PRESENT) {
+            urLoaderConfigRelease(env.config);
+            return false;
+        }
+        UR_BENCH_CHECK(result);
+    }
+    set_intercept(config.intercept);
+    UR_BENCH_CHECK(urLoaderInit(0, env.config));
+
+    UR_BENCH_CHECK(urAdapterGet(1, &env.adapter, nullptr));
+    UR_BENCH_CHECK(urPlatformGet(&env.adapter, 1, 1, &env.platform, nullptr));
+    UR_BENCH_CHECK(urDeviceGet(env.platform, UR_DEVICE_TYPE_ALL, 1,
+                               &env.device, nullptr));
+    UR_BENCH_CHECK(urContextCreate(1, &env.device, nullptr, &env.context));
+    UR_BENCH_CHECK(
+        urQueueCreate(env.context, env.device, nullptr, &env.queue));
+
+    const unsigned char il[] = {0x03, 0x02, 0x23, 0x07};
+    UR_BENCH_CHECK(urProgramCreateWithIL(env.context, il, sizeof(il),
+                                         nullptr, &env.program));
+    env.kernels.resize(numKernels);
+    for (auto &kernel : env.kernels) {
+        UR_BENCH_CHECK(urKernelCreate(env.program, "bench", &kernel));
+    }
+    return true;
+}
+
+void teardown(environment &env) {
+    for (auto kernel : env.kernels) {
+        urKernelRelease(kernel);
+    }
+    urProgramRelease(env.program);
+    urQueueRelease(env.queue);
+    urContextRelease(env.context);
+    urDeviceRelease(env.device);
+    urAdapterRelease(env.adapter);
+    urLoaderTearDown();
+    urLoaderConfigRelease(env.config);
+    env = environment{};
+}
+
+ur_result_t enqueue_launch(const environment &env, size_t thread) {
+    const size_t globalSize = 1;
+    return urEnqueueKernelLaunch(env.queue, env.kernels[thread], 1, nullptr,
+                                 &globalSize, nullptr, 0, nullptr, nullptr);
+}
+
+ur_result_t event_create_release(const environment &env, size_t) {
+    ur_event_handle_t event;
+    ur_result_t result = urEnqueueEventsWait(env.queue, 0, nullptr, &event);
+    if (result != UR_RESULT_SUCCESS) {
+        return result;
+    }
+    return urEventRelease(event);
+}
+
+ur_result_t usm_alloc_free(const environment &env, size_t) {
+    void *ptr;
+    ur_result_t result =
+        urUSMDeviceAlloc(env.context, env.device, nullptr, nullptr, 64, &ptr);
+    if (result != UR_RESULT_SUCCESS) {
+        return result;
+    }
+    return urUSMFree(env.context, ptr);
+}
+
+ur_result_t set_arg(const environment &env, size_t thread) {
+    const int value = 42;
+    return urKernelSetArgValue(env.kernels[thread], 0, sizeof(value), nullptr,
+                               &value);
+}
+
+struct entry_point {
+    const char *name;
+    ur_result_t (*call)(const environment &, size_t);
+};
+
+constexpr entry_point entryPoints[] = {
+    {"enqueue_kernel_launch", enqueue_launch},
+    {"event_create_release", event_create_release},
+    {"usm_alloc_free", usm_alloc_free},
+    {"kernel_set_arg", set_arg},
+};
+
+// Makes `numCalls` calls on behalf of `thread`, stopping at the first one
+// that fails.
+ur_result_t run_calls(const entry_point &entry, const environment &env,
+                      size_t thread, size_t numCalls) {
+    for (size_t i = 0; i < numCalls; i++) {
+        ur_result_t result = entry.call(env, thread);
+        if (result != UR_RESULT_SUCCESS) {
+            return result;
+        }
+    }
+    return UR_RESULT_SUCCESS;
+}
+
+bool is_selected(const std::vector<std::string> &selected,
+                 const char *name) {
+    return selected.empty() ||
+           std::find(selected.begin(), selected.end(), name) !=
+               selected.end();
+}
+
+std::vector<std::string> parse_configs(int argc, char *argv[]) {
+    std::vector<std::string> selected;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--configs=", 10) != 0) {
+            continue;
+        }
+        std::string list = argv[i] + 10;
+        size_t start = 0;
+        while (start <= list.size()) {
+            size_t end = std::min(list.find(',', start), list.size());
+            if (end > start) {
+                selected.push_back(list.substr(start, end - start));
+            }
+            start = end + 1;
+        }
+    }
+    return selected;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    auto opts = ur_bench::options::parse(argc, argv);
+    auto selected = parse_configs(argc, argv);
+
+    const size_t callsPerRepetition = 10000 * opts.scale;
+    const size_t callsPerThread = 100000 * opts.scale;
+    const size_t maxThreads =
+        std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    ur_bench::reporter report;
+    for (const auto &config : configurations) {
+        if (!is_selected(selected, config.name)) {
+            continue;
+        }
+        environment env;
+        if (!setup(config, maxThreads, env)) {
+            std::fprintf(stderr, "%s: skipped, %s isn't available\n",
+                         config.name, config.layer);
+            continue;
+        }
+
+        for (const auto &entry : entryPoints) {
+            std::string name = std::string(config.name) + "/" + entry.name;
+            if (ur_result_t result = run_calls(entry, env, 0, 1);
+                result != UR_RESULT_SUCCESS) {
+                std::fprintf(stderr, "%s: skipped, failed with %d\n",
+                             name.c_str(), static_cast<int>(result));
+                continue;
+            }
+
+            ur_result_t result = UR_RESULT_SUCCESS;
+            uint64_t ns = ur_bench::measure(opts.repetitions, [&]() {
+                result = run_calls(entry, env, 0, callsPerRepetition);
+            });
+            if (result == UR_RESULT_SUCCESS) {
+                report.add(name + "/latency",
+                           double(ns) / callsPerRepetition, "ns");
+            }
+
+            for (size_t numThreads = 1; result == UR_RESULT_SUCCESS;
+                 numThreads = std::min(numThreads * 2, maxThreads)) {
+                std::vector<ur_result_t> results(numThreads);
+                ns = ur_bench::measure(opts.repetitions, [&]() {
+                    std::vector<std::thread> threads;
+                    for (size_t i = 0; i < numThreads; i++) {
+                        threads.emplace_back([&, i]() {
+                            results[i] =
+                                run_calls(entry, env, i, callsPerThread);
+                        });
+                    }
+                    for (auto &t : threads) {
+                        t.join();
+                    }
+                });
+                for (auto threadResult : results) {
+                    if (threadResult != UR_RESULT_SUCCESS) {
+                        result = threadResult;
+                    }
+                }
+                if (result != UR_RESULT_SUCCESS) {
+                    break;
+                }
+                const double numCalls = double(callsPerThread) * numThreads;
+                report.add(name + "/threads=" + std::to_string(numThreads) +
+                               "/throughput",
+                           numCalls / (ns / 1e3), "Mcalls/s");
+                if (numThreads == maxThreads) {
+                    break;
+                }
+            }
+            if (result != UR_RESULT_SUCCESS) {
+                std::fprintf(stderr, "%s: a call failed with %d\n",
+                             name.c_str(), static_cast<int>(result));
+            }
+        }
+
+        teardown(env);
+    }
+
+    report.print(opts);
+    return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ *
+ * Copyright (C) 2024 Intel Corporation
+ *
+ * Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+ * See LICENSE.TXT
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ *
+ * @file handles.cpp
+ *
+ * Measures how the throughput of event creation through the loader scales
+ * with the number of host threads. Every thread enqueues event waits on the
+ * mock adapter and releases the events it gets back, so the time is spent in
+ * the loader's intercepts and handle factories rather than in an adapter.
+ * Loader interception is forced on, as it would be with several platforms.
+ *
+ */
+
+#include "benchmark.hpp"
+#include "ur_api.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define UR_BENCH_CHECK(call)                                                   \
+    do {                                                                       \
+        ur_result_t result = (call);                                           \
+        if (result != UR_RESULT_SUCCESS) {                                     \
+            std::fprintf(stderr, "%s failed with %d (%s:%d)\n", #call,         \
+                         static_cast<int>(result), __FILE__, __LINE__);        \
+            std::exit(1);                                                      \
+        }                                                                      \
+    } while (0)
+
+namespace {
+
+void create_events(ur_queue_handle_t queue, size_t numEvents) {
+    for (size_t i = 0; i < numEvents; i++) {
+        ur_event_handle_t event;
+        UR_BENCH_CHECK(urEnqueueEventsWait(queue, 0, nullptr, &event));
+        UR_BENCH_CHECK(urEventRelease(event));
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    auto opts = ur_bench::options::parse(argc, argv);
+
+#ifdef _WIN32
+    _putenv_s("UR_ENABLE_LOADER_INTERCEPT", "1");
+#else
+    setenv("UR_ENABLE_LOADER_INTERCEPT", "1", 1);
+#endif
+
+    ur_loader_config_handle_t config;
+    UR_BENCH_CHECK(urLoaderConfigCreate(&config));
+    UR_BENCH_CHECK(urLoaderConfigSetMockingEnabled(config, true));
+    UR_BENCH_CHECK(urLoaderInit(0, config));
+
+    ur_adapter_handle_t adapter;
+    ur_platform_handle_t platform;
+    ur_device_handle_t device;
+    ur_context_handle_t context;
+    ur_queue_handle_t queue;
+    UR_BENCH_CHECK(urAdapterGet(1, &adapter, nullptr));
+    UR_BENCH_CHECK(urPlatformGet(&adapter, 1, 1, &platform, nullptr));
+    UR_BENCH_CHECK(
+        urDeviceGet(platform, UR_DEVICE_TYPE_ALL, 1, &device, nullptr));
+    UR_BENCH_CHECK(urContextCreate(1, &device, nullptr, &context));
+    UR_BENCH_CHECK(urQueueCreate(context, device, nullptr, &queue));
+
+    const size_t eventsPerThread = 100000 * opts.scale;
+    const size_t maxThreads =
+        std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    ur_bench::reporter report;
+    for (size_t numThreads = 1;; numThreads = std::min(numThreads * 2,
+                                                       maxThreads)) {
+        uint64_t ns = ur_bench::measure(opts.repetitions, [&]() {
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < numThreads; i++) {
+                threads.emplace_back(create_events, queue, eventsPerThread);
+            }
+            for (auto &t : threads) {
+                t.join();
+            }
+        });
+        const double numEvents = double(eventsPerThread) * numThreads;
+        std::string name = "events/threads=" + std::to_string(numThreads);
+        report.add(name + "/throughput", numEvents / (ns / 1e3), "Mevents/s");
+        report.add(name + "/per_event", ns / numEvents * numThreads, "ns");
+        if (numThreads == maxThreads) {
+            break;
+        }
+    }
+
+    urQueueRelease(queue);
+    urContextRelease(context);
+    urAdapterRelease(adapter);
+    urLoaderConfigRelease(config);
+    urLoaderTearDown();
+
+    report.print(opts);
+    return 0;
+}
@@ -0,0 +1,78 @@
+/*
+ *
+ * Copyright (C) 2024 Intel Corporation
+ *
+ * Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+ * See LICENSE.TXT
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ *
+ * @file launch.cpp
+ *
+ * Measures the overhead of nd_range launches in the native_cpu adapter by
+ * launching an empty kernel over an increasing number of work-groups and
+ * reporting the time spent per work-group, and the fixed cost of a launch
+ * by enqueueing many small launches back to back.
+ *
+ */
+
+#include "benchmark.hpp"
+#include "native_cpu_env.hpp"
+
+#include <string>
+
+namespace {
+
+void empty_kernel(const ur_bench::kernel_arg *, native_cpu::state *) {}
+
+const ur_bench::kernel_entry entries[] = {
+    ur_bench::make_entry("empty", &empty_kernel),
+    {nullptr, nullptr},
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    auto opts = ur_bench::options::parse(argc, argv);
+
+    ur_bench::native_cpu_env env;
+    ur_kernel_handle_t kernel = env.create_kernel(entries, "empty");
+
+    ur_bench::reporter report;
+    const size_t localSize = 4;
+    for (size_t numGroups : {size_t{1} << 10, size_t{1} << 14, size_t{1} << 18,
+                             size_t{1} << 20}) {
+        numGroups *= opts.scale;
+        size_t offset = 0;
+        size_t globalSize = numGroups * localSize;
+        uint64_t ns = ur_bench::measure(opts.repetitions, [&]() {
+            UR_BENCH_CHECK(urEnqueueKernelLaunch(env.queue, kernel, 1, &offset,
+                                                 &globalSize, &localSize, 0,
+                                                 nullptr, nullptr));
+            UR_BENCH_CHECK(urQueueFinish(env.queue));
+        });
+        std::string name = "nd_range/" + std::to_string(numGroups);
+        report.add(name + "/total", ns / 1e3, "us");
+        report.add(name + "/per_group", double(ns) / numGroups, "ns");
+    }
+
+    // Small launches, so that the time is spent on enqueueing, scheduling the
+    // tasks and completing the event rather than in the kernel
+    const size_t numLaunches = 1000 * opts.scale;
+    for (size_t numGroups : {size_t{1}, size_t{64}}) {
+        size_t offset = 0;
+        size_t globalSize = numGroups * localSize;
+        uint64_t ns = ur_bench::measure(opts.repetitions, [&]() {
+            for (size_t i = 0; i < numLaunches; i++) {
+                UR_BENCH_CHECK(urEnqueueKernelLaunch(
+                    env.queue, kernel, 1, &offset, &globalSize, &localSize, 0,
+                    nullptr, nullptr));
+            }
+            UR_BENCH_CHECK(urQueueFinish(env.queue));
+        });
+        report.add("empty_launch/" + std::to_string(numGroups) +
+                       "/per_launch",
+                   double(ns) / numLaunches, "ns");
+    }
+    report.print(opts);
+    return 0;
+}
@@ -0,0 +1,141 @@
+/*
+ *
+ * Copyright (C) 2024 Intel Corporation
+ *
+ * Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+ * See LICENSE.TXT
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ *
+ * @file native_cpu_env.hpp
+ *
+ * Sets up a native_cpu device, context and queue through the loader and
+ * builds programs out of host functions, so that benchmarks can launch
+ * kernels without a SYCL compiler.
+ *
+ */
+
+#ifndef UR_BENCHMARK_NATIVE_CPU_ENV_HPP
+#define UR_BENCHMARK_NATIVE_CPU_ENV_HPP 1
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "nativecpu_state.hpp"
+#include "ur_api.h"
+
+#define UR_BENCH_CHECK(call)                                                   \
+    do {                                                                       \
+        ur_result_t result = (call);                                           \
+        if (result != UR_RESULT_SUCCESS) {                                     \
+            std::fprintf(stderr, "%s failed with %d (%s:%d)\n", #call,         \
+                         static_cast<int>(result), __FILE__, __LINE__);        \
+            std::exit(1);                                                      \
+        }                                                                      \
+    } while (0)
+
+namespace ur_bench {
+
+// Kernel argument as seen by native_cpu kernels.
+struct kernel_arg {
+    void *ptr;
+};
+
+using native_cpu_kernel_t = void(const kernel_arg *, native_cpu::state *);
+
+// Must match nativecpu_entry in the adapter, a program binary is an array of
+// these terminated by a null kernel pointer.
+struct kernel_entry {
+    const char *name;
+    const unsigned char *kernel;
+};
+
+inline kernel_entry make_entry(const char *name, native_cpu_kernel_t *fn) {
+    return {name, reinterpret_cast<const unsigned char *>(fn)};
+}
+
+class native_cpu_env {
+  public:
+    native_cpu_env() {
+        UR_BENCH_CHECK(urLoaderInit(0, nullptr));
+
+        uint32_t adapterCount = 0;
+        UR_BENCH_CHECK(urAdapterGet(0, nullptr, &adapterCount));
+        adapters.resize(adapterCount);
+        UR_BENCH_CHECK(urAdapterGet(adapterCount, adapters.data(), nullptr));
+
+        ur_adapter_handle_t adapter = nullptr;
+        for (auto a : adapters) {
+            ur_adapter_backend_t backend;
+            UR_BENCH_CHECK(urAdapterGetInfo(a, UR_ADAPTER_INFO_BACKEND,
+                                            sizeof(backend), &backend,
+                                            nullptr));
+            if (backend == UR_ADAPTER_BACKEND_NATIVE_CPU) {
+                adapter = a;
+            }
+        }
+        if (!adapter) {
+            std::fprintf(stderr, "native_cpu adapter not found\n");
+            std::exit(1);
+        }
+
+        ur_platform_handle_t platform;
+        UR_BENCH_CHECK(urPlatformGet(&adapter, 1, 1, &platform, nullptr));
+        UR_BENCH_CHECK(
+            urDeviceGet(platform, UR_DEVICE_TYPE_ALL, 1, &device, nullptr));
+        UR_BENCH_CHECK(urContextCreate(1, &device, nullptr, &context));
+        UR_BENCH_CHECK(urQueueCreate(context, device, nullptr, &queue));
+    }
+
+    ~native_cpu_env() {
+        urQueueFinish(queue);
+        for (auto kernel : kernels) {
+            urKernelRelease(kernel);
+        }
+        for (auto program : programs) {
+            urProgramRelease(program);
+        }
+        urQueueRelease(queue);
+        urContextRelease(context);
+        for (auto adapter : adapters) {
+            urAdapterRelease(adapter);
+        }
+        urLoaderTearDown();
+    }
+
+    native_cpu_env(const native_cpu_env &) = delete;
+    native_cpu_env &operator=(const native_cpu_env &) = delete;
+
+    // `entries` must be terminated by a null entry and outlive the
+    // environment.
+    ur_kernel_handle_t create_kernel(const kernel_entry *entries,
+                                     const char *name) {
+        const uint8_t *binary = reinterpret_cast<const uint8_t *>(entries);
+        size_t length = 0;
+        for (auto *e = entries; e->kernel; e++) {
+            length += sizeof(kernel_entry);
+        }
+        ur_program_handle_t program;
+        UR_BENCH_CHECK(urProgramCreateWithBinary(context, 1, &device, &length,
+                                                 &binary, nullptr, &program));
+        programs.push_back(program);
+
+        ur_kernel_handle_t kernel;
+        UR_BENCH_CHECK(urKernelCreate(program, name, &kernel));
+        kernels.push_back(kernel);
+        return kernel;
+    }
+
+    ur_device_handle_t device = nullptr;
+    ur_context_handle_t context = nullptr;
+    ur_queue_handle_t queue = nullptr;
+
+  private:
+    std::vector<ur_adapter_handle_t> adapters;
+    std::vector<ur_program_handle_t> programs;
+    std::vector<ur_kernel_handle_t> kernels;
+};
+
+} // namespace ur_bench
+
+#endif // UR_BENCHMARK_NATIVE_CPU_ENV_HPP
@@ -0,0 +1,136 @@
+/*
+ *
+ * Copyright (C) 2024 Intel Corporation
+ *
+ * Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+ * See LICENSE.TXT
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ *
+ * @file threadpool.cpp
+ *
+ * Compares the native_cpu thread pool implementations on balanced and skewed
+ * workloads. The pools are header only, so they are exercised directly
+ * without going through the adapter. Also measures the bookkeeping of a
+ * launch of one empty task per thread, with a future per task as the adapter
+ * used to do and with a single latch per launch as it does now. Use
+ * SYCL_NATIVE_CPU_HOST_THREADS to change the number of worker threads.
+ *
+ */
+
+#include "benchmark.hpp"
+#include "latch.hpp"
+#include "threadpool.hpp"
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Roughly constant amount of work per unit that the compiler can't remove
+void spin(size_t units) {
+    volatile uint64_t acc = 0;
+    for (size_t i = 0; i < units * 256; i++) {
+        acc = acc + i * 2654435761u;
+    }
+}
+
+struct workload {
+    const char *name;
+    size_t numTasks;
+    // Cost of task `i` in spin units
+    size_t (*cost)(size_t i, size_t numTasks);
+};
+
+size_t balanced_cost(size_t, size_t) { return 16; }
+
+// One task in eight is 32 times more expensive than the others, this mimics
+// nd_range launches where some work-groups exit early and others don't.
+size_t skewed_cost(size_t i, size_t) { return (i % 8 == 0) ? 512 : 16; }
+
+// Scheduling overhead only
+size_t empty_cost(size_t, size_t) { return 0; }
+
+template <typename PoolT>
+uint64_t run_workload(PoolT &pool, const workload &w, size_t repetitions) {
+    return ur_bench::measure(repetitions, [&]() {
+        for (size_t i = 0; i < w.numTasks; i++) {
+            size_t units = w.cost(i, w.numTasks);
+            pool.schedule([units](size_t) { spin(units); });
+        }
+        pool.wait_for_all_pending_tasks();
+    });
+}
+
+template <typename PoolT>
+void run_all(const char *poolName, const std::vector<workload> &workloads,
+             const ur_bench::options &opts, ur_bench::reporter &report) {
+    PoolT pool;
+    for (const auto &w : workloads) {
+        uint64_t ns = run_workload(pool, w, opts.repetitions);
+        std::string name = std::string(poolName) + "/" + w.name;
+        report.add(name + "/total", ns / 1e3, "us");
+        report.add(name + "/per_task", double(ns) / w.numTasks, "ns");
+    }
+}
+
+// Launches of one empty task per thread, waited for one after the other
+void run_launches(const ur_bench::options &opts, ur_bench::reporter &report) {
+    native_cpu::threadpool_t pool;
+    const size_t numTasks = pool.num_threads();
+    const size_t numLaunches = 1000 * opts.scale;
+
+    uint64_t ns = ur_bench::measure(opts.repetitions, [&]() {
+        for (size_t launch = 0; launch < numLaunches; launch++) {
+            std::vector<std::future<void>> futures;
+            for (size_t i = 0; i < numTasks; i++) {
+                auto task =
+                    std::make_shared<std::packaged_task<void(size_t)>>(
+                        [](size_t) {});
+                pool.schedule([task](size_t threadId) { (*task)(threadId); });
+                futures.push_back(task->get_future());
+            }
+            for (auto &f : futures) {
+                f.get();
+            }
+        }
+    });
+    report.add("launch/futures/per_launch", double(ns) / numLaunches, "ns");
+
+    ns = ur_bench::measure(opts.repetitions, [&]() {
+        for (size_t launch = 0; launch < numLaunches; launch++) {
+            native_cpu::latch done(static_cast<uint32_t>(numTasks));
+            native_cpu::worker_task_t task = [&done](size_t) {
+                done.count_down();
+            };
+            pool.schedule_bulk(task, numTasks);
+            done.wait();
+        }
+    });
+    report.add("launch/latch/per_launch", double(ns) / numLaunches, "ns");
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    auto opts = ur_bench::options::parse(argc, argv);
+
+    std::vector<workload> workloads = {
+        {"empty", 10000 * opts.scale, empty_cost},
+        {"balanced", 4096 * opts.scale, balanced_cost},
+        {"skewed", 4096 * opts.scale, skewed_cost},
+    };
+
+    ur_bench::reporter report;
+    run_all<native_cpu::detail::simple_thread_pool>("simple", workloads, opts,
+                                                    report);
+    run_all<native_cpu::detail::work_stealing_thread_pool>(
+        "work_stealing", workloads, opts, report);
+    run_launches(opts, report);
+    report.add("threads", double(native_cpu::detail::get_num_threads()),
+               "threads");
+    report.print(opts);
+    return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ *
+ * Copyright (C) 2024 Intel Corporation
+ *
+ * Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+ * See LICENSE.TXT
+ * SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+ *
+ * @file transfer.cpp
+ *
+ * Measures the bandwidth of native_cpu USM copies and fills, going through
+ * the loader, next to the bandwidth of plain memcpy and memset on the same
+ * memory. Use SYCL_NATIVE_CPU_HOST_THREADS to change the number of threads
+ * the adapter splits large transfers across.
+ *
+ */
+
+#include "benchmark.hpp"
+#include "native_cpu_env.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+double gb_per_s(size_t bytes, uint64_t ns) { return double(bytes) / ns; }
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    auto opts = ur_bench::options::parse(argc, argv);
+
+    ur_bench::native_cpu_env env;
+    const size_t size = (size_t{64} << 20) * opts.scale;
+    void *src = nullptr;
+    void *dst = nullptr;
+    UR_BENCH_CHECK(urUSMHostAlloc(env.context, nullptr, nullptr, size, &src));
+    UR_BENCH_CHECK(urUSMHostAlloc(env.context, nullptr, nullptr, size, &dst));
+    // Touch the pages up front so that neither side pays for page faults
+    std::memset(src, 1, size);
+    std::memset(dst, 0, size);
+
+    ur_bench::reporter report;
+    const std::string sizeName = std::to_string(size >> 20) + "MiB";
+
+    uint64_t ns = ur_bench::measure(opts.repetitions,
+                                    [&]() { std::memcpy(dst, src, size); });
+    report.add("copy/memcpy/" + sizeName, gb_per_s(size, ns), "GB/s");
+    ns = ur_bench::measure(opts.repetitions, [&]() {
+        UR_BENCH_CHECK(urEnqueueUSMMemcpy(env.queue, true, dst, src, size, 0,
+                                          nullptr, nullptr));
+    });
+    report.add("copy/urEnqueueUSMMemcpy/" + sizeName, gb_per_s(size, ns),
+               "GB/s");
+
+    // Half of the rows of a 2D region, so that rows can't be merged
+    const size_t width = 4096;
+    const size_t pitch = 2 * width;
+    const size_t height = size / pitch;
+    ns = ur_bench::measure(opts.repetitions, [&]() {
+        for (size_t row = 0; row < height; row++) {
+            std::memcpy(static_cast<char *>(dst) + row * pitch,
+                        static_cast<char *>(src) + row * pitch, width);
+        }
+    });
+    report.add("copy2d/memcpy_rows/" + sizeName, gb_per_s(width * height, ns),
+               "GB/s");
+    ns = ur_bench::measure(opts.repetitions, [&]() {
+        UR_BENCH_CHECK(urEnqueueUSMMemcpy2D(env.queue, true, dst, pitch, src,
+                                            pitch, width, height, 0, nullptr,
+                                            nullptr));
+    });
+    report.add("copy2d/urEnqueueUSMMemcpy2D/" + sizeName,
+               gb_per_s(width * height, ns), "GB/s");
+
+    ns = ur_bench::measure(opts.repetitions,
+                           [&]() { std::memset(dst, 0x5a, size); });
+    report.add("fill/memset/" + sizeName, gb_per_s(size, ns), "GB/s");
+    for (size_t patternSize : {size_t{1}, size_t{4}, size_t{12}, size_t{64}}) {
+        std::vector<uint8_t> pattern(patternSize);
+        for (size_t i = 0; i < patternSize; i++) {
+            pattern[i] = static_cast<uint8_t>(i * 7 + 1);
+        }
+        const size_t fillSize = size - size % patternSize;
+        ns = ur_bench::measure(opts.repetitions, [&]() {
+            UR_BENCH_CHECK(urEnqueueUSMFill(env.queue, dst, patternSize,
+                                            pattern.data(), fillSize, 0,
+                                            nullptr, nullptr));
+            UR_BENCH_CHECK(urQueueFinish(env.queue));
+        });
+        report.add("fill/urEnqueueUSMFill/pattern" +
+                       std::to_string(patternSize) + "/" + sizeName,
+                   gb_per_s(fillSize, ns), "GB/s");
+    }
+
+    UR_BENCH_CHECK(urUSMFree(env.context, src));
+    UR_BENCH_CHECK(urUSMFree(env.context, dst));
+    report.print(opts);
+    return 0;
+}
@@ -137,7 +137,7 @@ namespace ur_loader
         <%
         add_local = True
         param_replacements[item['name']] = item['name'] + 'Local.data()'%>// convert loader handles to platform handles
-        auto ${item['name']}Local = std::vector<${item['type']}>(${item['range'][1]});
+        local_array_t<${item['type']}> ${item['name']}Local(${item['range'][1]});
         for( size_t i = ${item['range'][0]}; i < ${item['range'][1]}; ++i )
             ${item['name']}Local[ i ] = reinterpret_cast<${item['obj']}*>( ${item['name']}[ i ] )->handle;
         %else:
@@ -202,8 +202,14 @@ namespace ur_loader
                     range_start = struct['name'] + "->" + member['parent'] + range_start
                 range_end = member['range_end']
                 if not re.match(r"[0-9]+$", range_end):
-                    range_end = struct['name'] + "->" + member['parent'] + range_end %>
-                std::vector<${member['type']}> ${range_vector_name};
+                    range_end = struct['name'] + "->" + member['parent'] + range_end
+                if range_start == "0":
+                    range_size = range_end
+                    range_index = "i"
+                else:
+                    range_size = range_end + " - " + range_start
+                    range_index = "i - " + range_start %>
+                local_array_t<${member['type']}> ${range_vector_name}(${range_size});
                 for(uint32_t i = ${range_start}; i < ${range_end}; i++) {
                     ${member['type']} NewRangeStruct = ${struct['name']}Local.${member['parent']}${member['name']}[i];
                     %for handle_member in member['handle_members']:
@@ -216,7 +222,7 @@ namespace ur_loader
                             ->handle;
                     %endfor
 
-                    ${range_vector_name}.push_back(NewRangeStruct);
+                    ${range_vector_name}[${range_index}] = NewRangeStruct;
                 }
                 ${struct['name']}Local.${member['parent']}${member['name']} = ${range_vector_name}.data();
             ## If the member has range_start then its a range of handles
@@ -225,9 +231,9 @@ namespace ur_loader
                 <%
                 parent_no_deref = th.strip_deref(member['parent'])
                 range_vector_name = struct['name'] + parent_no_deref + member['name'] %>
-                std::vector<${member['type']}> ${range_vector_name};
+                local_array_t<${member['type']}> ${range_vector_name}(${struct['name']}->${member['parent']}${member['range_end']});
                 for(uint32_t i = 0;i < ${struct['name']}->${member['parent']}${member['range_end']};i++) {
-                    ${range_vector_name}.push_back(reinterpret_cast<${member['obj_name']}*>(${struct['name']}->${member['parent']}${member['name']}[i])->handle);
+                    ${range_vector_name}[i] = reinterpret_cast<${member['obj_name']}*>(${struct['name']}->${member['parent']}${member['name']}[i])->handle;
                 }
                 ${struct['name']}Local.${member['parent']}${member['name']} = ${range_vector_name}.data();
             %else:
@@ -380,7 +386,7 @@ ${tbl['export']['name']}(
 
     if( ${X}_RESULT_SUCCESS == result )
     {
-        if( ur_loader::getContext()->platforms.size() != 1 || ur_loader::getContext()->forceIntercept )
+        if( ur_loader::getContext()->intercept_enabled )
         {
             // return pointers to loader's DDIs
             %for obj in tbl['functions']:
@@ -8,191 +8,753 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "command_buffer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
 #include "common.hpp"
+#include "event.hpp"
+#include "memory.hpp"
+#include "queue.hpp"
+#include "transfer.hpp"
+#include "usm.hpp"
+
+ur_exp_command_buffer_handle_t_::ur_exp_command_buffer_handle_t_(
+    ur_context_handle_t context, ur_device_handle_t device,
+    const ur_exp_command_buffer_desc_t *pDesc)
+    : context(context), device(device),
+      desc(pDesc ? *pDesc
+                 : ur_exp_command_buffer_desc_t{
+                       UR_STRUCTURE_TYPE_EXP_COMMAND_BUFFER_DESC, nullptr,
+                       false, false, false}) {}
+
+ur_exp_command_buffer_handle_t_::~ur_exp_command_buffer_handle_t_() {
+  // Runs hold a reference, so none can be in flight anymore
+  if (lastSubmission)
+    decrementOrDelete(lastSubmission);
+}
+
+ur_exp_command_buffer_command_handle_t_::
+    ur_exp_command_buffer_command_handle_t_(
+        ur_exp_command_buffer_handle_t commandBuffer, uint32_t node)
+    : commandBuffer(commandBuffer), node(node) {
+  commandBuffer->incrementReferenceCount();
+}
+
+ur_exp_command_buffer_command_handle_t_::
+    ~ur_exp_command_buffer_command_handle_t_() {
+  decrementOrDelete(commandBuffer);
+}
+
+ur_result_t ur_exp_command_buffer_handle_t_::append(
+    std::unique_ptr<native_cpu::command_node> node,
+    uint32_t numSyncPointsInWaitList,
+    const ur_exp_command_buffer_sync_point_t *pSyncPointWaitList,
+    ur_exp_command_buffer_sync_point_t *pSyncPoint,
+    ur_exp_command_buffer_command_handle_t *phCommand) {
+  if (finalized)
+    return UR_RESULT_ERROR_INVALID_OPERATION;
+  UR_ASSERT(pSyncPointWaitList || numSyncPointsInWaitList == 0,
+            UR_RESULT_ERROR_INVALID_COMMAND_BUFFER_SYNC_POINT_WAIT_LIST_EXP);
+
+  const auto index = static_cast<uint32_t>(nodes.size());
+  for (uint32_t i = 0; i < numSyncPointsInWaitList; i++) {
+    if (pSyncPointWaitList[i] >= index)
+      return UR_RESULT_ERROR_INVALID_COMMAND_BUFFER_SYNC_POINT_EXP;
+    node->dependencies.push_back(pSyncPointWaitList[i]);
+  }
+  if (desc.isInOrder && index > 0)
+    node->dependencies.push_back(index - 1);
+
+  if (phCommand) {
+    *phCommand = new ur_exp_command_buffer_command_handle_t_(this, index);
+  }
+  nodes.push_back(std::move(node));
+  if (pSyncPoint)
+    *pSyncPoint = index;
+  return UR_RESULT_SUCCESS;
+}
+
+ur_result_t ur_exp_command_buffer_handle_t_::finalize() {
+  if (finalized)
+    return UR_RESULT_ERROR_INVALID_OPERATION;
+
+  // Nodes only depend on nodes appended before them, so the append order is
+  // already a topological order of the graph.
+  for (uint32_t i = 0; i < nodes.size(); i++) {
+    auto &node = *nodes[i];
+    auto &deps = node.dependencies;
+    std::sort(deps.begin(), deps.end());
+    deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+    for (uint32_t dep : deps)
+      nodes[dep]->successors.push_back(i);
+    if (deps.empty())
+      roots.push_back(i);
+    node.task = [this, &node](size_t threadId) { runTask(node, threadId); };
+  }
+  finalized = true;
+  return UR_RESULT_SUCCESS;
+}
+
+ur_result_t ur_exp_command_buffer_handle_t_::enqueue(
+    ur_queue_handle_t hQueue, uint32_t numEventsInWaitList,
+    const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent) {
+  if (!finalized)
+    return UR_RESULT_ERROR_INVALID_OPERATION;
+  UR_ASSERT(phEventWaitList || numEventsInWaitList == 0,
+            UR_RESULT_ERROR_INVALID_EVENT_WAIT_LIST);
+
+  std::lock_guard<std::mutex> lock(submitMutex);
+  std::vector<ur_event_handle_t> waitList;
+  if (lastSubmission && !lastSubmission->isComplete()) {
+    waitList.assign(phEventWaitList, phEventWaitList + numEventsInWaitList);
+    waitList.push_back(lastSubmission);
+    numEventsInWaitList = static_cast<uint32_t>(waitList.size());
+    phEventWaitList = waitList.data();
+  }
+
+  // Released once the run completes
+  incrementReferenceCount();
+  ur_event_handle_t event = nullptr;
+  ur_result_t result = hQueue->enqueue(
+      UR_COMMAND_COMMAND_BUFFER_ENQUEUE_EXP, numEventsInWaitList,
+      phEventWaitList, &event, [this](ur_event_handle_t e) { run(e); });
+  if (result != UR_RESULT_SUCCESS) {
+    decrementReferenceCount();
+    return result;
+  }
+
+  if (lastSubmission)
+    decrementOrDelete(lastSubmission);
+  lastSubmission = event;
+  if (phEvent) {
+    event->incrementReferenceCount();
+    *phEvent = event;
+  }
+  return UR_RESULT_SUCCESS;
+}
+
+void ur_exp_command_buffer_handle_t_::run(ur_event_handle_t event) {
+  // Nodes may all complete before the roots have been started, keep the
+  // command-buffer alive until then
+  incrementReferenceCount();
+  event->markStarted();
+  runEvent = event;
+  pendingNodes.store(nodes.size() + 1, std::memory_order_relaxed);
+  for (auto &node : nodes) {
+    node->pendingDependencies.store(node->dependencies.size(),
+                                    std::memory_order_relaxed);
+    if (node->plan)
+      node->plan->reset();
+  }
+  for (uint32_t root : roots)
+    startNode(*nodes[root]);
+  if (pendingNodes.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    event->complete();
+    decrementOrDelete(event);
+    decrementReferenceCount();
+  }
+  decrementOrDelete(this);
+}
+
+void ur_exp_command_buffer_handle_t_::startNode(
+    native_cpu::command_node &node) {
+  const size_t numTasks = node.plan ? node.plan->num_tasks() : 1;
+  if (numTasks == 0) {
+    finishNode(node);
+    return;
+  }
+  node.pendingTasks.store(numTasks, std::memory_order_relaxed);
+  device->tp.schedule_bulk(node.task, numTasks,
+                           runEvent->getQueue()->priority());
+}
+
+void ur_exp_command_buffer_handle_t_::runTask(native_cpu::command_node &node,
+                                              size_t threadId) {
+  if (node.plan)
+    node.plan->run(threadId);
+  else if (node.op)
+    node.op(device->tp);
+  if (node.pendingTasks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    if (node.plan && node.plan->failed())
+      runEvent->markFailed();
+    finishNode(node);
+  }
+}
+
+void ur_exp_command_buffer_handle_t_::finishNode(
+    native_cpu::command_node &node) {
+  for (uint32_t successor : node.successors) {
+    auto &next = *nodes[successor];
+    if (next.pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      startNode(next);
+  }
+  if (pendingNodes.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    ur_event_handle_t event = runEvent;
+    event->complete();
+    decrementOrDelete(event);
+    decrementOrDelete(this);
+  }
+}
+
+ur_result_t ur_exp_command_buffer_handle_t_::updateKernelLaunch(
+    uint32_t nodeIndex,
+    const ur_exp_command_buffer_update_kernel_launch_desc_t *pUpdate) {
+  if (!desc.isUpdatable || !finalized)
+    return UR_RESULT_ERROR_INVALID_OPERATION;
+  auto &node = *nodes[nodeIndex];
+  if (!node.kernel)
+    return UR_RESULT_ERROR_INVALID_COMMAND_BUFFER_COMMAND_HANDLE_EXP;
+  if (pUpdate->newWorkDim < 1 || pUpdate->newWorkDim > 3)
+    return UR_RESULT_ERROR_INVALID_WORK_DIMENSION;
+  if (pUpdate->newWorkDim != node.workDim &&
+      (!pUpdate->pNewGlobalWorkOffset || !pUpdate->pNewGlobalWorkSize))
+    return UR_RESULT_ERROR_INVALID_VALUE;
+  ur_kernel_handle_t kernel = node.kernel;
+  if (pUpdate->hNewKernel) {
+    if (std::find(node.kernelAlternatives.begin(),
+                  node.kernelAlternatives.end(),
+                  pUpdate->hNewKernel) == node.kernelAlternatives.end())
+      return UR_RESULT_ERROR_INVALID_VALUE;
+    kernel = pUpdate->hNewKernel;
+  }
+  UR_ASSERT(pUpdate->pNewMemObjArgList || pUpdate->numNewMemObjArgs == 0,
+            UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  UR_ASSERT(pUpdate->pNewPointerArgList || pUpdate->numNewPointerArgs == 0,
+            UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  UR_ASSERT(pUpdate->pNewValueArgList || pUpdate->numNewValueArgs == 0,
+            UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  // The node is replaced while no run reads it
+  std::lock_guard<std::mutex> lock(submitMutex);
+  if (lastSubmission)
+    lastSubmission->wait();
+
+  // The new arguments are patched into a copy of the ones the command has,
+  // or the ones a new kernel has now, which only replaces them once the new
+  // plan has been made
+  std::unique_ptr<native_cpu::arg_arena> args(new native_cpu::arg_arena(
+      kernel == node.kernel ? *node.args : *kernel->getArgArena()));
+  for (uint32_t i = 0; i < pUpdate->numNewMemObjArgs; i++) {
+    const auto &arg = pUpdate->pNewMemObjArgList[i];
+    void *ptr = nullptr;
+    if (arg.hNewMemObjArg) {
+      arg.hNewMemObjArg->materializeAll();
+      ptr = arg.hNewMemObjArg->_mem;
+    }
+    args->setPointer(arg.argIndex, ptr);
+  }
+  for (uint32_t i = 0; i < pUpdate->numNewPointerArgs; i++) {
+    const auto &arg = pUpdate->pNewPointerArgList[i];
+    // Unlike urKernelSetArgPointer, this points to the pointer
+    void *ptr = arg.pNewPointerArg
+                    ? *static_cast<void *const *>(arg.pNewPointerArg)
+                    : nullptr;
+    args->setPointer(arg.argIndex, ptr);
+  }
+  for (uint32_t i = 0; i < pUpdate->numNewValueArgs; i++) {
+    const auto &arg = pUpdate->pNewValueArgList[i];
+    if (arg.pNewValueArg)
+      args->setValue(arg.argIndex, arg.pNewValueArg, arg.argSize);
+    else
+      args->setLocal(arg.argIndex, arg.argSize);
+  }
+
+  const uint32_t workDim = pUpdate->newWorkDim;
+  size_t globalOffset[3] = {0, 0, 0};
+  size_t globalSize[3] = {1, 1, 1};
+  size_t localSize[3] = {1, 1, 1};
+  std::copy_n(pUpdate->pNewGlobalWorkOffset ? pUpdate->pNewGlobalWorkOffset
+                                            : node.globalOffset,
+              workDim, globalOffset);
+  std::copy_n(pUpdate->pNewGlobalWorkSize ? pUpdate->pNewGlobalWorkSize
+                                          : node.globalSize,
+              workDim, globalSize);
+  // A new global size without a local size lets the adapter pick one
+  bool hasLocalSize = node.hasLocalSize && !pUpdate->pNewGlobalWorkSize;
+  if (pUpdate->pNewLocalWorkSize) {
+    hasLocalSize = true;
+    std::copy_n(pUpdate->pNewLocalWorkSize, workDim, localSize);
+  } else if (hasLocalSize) {
+    std::copy_n(node.localSize, workDim, localSize);
+  }
+
+  std::unique_ptr<native_cpu::launch_plan> plan;
+  ur_result_t result = native_cpu::make_launch_plan(
+      kernel, args.get(), workDim, globalOffset, globalSize,
+      hasLocalSize ? localSize : nullptr, device->tp, plan);
+  if (result != UR_RESULT_SUCCESS)
+    return result;
+
+  node.plan = std::move(plan);
+  decrementOrDelete(node.args);
+  node.args = args.release();
+  node.kernel = kernel;
+  node.workDim = workDim;
+  std::copy_n(globalOffset, 3, node.globalOffset);
+  std::copy_n(globalSize, 3, node.globalSize);
+  std::copy_n(localSize, 3, node.localSize);
+  node.hasLocalSize = hasLocalSize;
+  return UR_RESULT_SUCCESS;
+}
 
-/// Stub implementations of UR experimental feature command-buffers
-/// Taken almost unchanged from another adapter. Perhaps going forward
-/// these stubs could be defined in core UR as the default which would
-/// reduce code duplication. Adapters could then "override" these defaults.
-/// Issue raised for this comment in
-/// https://github.com/oneapi-src/unified-runtime/issues/1064
+namespace {
+
+// Commands can't signal or wait for events, as the device doesn't report
+// UR_DEVICE_INFO_COMMAND_BUFFER_EVENT_SUPPORT_EXP.
+ur_result_t checkNoEvents(uint32_t numEventsInWaitList,
+                          ur_event_handle_t *phEvent) {
+  if (numEventsInWaitList || phEvent)
+    return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+  return UR_RESULT_SUCCESS;
+}
+
+// Appends a command that runs `op` on the thread pool.
+ur_result_t
+appendOp(ur_exp_command_buffer_handle_t hCommandBuffer,
+         std::function<void(native_cpu::threadpool_t &)> op,
+         uint32_t numSyncPointsInWaitList,
+         const ur_exp_command_buffer_sync_point_t *pSyncPointWaitList,
+         uint32_t numEventsInWaitList, ur_event_handle_t *phEvent,
+         ur_exp_command_buffer_sync_point_t *pSyncPoint,
+         ur_exp_command_buffer_command_handle_t *phCommand) {
+  UR_ASSERT(hCommandBuffer, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  if (auto result = checkNoEvents(numEventsInWaitList, phEvent))
+    return result;
+  auto node = std::make_unique<native_cpu::command_node>();
+  node->op = std::move(op);
+  return hCommandBuffer->append(std::move(node), numSyncPointsInWaitList,
+                                pSyncPointWaitList, pSyncPoint, phCommand);
+}
+
+// Resolves the default pitches of a region and returns the offset of `origin`.
+size_t rectOffset(ur_rect_offset_t origin, ur_rect_region_t region,
+                  size_t &rowPitch, size_t &slicePitch) {
+  if (rowPitch == 0)
+    rowPitch = region.width;
+  if (slicePitch == 0)
+    slicePitch = rowPitch * region.height;
+  return origin.z * slicePitch + origin.y * rowPitch + origin.x;
+}
+
+ur_result_t
+appendRectCopy(ur_exp_command_buffer_handle_t hCommandBuffer, char *dst,
+               ur_rect_offset_t dstOrigin, size_t dstRowPitch,
+               size_t dstSlicePitch, const char *src,
+               ur_rect_offset_t srcOrigin, size_t srcRowPitch,
+               size_t srcSlicePitch, ur_rect_region_t region,
+               uint32_t numSyncPointsInWaitList,
+               const ur_exp_command_buffer_sync_point_t *pSyncPointWaitList,
+               uint32_t numEventsInWaitList, ur_event_handle_t *phEvent,
+               ur_exp_command_buffer_sync_point_t *pSyncPoint,
+               ur_exp_command_buffer_command_handle_t *phCommand) {
+  dst += rectOffset(dstOrigin, region, dstRowPitch, dstSlicePitch);
+  src += rectOffset(srcOrigin, region, srcRowPitch, srcSlicePitch);
+  native_cpu::rect_region r{region.width, region.height, region.depth,
+                            srcRowPitch,  srcSlicePitch, dstRowPitch,
+                            dstSlicePitch};
+  return appendOp(
+      hCommandBuffer,
+      [=](native_cpu::threadpool_t &tp) {
+        native_cpu::copy_rect(tp, dst, src, r);
+      },
+      numSyncPointsInWaitList, pSyncPointWaitList, numEventsInWaitList,
+      phEvent, pSyncPoint, phCommand);
+}
+
+// Makes the buffer's memory hold its host data before it is recorded in a
+// command.
+char *bufferMem(ur_mem_handle_t hBuffer) {
+  hBuffer->materializeAll();
+  return hBuffer->_mem;
+}
+
+} // namespace
 
 UR_APIEXPORT ur_result_t UR_APICALL urCommandBufferCreateExp(
-    ur_context_handle_t, ur_device_handle_t,
-    const ur_exp_command_buffer_desc_t *, ur_exp_command_buffer_handle_t *) {
-  detail::ur::die("Experimental Command-buffer feature is not "
-                  "implemented for the NativeCPU adapter.");
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_context_handle_t hContext, ur_device_handle_t hDevice,
+    const ur_exp_command_buffer_desc_t *pCommandBufferDesc,
+    ur_exp_command_buffer_handle_t *phCommandBuffer) {
+  UR_ASSERT(hContext && hDevice, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(phCommandBuffer, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  try {
+    *phCommandBuffer = new ur_exp_command_buffer_handle_t_(hContext, hDevice,
+                                                           pCommandBufferDesc);
+  } catch (const std::bad_alloc &) {
+    return UR_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+  }
+  return UR_RESULT_SUCCESS;
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL
-urCommandBufferRetainExp(ur_exp_command_buffer_handle_t) {
-  detail::ur::die("Experimental Command-buffer feature is not "
-                  "implemented for the NativeCPU adapter.");
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+urCommandBufferRetainExp(ur_exp_command_buffer_handle_t hCommandBuffer) {
+  UR_ASSERT(hCommandBuffer, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  hCommandBuffer->incrementReferenceCount();
+  return UR_RESULT_SUCCESS;
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL
-urCommandBufferReleaseExp(ur_exp_command_buffer_handle_t) {
-  detail::ur::die("Experimental Command-buffer feature is not "
-                  "implemented for the NativeCPU adapter.");
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+urCommandBufferReleaseExp(ur_exp_command_buffer_handle_t hCommandBuffer) {
+  UR_ASSERT(hCommandBuffer, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  decrementOrDelete(hCommandBuffer);
+  return UR_RESULT_SUCCESS;
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL
-urCommandBufferFinalizeExp(ur_exp_command_buffer_handle_t) {
-  detail::ur::die("Experimental Command-buffer feature is not "
-                  "implemented for the NativeCPU adapter.");
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+urCommandBufferFinalizeExp(ur_exp_command_buffer_handle_t hCommandBuffer) {
+  UR_ASSERT(hCommandBuffer, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  try {
+    return hCommandBuffer->finalize();
+  } catch (const std::bad_alloc &) {
+    return UR_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+  }
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urCommandBufferAppendKernelLaunchExp(
-    ur_exp_command_buffer_handle_t, ur_kernel_handle_t, uint32_t,
-    const size_t *, const size_t *, const size_t *, uint32_t,
-    ur_kernel_handle_t *, uint32_t, const ur_exp_command_buffer_sync_point_t *,
-    uint32_t, const ur_event_handle_t *, ur_exp_command_buffer_sync_point_t *,
-    ur_event_handle_t *, ur_exp_command_buffer_command_handle_t *) {
-  detail::ur::die("Experimental Command-buffer feature is not "
-                  "implemented for the NativeCPU adapter.");
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_exp_command_buffer_handle_t hCommandBuffer, ur_kernel_handle_t hKernel,
+    uint32_t workDim, const size_t *pGlobalWorkOffset,
+    const size_t *pGlobalWorkSize, const size_t *pLocalWorkSize,
+    uint32_t numKernelAlternatives, ur_kernel_handle_t *phKernelAlternatives,
+    uint32_t numSyncPointsInWaitList,
+    const ur_exp_command_buffer_sync_point_t *pSyncPointWaitList,
+    uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
+    ur_exp_command_buffer_sync_point_t *pSyncPoint, ur_event_handle_t *phEvent,
+    ur_exp_command_buffer_command_handle_t *phCommand) {
+  std::ignore = phEventWaitList;
+
+  UR_ASSERT(hCommandBuffer && hKernel, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pGlobalWorkSize, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  UR_ASSERT(workDim > 0 && workDim < 4, UR_RESULT_ERROR_INVALID_WORK_DIMENSION);
+  UR_ASSERT(phKernelAlternatives || numKernelAlternatives == 0,
+            UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  if (auto result = checkNoEvents(numEventsInWaitList, phEvent))
+    return result;
+
+  auto node = std::make_unique<native_cpu::command_node>();
+  node->workDim = workDim;
+  for (uint32_t dim = 0; dim < 3; dim++) {
+    node->globalOffset[dim] =
+        pGlobalWorkOffset && dim < workDim ? pGlobalWorkOffset[dim] : 0;
+    node->globalSize[dim] = dim < workDim ? pGlobalWorkSize[dim] : 1;
+    node->localSize[dim] =
+        pLocalWorkSize && dim < workDim ? pLocalWorkSize[dim] : 1;
+  }
+  node->hasLocalSize = pLocalWorkSize != nullptr;
+  node->kernel = hKernel;
+  node->kernelAlternatives.push_back(hKernel);
+  hKernel->incrementReferenceCount();
+  for (uint32_t i = 0; i < numKernelAlternatives; i++) {
+    if (phKernelAlternatives[i] == hKernel)
+      return UR_RESULT_ERROR_INVALID_VALUE;
+    node->kernelAlternatives.push_back(phKernelAlternatives[i]);
+    phKernelAlternatives[i]->incrementReferenceCount();
+  }
+  // The command keeps the arguments the kernel has now
+  node->args = new native_cpu::arg_arena(*hKernel->getArgArena());
+
+  ur_result_t result = native_cpu::make_launch_plan(
+      hKernel, node->args, workDim, node->globalOffset, node->globalSize,
+      pLocalWorkSize ? node->localSize : nullptr, hCommandBuffer->device->tp,
+      node->plan);
+  if (result != UR_RESULT_SUCCESS)
+    return result;
+  return hCommandBuffer->append(std::move(node), numSyncPointsInWaitList,
+                                pSyncPointWaitList, pSyncPoint, phCommand);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urCommandBufferAppendUSMMemcpyExp(
-    ur_exp_command_buffer_handle_t, void *, const void *, size_t, uint32_t,
-    const ur_exp_command_buffer_sync_point_t *, uint32_t,
-    const ur_event_handle_t *, ur_exp_command_buffer_sync_point_t *,
-    ur_event_handle_t *, ur_exp_command_buffer_command_handle_t *) {
-  detail::ur::die("Experimental Command-buffer feature is not "
-                  "implemented for the NativeCPU adapter.");
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_exp_command_buffer_handle_t hCommandBuffer, void *pDst, const void *pSrc,
+    size_t size, uint32_t numSyncPointsInWaitList,
+    const ur_exp_command_buffer_sync_point_t *pSyncPointWaitList,
+    uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
+    ur_exp_command_buffer_sync_point_t *pSyncPoint, ur_event_handle_t *phEvent,
+    ur_exp_command_buffer_command_handle_t *phCommand) {
+  std::ignore = phEventWaitList;
+  UR_ASSERT(pDst && pSrc, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  return appendOp(
+      hCommandBuffer,
+      [=](native_cpu::threadpool_t &tp) {
+        native_cpu::copy_bytes(tp, pDst, pSrc, size);
+      },
+      numSyncPointsInWaitList, pSyncPointWaitList, numEventsInWaitList,
+      phEvent, pSyncPoint, phCommand);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urCommandBufferAppendMemBufferCopyExp(
-    ur_exp_command_buffer_handle_t, ur_mem_handle_t, ur_mem_handle_t, size_t,
-    size_t, size_t, uint32_t, const ur_exp_command_buffer_sync_point_t *,
-    uint32_t, const ur_event_handle_t *, ur_exp_command_buffer_sync_point_t *,
-    ur_event_handle_t *, ur_exp_command_buffer_command_handle_t *) {
-  detail::ur::die("Experimental Command-buffer feature is not "
-                  "implemented for the NativeCPU adapter.");
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_exp_command_buffer_handle_t hCommandBuffer, ur_mem_handle_t hSrcMem,
+    ur_mem_handle_t hDstMem, size_t srcOffset, size_t dstOffset, size_t size,
+    uint32_t numSyncPointsInWaitList,
+    const ur_exp_command_buffer_sync_point_t *pSyncPointWaitList,
+    uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
+    ur_exp_command_buffer_sync_point_t *pSyncPoint, ur_event_handle_t *phEvent,
+    ur_exp_command_buffer_command_handle_t *phCommand) {
+  std::ignore = phEventWaitList;
+  UR_ASSERT(hSrcMem && hDstMem, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  char *dst = bufferMem(hDstMem) + dstOffset;
+  const char *src = bufferMem(hSrcMem) + srcOffset;
+  return appendOp(
+      hCommandBuffer,
+      [=](native_cpu::threadpool_t &tp) {
+        native_cpu::copy_bytes(tp, dst, src, size);
+      },
+      numSyncPointsInWaitList, pSyncPointWaitList, numEventsInWaitList,
+      phEvent, pSyncPoint, phCommand);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urCommandBufferAppendMemBufferCopyRectExp(
-    ur_exp_command_buffer_handle_t, ur_mem_handle_t, ur_mem_handle_t,
-    ur_rect_offset_t, ur_rect_offset_t, ur_rect_region_t, size_t, size_t,
-    size_t, size_t, uint32_t, const ur_exp_command_buffer_sync_point_t *,
-    uint32_t, const ur_event_handle_t *, ur_exp_command_buffer_sync_point_t *,
-    ur_event_handle_t *, ur_exp_command_buffer_command_handle_t *) {
-  detail::ur::die("Experimental Command-buffer feature is not "
-                  "implemented for the NativeCPU adapter.");
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_exp_command_buffer_handle_t hCommandBuffer, ur_mem_handle_t hSrcMem,
+    ur_mem_handle_t hDstMem, ur_rect_offset_t srcOrigin,
+    ur_rect_offset_t dstOrigin, ur_rect_region_t region, size_t srcRowPitch,
+    size_t srcSlicePitch, size_t dstRowPitch, size_t dstSlicePitch,
+    uint32_t numSyncPointsInWaitList,
+    const ur_exp_command_buffer_sync_point_t *pSyncPointWaitList,
+    uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
+    ur_exp_command_buffer_sync_point_t *pSyncPoint, ur_event_handle_t *phEvent,
+    ur_exp_command_buffer_command_handle_t *phCommand) {
+  std::ignore = phEventWaitList;
+  UR_ASSERT(hSrcMem && hDstMem, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  return appendRectCopy(hCommandBuffer, bufferMem(hDstMem), dstOrigin,
+                        dstRowPitch, dstSlicePitch, bufferMem(hSrcMem),
+                        srcOrigin, srcRowPitch, srcSlicePitch, region,
+                        numSyncPointsInWaitList, pSyncPointWaitList,
+                        numEventsInWaitList, phEvent, pSyncPoint, phCommand);
 }
 
 UR_APIEXPORT
 ur_result_t UR_APICALL urCommandBufferAppendMemBufferWriteExp(
-    ur_exp_command_buffer_handle_t, ur_mem_handle_t, size_t, size_t,
-    const void *, uint32_t, const ur_exp_command_buffer_sync_point_t *,
-    uint32_t, const ur_event_handle_t *, ur_exp_command_buffer_sync_point_t *,
-    ur_event_handle_t *, ur_exp_command_buffer_command_handle_t *) {
-  detail::ur::die("Experimental Command-buffer feature is not "
-                  "implemented for the NativeCPU adapter.");
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_exp_command_buffer_handle_t hCommandBuffer, ur_mem_handle_t hBuffer,
+    size_t offset, size_t size, const void *pSrc,
+    uint32_t numSyncPointsInWaitList,
+    const ur_exp_command_buffer_sync_point_t *pSyncPointWaitList,
+    uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
+    ur_exp_command_buffer_sync_point_t *pSyncPoint, ur_event_handle_t *phEvent,
+    ur_exp_command_buffer_command_handle_t *phCommand) {
+  std::ignore = phEventWaitList;
+  UR_ASSERT(hBuffer, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pSrc, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  char *dst = bufferMem(hBuffer) + offset;
+  return appendOp(
+      hCommandBuffer,
+      [=](native_cpu::threadpool_t &tp) {
+        native_cpu::copy_bytes(tp, dst, pSrc, size);
+      },
+      numSyncPointsInWaitList, pSyncPointWaitList, numEventsInWaitList,
+      phEvent, pSyncPoint, phCommand);
 }
 
 UR_APIEXPORT
 ur_result_t UR_APICALL urCommandBufferAppendMemBufferReadExp(
-    ur_exp_command_buffer_handle_t, ur_mem_handle_t, size_t, size_t, void *,
-    uint32_t, const ur_exp_command_buffer_sync_point_t *, uint32_t,
-    const ur_event_handle_t *, ur_exp_command_buffer_sync_point_t *,
-    ur_event_handle_t *, ur_exp_command_buffer_command_handle_t *) {
-  detail::ur::die("Experimental Command-buffer feature is not "
-                  "implemented for the NativeCPU adapter.");
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_exp_command_buffer_handle_t hCommandBuffer, ur_mem_handle_t hBuffer,
+    size_t offset, size_t size, void *pDst, uint32_t numSyncPointsInWaitList,
+    const ur_exp_command_buffer_sync_point_t *pSyncPointWaitList,
+    uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
+    ur_exp_command_buffer_sync_point_t *pSyncPoint, ur_event_handle_t *phEvent,
+    ur_exp_command_buffer_command_handle_t *phCommand) {
+  std::ignore = phEventWaitList;
+  UR_ASSERT(hBuffer, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pDst, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  const char *src = bufferMem(hBuffer) + offset;
+  return appendOp(
+      hCommandBuffer,
+      [=](native_cpu::threadpool_t &tp) {
+        native_cpu::copy_bytes(tp, pDst, src, size);
+      },
+      numSyncPointsInWaitList, pSyncPointWaitList, numEventsInWaitList,
+      phEvent, pSyncPoint, phCommand);
 }
 
 UR_APIEXPORT
 ur_result_t UR_APICALL urCommandBufferAppendMemBufferWriteRectExp(
-    ur_exp_command_buffer_handle_t, ur_mem_handle_t, ur_rect_offset_t,
-    ur_rect_offset_t, ur_rect_region_t, size_t, size_t, size_t, size_t, void *,
-    uint32_t, const ur_exp_command_buffer_sync_point_t *, uint32_t,
-    const ur_event_handle_t *, ur_exp_command_buffer_sync_point_t *,
-    ur_event_handle_t *, ur_exp_command_buffer_command_handle_t *) {
-  detail::ur::die("Experimental Command-buffer feature is not "
-                  "implemented for the NativeCPU adapter.");
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_exp_command_buffer_handle_t hCommandBuffer, ur_mem_handle_t hBuffer,
+    ur_rect_offset_t bufferOffset, ur_rect_offset_t hostOffset,
+    ur_rect_region_t region, size_t bufferRowPitch, size_t bufferSlicePitch,
+    size_t hostRowPitch, size_t hostSlicePitch, void *pSrc,
+    uint32_t numSyncPointsInWaitList,
+    const ur_exp_command_buffer_sync_point_t *pSyncPointWaitList,
+    uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
+    ur_exp_command_buffer_sync_point_t *pSyncPoint, ur_event_handle_t *phEvent,
+    ur_exp_command_buffer_command_handle_t *phCommand) {
+  std::ignore = phEventWaitList;
+  UR_ASSERT(hBuffer, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pSrc, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  return appendRectCopy(hCommandBuffer, bufferMem(hBuffer), bufferOffset,
+                        bufferRowPitch, bufferSlicePitch,
+                        static_cast<const char *>(pSrc), hostOffset,
+                        hostRowPitch, hostSlicePitch, region,
+                        numSyncPointsInWaitList, pSyncPointWaitList,
+                        numEventsInWaitList, phEvent, pSyncPoint, phCommand);
 }
 
 UR_APIEXPORT
 ur_result_t UR_APICALL urCommandBufferAppendMemBufferReadRectExp(
-    ur_exp_command_buffer_handle_t, ur_mem_handle_t, ur_rect_offset_t,
-    ur_rect_offset_t, ur_rect_region_t, size_t, size_t, size_t, size_t, void *,
-    uint32_t, const ur_exp_command_buffer_sync_point_t *, uint32_t,
-    const ur_event_handle_t *, ur_exp_command_buffer_sync_point_t *,
-    ur_event_handle_t *, ur_exp_command_buffer_command_handle_t *) {
-  detail::ur::die("Experimental Command-buffer feature is not "
-                  "implemented for the NativeCPU adapter.");
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_exp_command_buffer_handle_t hCommandBuffer, ur_mem_handle_t hBuffer,
+    ur_rect_offset_t bufferOffset, ur_rect_offset_t hostOffset,
+    ur_rect_region_t region, size_t bufferRowPitch, size_t bufferSlicePitch,
+    size_t hostRowPitch, size_t hostSlicePitch, void *pDst,
+    uint32_t numSyncPointsInWaitList,
+    const ur_exp_command_buffer_sync_point_t *pSyncPointWaitList,
+    uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
+    ur_exp_command_buffer_sync_point_t *pSyncPoint, ur_event_handle_t *phEvent,
+    ur_exp_command_buffer_command_handle_t *phCommand) {
+  std::ignore = phEventWaitList;
+  UR_ASSERT(hBuffer, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pDst, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  return appendRectCopy(hCommandBuffer, static_cast<char *>(pDst), hostOffset,
+                        hostRowPitch, hostSlicePitch, bufferMem(hBuffer),
+                        bufferOffset, bufferRowPitch, bufferSlicePitch, region,
+                        numSyncPointsInWaitList, pSyncPointWaitList,
+                        numEventsInWaitList, phEvent, pSyncPoint, phCommand);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urCommandBufferEnqueueExp(
-    ur_exp_command_buffer_handle_t, ur_queue_handle_t, uint32_t,
-    const ur_event_handle_t *, ur_event_handle_t *) {
-  detail::ur::die("Experimental Command-buffer feature is not "
-                  "implemented for the NativeCPU adapter.");
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_exp_command_buffer_handle_t hCommandBuffer, ur_queue_handle_t hQueue,
+    uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
+    ur_event_handle_t *phEvent) {
+  UR_ASSERT(hCommandBuffer && hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  return hCommandBuffer->enqueue(hQueue, numEventsInWaitList, phEventWaitList,
+                                 phEvent);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urCommandBufferAppendMemBufferFillExp(
-    ur_exp_command_buffer_handle_t, ur_mem_handle_t, const void *, size_t,
-    size_t, size_t, uint32_t, const ur_exp_command_buffer_sync_point_t *,
-    uint32_t, const ur_event_handle_t *, ur_exp_command_buffer_sync_point_t *,
-    ur_event_handle_t *, ur_exp_command_buffer_command_handle_t *) {
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_exp_command_buffer_handle_t hCommandBuffer, ur_mem_handle_t hBuffer,
+    const void *pPattern, size_t patternSize, size_t offset, size_t size,
+    uint32_t numSyncPointsInWaitList,
+    const ur_exp_command_buffer_sync_point_t *pSyncPointWaitList,
+    uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
+    ur_exp_command_buffer_sync_point_t *pSyncPoint, ur_event_handle_t *phEvent,
+    ur_exp_command_buffer_command_handle_t *phCommand) {
+  std::ignore = phEventWaitList;
+  UR_ASSERT(hBuffer, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pPattern, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  UR_ASSERT(patternSize != 0 && size % patternSize == 0,
+            UR_RESULT_ERROR_INVALID_SIZE);
+
+  char *dst = bufferMem(hBuffer) + offset;
+  auto *first = static_cast<const uint8_t *>(pPattern);
+  std::vector<uint8_t> pattern(first, first + patternSize);
+  return appendOp(
+      hCommandBuffer,
+      [=, pattern = std::move(pattern)](native_cpu::threadpool_t &tp) {
+        native_cpu::fill_bytes(tp, dst, size, pattern.data(), pattern.size());
+      },
+      numSyncPointsInWaitList, pSyncPointWaitList, numEventsInWaitList,
+      phEvent, pSyncPoint, phCommand);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urCommandBufferAppendUSMFillExp(
-    ur_exp_command_buffer_handle_t, void *, const void *, size_t, size_t,
-    uint32_t, const ur_exp_command_buffer_sync_point_t *, uint32_t,
-    const ur_event_handle_t *, ur_exp_command_buffer_sync_point_t *,
-    ur_event_handle_t *, ur_exp_command_buffer_command_handle_t *) {
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_exp_command_buffer_handle_t hCommandBuffer, void *pMemory,
+    const void *pPattern, size_t patternSize, size_t size,
+    uint32_t numSyncPointsInWaitList,
+    const ur_exp_command_buffer_sync_point_t *pSyncPointWaitList,
+    uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
+    ur_exp_command_buffer_sync_point_t *pSyncPoint, ur_event_handle_t *phEvent,
+    ur_exp_command_buffer_command_handle_t *phCommand) {
+  std::ignore = phEventWaitList;
+  UR_ASSERT(pMemory && pPattern, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  UR_ASSERT(patternSize != 0 && size % patternSize == 0,
+            UR_RESULT_ERROR_INVALID_SIZE);
+
+  auto *first = static_cast<const uint8_t *>(pPattern);
+  std::vector<uint8_t> pattern(first, first + patternSize);
+  return appendOp(
+      hCommandBuffer,
+      [=, pattern = std::move(pattern)](native_cpu::threadpool_t &tp) {
+        native_cpu::fill_bytes(tp, pMemory, size, pattern.data(),
+                               pattern.size());
+      },
+      numSyncPointsInWaitList, pSyncPointWaitList, numEventsInWaitList,
+      phEvent, pSyncPoint, phCommand);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urCommandBufferAppendUSMPrefetchExp(
-    ur_exp_command_buffer_handle_t, const void *, size_t,
-    ur_usm_migration_flags_t, uint32_t,
-    const ur_exp_command_buffer_sync_point_t *, uint32_t,
-    const ur_event_handle_t *, ur_exp_command_buffer_sync_point_t *,
-    ur_event_handle_t *, ur_exp_command_buffer_command_handle_t *) {
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_exp_command_buffer_handle_t hCommandBuffer, const void *pMemory,
+    size_t size, ur_usm_migration_flags_t flags,
+    uint32_t numSyncPointsInWaitList,
+    const ur_exp_command_buffer_sync_point_t *pSyncPointWaitList,
+    uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
+    ur_exp_command_buffer_sync_point_t *pSyncPoint, ur_event_handle_t *phEvent,
+    ur_exp_command_buffer_command_handle_t *phCommand) {
+  std::ignore = flags;
+  std::ignore = phEventWaitList;
+  UR_ASSERT(pMemory, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  return appendOp(
+      hCommandBuffer,
+      [=](native_cpu::threadpool_t &) {
+        native_cpu::usm_prefetch(pMemory, size);
+      },
+      numSyncPointsInWaitList, pSyncPointWaitList, numEventsInWaitList,
+      phEvent, pSyncPoint, phCommand);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urCommandBufferAppendUSMAdviseExp(
-    ur_exp_command_buffer_handle_t, const void *, size_t, ur_usm_advice_flags_t,
-    uint32_t, const ur_exp_command_buffer_sync_point_t *, uint32_t,
-    const ur_event_handle_t *, ur_exp_command_buffer_sync_point_t *,
-    ur_event_handle_t *, ur_exp_command_buffer_command_handle_t *) {
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_exp_command_buffer_handle_t hCommandBuffer, const void *pMemory,
+    size_t size, ur_usm_advice_flags_t advice, uint32_t numSyncPointsInWaitList,
+    const ur_exp_command_buffer_sync_point_t *pSyncPointWaitList,
+    uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
+    ur_exp_command_buffer_sync_point_t *pSyncPoint, ur_event_handle_t *phEvent,
+    ur_exp_command_buffer_command_handle_t *phCommand) {
+  std::ignore = phEventWaitList;
+  UR_ASSERT(pMemory, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  return appendOp(
+      hCommandBuffer,
+      [=](native_cpu::threadpool_t &) {
+        native_cpu::usm_advise(pMemory, size, advice);
+      },
+      numSyncPointsInWaitList, pSyncPointWaitList, numEventsInWaitList,
+      phEvent, pSyncPoint, phCommand);
 }
 
-UR_APIEXPORT ur_result_t UR_APICALL
-urCommandBufferRetainCommandExp(ur_exp_command_buffer_command_handle_t) {
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+UR_APIEXPORT ur_result_t UR_APICALL urCommandBufferRetainCommandExp(
+    ur_exp_command_buffer_command_handle_t hCommand) {
+  UR_ASSERT(hCommand, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  hCommand->incrementReferenceCount();
+  return UR_RESULT_SUCCESS;
 }
 
-UR_APIEXPORT ur_result_t UR_APICALL
-urCommandBufferReleaseCommandExp(ur_exp_command_buffer_command_handle_t) {
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+UR_APIEXPORT ur_result_t UR_APICALL urCommandBufferReleaseCommandExp(
+    ur_exp_command_buffer_command_handle_t hCommand) {
+  UR_ASSERT(hCommand, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  decrementOrDelete(hCommand);
+  return UR_RESULT_SUCCESS;
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urCommandBufferUpdateKernelLaunchExp(
-    ur_exp_command_buffer_command_handle_t,
-    const ur_exp_command_buffer_update_kernel_launch_desc_t *) {
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_exp_command_buffer_command_handle_t hCommand,
+    const ur_exp_command_buffer_update_kernel_launch_desc_t
+        *pUpdateKernelLaunch) {
+  UR_ASSERT(hCommand, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pUpdateKernelLaunch, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  try {
+    return hCommand->commandBuffer->updateKernelLaunch(hCommand->node,
+                                                       pUpdateKernelLaunch);
+  } catch (const std::bad_alloc &) {
+    return UR_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+  }
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urCommandBufferUpdateSignalEventExp(
     ur_exp_command_buffer_command_handle_t, ur_event_handle_t *) {
+  // Commands have no events, see checkNoEvents
   return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
 }
 
@@ -203,13 +765,33 @@ urCommandBufferUpdateWaitEventsExp(ur_exp_command_buffer_command_handle_t,
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urCommandBufferGetInfoExp(
-    ur_exp_command_buffer_handle_t, ur_exp_command_buffer_info_t, size_t,
-    void *, size_t *) {
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_exp_command_buffer_handle_t hCommandBuffer,
+    ur_exp_command_buffer_info_t propName, size_t propSize, void *pPropValue,
+    size_t *pPropSizeRet) {
+  UR_ASSERT(hCommandBuffer, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  UrReturnHelper ReturnValue(propSize, pPropValue, pPropSizeRet);
+  switch (propName) {
+  case UR_EXP_COMMAND_BUFFER_INFO_REFERENCE_COUNT:
+    return ReturnValue(hCommandBuffer->getReferenceCount());
+  case UR_EXP_COMMAND_BUFFER_INFO_DESCRIPTOR:
+    return ReturnValue(hCommandBuffer->desc);
+  default:
+    return UR_RESULT_ERROR_INVALID_ENUMERATION;
+  }
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urCommandBufferCommandGetInfoExp(
-    ur_exp_command_buffer_command_handle_t,
-    ur_exp_command_buffer_command_info_t, size_t, void *, size_t *) {
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_exp_command_buffer_command_handle_t hCommand,
+    ur_exp_command_buffer_command_info_t propName, size_t propSize,
+    void *pPropValue, size_t *pPropSizeRet) {
+  UR_ASSERT(hCommand, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  UrReturnHelper ReturnValue(propSize, pPropValue, pPropSizeRet);
+  switch (propName) {
+  case UR_EXP_COMMAND_BUFFER_COMMAND_INFO_REFERENCE_COUNT:
+    return ReturnValue(hCommand->getReferenceCount());
+  default:
+    return UR_RESULT_ERROR_INVALID_ENUMERATION;
+  }
 }
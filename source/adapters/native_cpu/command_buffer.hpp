@@ -0,0 +1,143 @@
+//===--------- command_buffer.hpp - Native CPU Adapter --------------------===//
+//
+// Copyright (C) 2024 Intel Corporation
+//
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM
+// Exceptions. See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "common.hpp"
+#include "device.hpp"
+#include "kernel.hpp"
+#include "launch.hpp"
+#include "threadpool.hpp"
+
+namespace native_cpu {
+
+// A command recorded in a command-buffer.
+struct command_node {
+  command_node() = default;
+  command_node(const command_node &) = delete;
+  command_node &operator=(const command_node &) = delete;
+
+  ~command_node() {
+    if (args)
+      decrementOrDelete(args);
+    for (auto kernel : kernelAlternatives)
+      decrementOrDelete(kernel);
+  }
+
+  // Kernel launches run their plan, every other command runs `op` in a single
+  // task. Commands that have nothing to do on the host, such as prefetches,
+  // have neither.
+  std::unique_ptr<launch_plan> plan;
+  std::function<void(threadpool_t &)> op;
+
+  // Kernel launches only. The arguments are copied from the kernel when the
+  // launch is appended, and are replaced along with the plan by updates.
+  ur_kernel_handle_t kernel = nullptr;
+  std::vector<ur_kernel_handle_t> kernelAlternatives;
+  arg_arena *args = nullptr;
+  uint32_t workDim = 0;
+  size_t globalOffset[3] = {0, 0, 0};
+  size_t globalSize[3] = {0, 0, 0};
+  size_t localSize[3] = {0, 0, 0};
+  bool hasLocalSize = false;
+
+  // Indices of the nodes this one depends on, and of the ones that depend on
+  // it once the command-buffer is finalized.
+  std::vector<uint32_t> dependencies;
+  std::vector<uint32_t> successors;
+
+  // Rearmed at the start of every run.
+  std::atomic<uint32_t> pendingDependencies{0};
+  std::atomic<size_t> pendingTasks{0};
+
+  // Scheduled once for each task of the node on every run, so that runs
+  // don't allocate tasks.
+  worker_task_t task;
+};
+
+} // namespace native_cpu
+
+// Commands keep their command-buffer alive, so that they can still be updated
+// once the application has released it. The command-buffer doesn't hold on to
+// its commands.
+struct ur_exp_command_buffer_command_handle_t_ : RefCounted {
+  ur_exp_command_buffer_command_handle_t_(
+      ur_exp_command_buffer_handle_t commandBuffer, uint32_t node);
+  ~ur_exp_command_buffer_command_handle_t_();
+
+  ur_exp_command_buffer_command_handle_t_(
+      const ur_exp_command_buffer_command_handle_t_ &) = delete;
+  ur_exp_command_buffer_command_handle_t_ &
+  operator=(const ur_exp_command_buffer_command_handle_t_ &) = delete;
+
+  ur_exp_command_buffer_handle_t const commandBuffer;
+  const uint32_t node;
+};
+
+// Commands are recorded as a graph of nodes, whose edges are the sync points
+// each command waits for. Kernel launches are partitioned between the threads
+// of the device when they are appended, finalizing wires up the graph, and
+// each submission then runs the nodes on the thread pool as soon as their
+// dependencies are done, without allocating anything per command.
+struct ur_exp_command_buffer_handle_t_ : RefCounted {
+  ur_exp_command_buffer_handle_t_(ur_context_handle_t context,
+                                  ur_device_handle_t device,
+                                  const ur_exp_command_buffer_desc_t *desc);
+
+  ~ur_exp_command_buffer_handle_t_();
+
+  // Adds a node that depends on the nodes of the given sync points, and on the
+  // previous node if the command-buffer is in order.
+  ur_result_t
+  append(std::unique_ptr<native_cpu::command_node> node,
+         uint32_t numSyncPointsInWaitList,
+         const ur_exp_command_buffer_sync_point_t *pSyncPointWaitList,
+         ur_exp_command_buffer_sync_point_t *pSyncPoint,
+         ur_exp_command_buffer_command_handle_t *phCommand);
+
+  ur_result_t finalize();
+
+  ur_result_t enqueue(ur_queue_handle_t hQueue, uint32_t numEventsInWaitList,
+                      const ur_event_handle_t *phEventWaitList,
+                      ur_event_handle_t *phEvent);
+
+  ur_result_t
+  updateKernelLaunch(uint32_t nodeIndex,
+                     const ur_exp_command_buffer_update_kernel_launch_desc_t
+                         *pUpdateKernelLaunch);
+
+  ur_context_handle_t const context;
+  ur_device_handle_t const device;
+  const ur_exp_command_buffer_desc_t desc;
+  bool finalized = false;
+
+private:
+  void run(ur_event_handle_t event);
+  void startNode(native_cpu::command_node &node);
+  void runTask(native_cpu::command_node &node, size_t threadId);
+  void finishNode(native_cpu::command_node &node);
+
+  std::vector<std::unique_ptr<native_cpu::command_node>> nodes;
+  std::vector<uint32_t> roots;
+
+  // State of the current run
+  std::atomic<size_t> pendingNodes{0};
+  ur_event_handle_t runEvent = nullptr;
+
+  // Runs share the state of the nodes, so every submission waits for the
+  // previous one to complete, and updates wait for the last one.
+  std::mutex submitMutex;
+  ur_event_handle_t lastSubmission = nullptr;
+};
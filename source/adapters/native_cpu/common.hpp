@@ -10,6 +10,9 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+
 #include "logger/ur_logger.hpp"
 #include "ur/ur.hpp"
 
@@ -70,3 +73,14 @@ template <typename T> inline void decrementOrDelete(T *refC) {
   if (refC->decrementReferenceCount() == 0)
     delete refC;
 }
+
+namespace native_cpu {
+
+// Device timestamps, which are nanoseconds of the host's monotonic clock.
+inline uint64_t get_timestamp() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+      .count();
+}
+
+} // namespace native_cpu
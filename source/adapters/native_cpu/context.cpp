@@ -16,6 +16,16 @@
 
 #include "common.hpp"
 #include "context.hpp"
+#include "usm.hpp"
+
+ur_context_handle_t_::ur_context_handle_t_(ur_device_handle_t_ *phDevices)
+    : _device{phDevices} {
+  ur_usm_pool_desc_t PoolDesc{UR_STRUCTURE_TYPE_USM_POOL_DESC, nullptr, 0};
+  default_pool = std::make_unique<ur_usm_pool_handle_t_>(this, &PoolDesc);
+}
+
+// Out of line, as the pool type is incomplete in the header
+ur_context_handle_t_::~ur_context_handle_t_() = default;
 
 UR_APIEXPORT ur_result_t UR_APICALL urContextCreate(
     [[maybe_unused]] uint32_t DeviceCount, const ur_device_handle_t *phDevices,
@@ -25,8 +35,13 @@ UR_APIEXPORT ur_result_t UR_APICALL urContextCreate(
   assert(DeviceCount == 1);
 
   // TODO: Proper error checking.
-  auto ctx = new ur_context_handle_t_(*phDevices);
-  *phContext = ctx;
+  try {
+    *phContext = new ur_context_handle_t_(*phDevices);
+  } catch (ur_result_t Err) {
+    return Err;
+  } catch (const std::bad_alloc &) {
+    return UR_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+  }
   return UR_RESULT_SUCCESS;
 }
 
@@ -55,11 +70,8 @@ urContextGetInfo(ur_context_handle_t hContext, ur_context_info_t propName,
   case UR_CONTEXT_INFO_REFERENCE_COUNT:
     return returnValue(uint32_t{hContext->getReferenceCount()});
   case UR_CONTEXT_INFO_USM_MEMCPY2D_SUPPORT:
-    return returnValue(true);
   case UR_CONTEXT_INFO_USM_FILL2D_SUPPORT:
-    // case UR_CONTEXT_INFO_USM_MEMSET2D_SUPPORT:
-    // 2D USM operations currently not supported.
-    return returnValue(false);
+    return returnValue(true);
   case UR_CONTEXT_INFO_ATOMIC_MEMORY_ORDER_CAPABILITIES:
   case UR_CONTEXT_INFO_ATOMIC_MEMORY_SCOPE_CAPABILITIES:
   case UR_CONTEXT_INFO_ATOMIC_FENCE_ORDER_CAPABILITIES:
@@ -10,13 +10,17 @@
 
 #pragma once
 
-#include <mutex>
-#include <set>
+#include <array>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <umf/memory_pool.h>
 #include <ur_api.h>
 
 #include "common.hpp"
 #include "device.hpp"
 #include "ur/ur.hpp"
+#include "virtual_mem.hpp"
 
 namespace native_cpu {
 struct usm_alloc_info {
@@ -26,126 +30,135 @@ struct usm_alloc_info {
   ur_device_handle_t device;
   ur_usm_pool_handle_t pool;
 
-  // We store a pointer to the actual allocation because it is needed when
-  // freeing memory.
-  void *base_alloc_ptr;
+  // The UMF pool the allocation came from, which is needed when freeing
+  // memory. Unlike `pool` this is never null.
+  umf_memory_pool_handle_t umf_pool;
   constexpr usm_alloc_info(ur_usm_type_t type, const void *base_ptr,
                            size_t size, ur_device_handle_t device,
-                           ur_usm_pool_handle_t pool, void *base_alloc_ptr)
+                           ur_usm_pool_handle_t pool,
+                           umf_memory_pool_handle_t umf_pool)
       : type(type), base_ptr(base_ptr), size(size), device(device), pool(pool),
-        base_alloc_ptr(base_alloc_ptr) {}
+        umf_pool(umf_pool) {}
 };
 
 constexpr usm_alloc_info usm_alloc_info_null_entry(UR_USM_TYPE_UNKNOWN, nullptr,
                                                    0, nullptr, nullptr,
                                                    nullptr);
 
-constexpr size_t alloc_header_size = sizeof(usm_alloc_info);
-
-// Computes the padding that we need to add to ensure the
-// pointer returned by UR is aligned as the user requested.
-static size_t get_padding(uint32_t alignment) {
-  assert(alignment >= alignof(usm_alloc_info) &&
-         "memory not aligned to usm_alloc_info");
-  if (!alignment || alloc_header_size % alignment == 0)
-    return 0;
-  size_t padd = 0;
-  if (alignment <= alloc_header_size) {
-    padd = alignment - (alloc_header_size % alignment);
-  } else {
-    padd = alignment - alloc_header_size;
+// Maps USM pointers to the allocation they belong to. Allocations are spread
+// over shards by their base address, each with its own reader-writer lock, so
+// that allocations, frees and queries made by different threads rarely
+// contend. Pointers into the middle of an allocation are resolved by searching
+// every shard.
+class usm_alloc_index {
+public:
+  void insert(const usm_alloc_info &info) {
+    shard &s = get_shard(info.base_ptr);
+    std::unique_lock<std::shared_mutex> lock(s.mutex);
+    s.allocs.emplace(reinterpret_cast<uintptr_t>(info.base_ptr), info);
   }
-  return padd;
-}
-
-// In order to satisfy the MemAllocInfo queries we allocate extra memory
-// for the native_cpu::usm_alloc_info struct.
-// To satisfy the alignment requirements we "pad" the memory
-// allocation so that the pointer returned to the user
-// always satisfies (ptr % align) == 0.
-static inline void *malloc_impl(uint32_t alignment, size_t size) {
-  void *ptr = nullptr;
-  assert(alignment >= alignof(usm_alloc_info) &&
-         "memory not aligned to usm_alloc_info");
-#ifdef _MSC_VER
-  ptr = _aligned_malloc(alloc_header_size + get_padding(alignment) + size,
-                        alignment);
-
-#else
-  ptr = std::aligned_alloc(alignment,
-                           alloc_header_size + get_padding(alignment) + size);
-#endif
-  return ptr;
-}
-
-// The info struct is retrieved by subtracting its size from the pointer
-// returned to the user.
-static inline uint8_t *get_alloc_info_addr(const void *ptr) {
-  return (uint8_t *)const_cast<void *>(ptr) - alloc_header_size;
-}
-
-static usm_alloc_info get_alloc_info(void *ptr) {
-  return *(usm_alloc_info *)get_alloc_info_addr(ptr);
-}
+
+  // Removes the allocation starting at `ptr` and returns it, or the null entry
+  // if there is none.
+  usm_alloc_info erase(const void *ptr) {
+    shard &s = get_shard(ptr);
+    std::unique_lock<std::shared_mutex> lock(s.mutex);
+    auto it = s.allocs.find(reinterpret_cast<uintptr_t>(ptr));
+    if (it == s.allocs.end())
+      return usm_alloc_info_null_entry;
+    usm_alloc_info info = it->second;
+    s.allocs.erase(it);
+    return info;
+  }
+
+  // Removes every allocation made from `pool`.
+  void erase_pool(ur_usm_pool_handle_t pool) {
+    for (shard &s : m_shards) {
+      std::unique_lock<std::shared_mutex> lock(s.mutex);
+      for (auto it = s.allocs.begin(); it != s.allocs.end();) {
+        if (it->second.pool == pool)
+          it = s.allocs.erase(it);
+        else
+          ++it;
+      }
+    }
+  }
+
+  // Returns the allocation `ptr` points into, or the null entry if there is
+  // none.
+  usm_alloc_info find(const void *ptr) const {
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+    // Most queries are made with the pointer that was returned to the user.
+    {
+      const shard &s = get_shard(ptr);
+      std::shared_lock<std::shared_mutex> lock(s.mutex);
+      auto it = s.allocs.find(addr);
+      if (it != s.allocs.end())
+        return it->second;
+    }
+    for (const shard &s : m_shards) {
+      std::shared_lock<std::shared_mutex> lock(s.mutex);
+      auto it = s.allocs.upper_bound(addr);
+      if (it == s.allocs.begin())
+        continue;
+      --it;
+      if (addr - it->first < it->second.size)
+        return it->second;
+    }
+    return usm_alloc_info_null_entry;
+  }
+
+private:
+  static constexpr size_t num_shards = 64;
+
+  struct alignas(64) shard {
+    mutable std::shared_mutex mutex;
+    std::map<uintptr_t, usm_alloc_info> allocs;
+  };
+
+  // Small allocations of a pool are close to each other, so mix the address
+  // bits rather than using the low ones directly.
+  static size_t get_shard_index(const void *ptr) {
+    uint64_t key = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr) >> 4);
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 58);
+  }
+  static_assert(num_shards == 64, "get_shard_index yields 6 bits");
+
+  shard &get_shard(const void *ptr) { return m_shards[get_shard_index(ptr)]; }
+  const shard &get_shard(const void *ptr) const {
+    return m_shards[get_shard_index(ptr)];
+  }
+
+  std::array<shard, num_shards> m_shards;
+};
 
 } // namespace native_cpu
 
 struct ur_context_handle_t_ : RefCounted {
-  ur_context_handle_t_(ur_device_handle_t_ *phDevices) : _device{phDevices} {}
+  ur_context_handle_t_(ur_device_handle_t_ *phDevices);
+  ~ur_context_handle_t_();
 
   ur_device_handle_t _device;
 
-  ur_result_t remove_alloc(void *ptr) {
-    std::lock_guard<std::mutex> lock(alloc_mutex);
-    const native_cpu::usm_alloc_info &info = native_cpu::get_alloc_info(ptr);
-    UR_ASSERT(info.type != UR_USM_TYPE_UNKNOWN,
-              UR_RESULT_ERROR_INVALID_MEM_OBJECT);
-#ifdef _MSC_VER
-    _aligned_free(info.base_alloc_ptr);
-#else
-    free(info.base_alloc_ptr);
-#endif
-    allocations.erase(ptr);
-    return UR_RESULT_SUCCESS;
+  ur_result_t remove_alloc(void *ptr);
+
+  native_cpu::usm_alloc_info get_alloc_info_entry(const void *ptr) const {
+    return allocations.find(ptr);
   }
 
-  // Note this is made non-const to access the mutex
-  const native_cpu::usm_alloc_info &get_alloc_info_entry(const void *ptr) {
-    std::lock_guard<std::mutex> lock(alloc_mutex);
-    auto it = allocations.find(ptr);
-    if (it == allocations.end()) {
-      return native_cpu::usm_alloc_info_null_entry;
-    }
+  // Allocates from `pool`, or from the context's default pool if it is null.
+  ur_result_t add_alloc(uint32_t alignment, ur_usm_type_t type, size_t size,
+                        ur_usm_pool_handle_t pool, void **ppMem);
 
-    return *(native_cpu::usm_alloc_info *)native_cpu::get_alloc_info_addr(ptr);
+  // Forgets the allocations of a pool that is being destroyed.
+  void remove_pool_allocs(ur_usm_pool_handle_t pool) {
+    allocations.erase_pool(pool);
   }
 
-  void *add_alloc(uint32_t alignment, ur_usm_type_t type, size_t size,
-                  ur_usm_pool_handle_t pool) {
-    std::lock_guard<std::mutex> lock(alloc_mutex);
-    // We need to ensure that we align to at least alignof(usm_alloc_info),
-    // otherwise its start address may be unaligned.
-    alignment =
-        std::max<size_t>(alignment, alignof(native_cpu::usm_alloc_info));
-    void *alloc = native_cpu::malloc_impl(alignment, size);
-    if (!alloc)
-      return nullptr;
-    // Compute the address of the pointer that we'll return to the user.
-    void *ptr = native_cpu::alloc_header_size +
-                native_cpu::get_padding(alignment) + (uint8_t *)alloc;
-    uint8_t *info_addr = native_cpu::get_alloc_info_addr(ptr);
-    if (!info_addr)
-      return nullptr;
-    // Do a placement new of the alloc_info to avoid allocation and copy
-    auto info = new (info_addr)
-        native_cpu::usm_alloc_info(type, ptr, size, this->_device, pool, alloc);
-    if (!info)
-      return nullptr;
-    allocations.insert(ptr);
-    return ptr;
-  }
+  // Access flags of the virtual memory ranges mapped in this context.
+  native_cpu::virtual_access_map virtual_access;
 
 private:
-  std::mutex alloc_mutex;
-  std::set<const void *> allocations;
+  std::unique_ptr<ur_usm_pool_handle_t_> default_pool;
+  native_cpu::usm_alloc_index allocations;
 };
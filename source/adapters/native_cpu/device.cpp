@@ -10,6 +10,7 @@
 
 #include <ur_api.h>
 
+#include "local_memory.hpp"
 #include "platform.hpp"
 
 #if defined(_MSC_VER) || defined(__MINGW32__) || defined(__MINGW64__)
@@ -128,7 +129,7 @@ UR_APIEXPORT ur_result_t UR_APICALL urDeviceGetInfo(ur_device_handle_t hDevice,
   case UR_DEVICE_INFO_TYPE:
     return ReturnValue(UR_DEVICE_TYPE_CPU);
   case UR_DEVICE_INFO_PARENT_DEVICE:
-    return ReturnValue(nullptr);
+    return ReturnValue(hDevice->Parent);
   case UR_DEVICE_INFO_PLATFORM:
     return ReturnValue(hDevice->Platform);
   case UR_DEVICE_INFO_NAME:
@@ -156,7 +157,7 @@ UR_APIEXPORT ur_result_t UR_APICALL urDeviceGetInfo(ur_device_handle_t hDevice,
     // TODO : Populate return string accordingly - e.g. cl_khr_fp16,
     // cl_khr_fp64, cl_khr_int64_base_atomics,
     // cl_khr_int64_extended_atomics
-    return ReturnValue("cl_khr_fp16, cl_khr_fp64 ");
+    return ReturnValue("cl_khr_fp16, cl_khr_fp64, ur_exp_command_buffer ");
   case UR_DEVICE_INFO_VERSION:
     return ReturnValue("0.1");
   case UR_DEVICE_INFO_COMPILER_AVAILABLE:
@@ -166,14 +167,17 @@ UR_APIEXPORT ur_result_t UR_APICALL urDeviceGetInfo(ur_device_handle_t hDevice,
   case UR_DEVICE_INFO_MAX_COMPUTE_UNITS:
     return ReturnValue(static_cast<uint32_t>(hDevice->tp.num_threads()));
   case UR_DEVICE_INFO_PARTITION_MAX_SUB_DEVICES:
-    return ReturnValue(uint32_t{0});
+    return ReturnValue(static_cast<uint32_t>(hDevice->getNumSubDevices()));
   case UR_DEVICE_INFO_SUPPORTED_PARTITIONS:
-    // TODO: Ensure this property is tested correctly
-    // Taken from CUDA ur adapter
-    if (pPropSizeRet) {
-      *pPropSizeRet = 0;
+    // SYCL spec says: if this SYCL device cannot be partitioned into at least
+    // two sub devices then the returned vector must be empty.
+    if (hDevice->getNumSubDevices() == 0) {
+      if (pPropSizeRet) {
+        *pPropSizeRet = 0;
+      }
+      return UR_RESULT_SUCCESS;
     }
-    return UR_RESULT_SUCCESS;
+    return ReturnValue(UR_DEVICE_PARTITION_BY_AFFINITY_DOMAIN);
   case UR_DEVICE_INFO_VENDOR_ID:
     // '0x8086' : 'Intel HD graphics vendor ID'
     return ReturnValue(uint32_t{0x8086});
@@ -207,11 +211,19 @@ UR_APIEXPORT ur_result_t UR_APICALL urDeviceGetInfo(ur_device_handle_t hDevice,
   }
   case UR_DEVICE_INFO_MAX_WORK_ITEM_DIMENSIONS:
     return ReturnValue(uint32_t{3});
-  case UR_DEVICE_INFO_PARTITION_TYPE:
-    if (pPropSizeRet) {
-      *pPropSizeRet = 0;
+  case UR_DEVICE_INFO_PARTITION_TYPE: {
+    // For root-device there is no partitioning to report.
+    if (!hDevice->isSubDevice()) {
+      if (pPropSizeRet) {
+        *pPropSizeRet = 0;
+      }
+      return UR_RESULT_SUCCESS;
     }
-    return UR_RESULT_SUCCESS;
+    ur_device_partition_property_t Property{};
+    Property.type = UR_DEVICE_PARTITION_BY_AFFINITY_DOMAIN;
+    Property.value.affinity_domain = UR_DEVICE_AFFINITY_DOMAIN_FLAG_NUMA;
+    return ReturnValue(Property);
+  }
   case UR_EXT_DEVICE_INFO_OPENCL_C_VERSION:
     return ReturnValue("");
   case UR_DEVICE_INFO_QUEUE_PROPERTIES:
@@ -294,8 +306,7 @@ UR_APIEXPORT ur_result_t UR_APICALL urDeviceGetInfo(ur_device_handle_t hDevice,
   case UR_DEVICE_INFO_GLOBAL_MEM_SIZE:
     return ReturnValue(hDevice->mem_size);
   case UR_DEVICE_INFO_LOCAL_MEM_SIZE:
-    // TODO : CHECK
-    return ReturnValue(uint64_t{32768});
+    return ReturnValue(uint64_t{native_cpu::local_mem_size});
   case UR_DEVICE_INFO_MAX_CONSTANT_BUFFER_SIZE:
     // TODO : CHECK
     return ReturnValue(uint64_t{0});
@@ -308,8 +319,8 @@ UR_APIEXPORT ur_result_t UR_APICALL urDeviceGetInfo(ur_device_handle_t hDevice,
   case UR_DEVICE_INFO_ERROR_CORRECTION_SUPPORT:
     return ReturnValue(bool{false});
   case UR_DEVICE_INFO_PROFILING_TIMER_RESOLUTION:
-    // TODO : CHECK
-    return ReturnValue(size_t{0});
+    // Timestamps are in nanoseconds, see native_cpu::get_timestamp
+    return ReturnValue(size_t{1});
   case UR_DEVICE_INFO_BUILT_IN_KERNELS:
     // TODO : CHECK
     return ReturnValue("");
@@ -319,7 +330,12 @@ UR_APIEXPORT ur_result_t UR_APICALL urDeviceGetInfo(ur_device_handle_t hDevice,
   case UR_DEVICE_INFO_PREFERRED_INTEROP_USER_SYNC:
     return ReturnValue(bool{false});
   case UR_DEVICE_INFO_PARTITION_AFFINITY_DOMAIN:
-    return ReturnValue(ur_device_affinity_domain_flags_t{0});
+    if (hDevice->getNumSubDevices() == 0) {
+      return ReturnValue(ur_device_affinity_domain_flags_t{0});
+    }
+    return ReturnValue(ur_device_affinity_domain_flags_t{
+        UR_DEVICE_AFFINITY_DOMAIN_FLAG_NUMA |
+        UR_DEVICE_AFFINITY_DOMAIN_FLAG_NEXT_PARTITIONABLE});
   case UR_DEVICE_INFO_MAX_MEM_ALLOC_SIZE: {
     size_t Global = hDevice->mem_size;
 
@@ -399,20 +415,30 @@ UR_APIEXPORT ur_result_t UR_APICALL urDeviceGetInfo(ur_device_handle_t hDevice,
 
     CASE_UR_UNSUPPORTED(UR_DEVICE_INFO_MAX_MEMORY_BANDWIDTH);
   case UR_DEVICE_INFO_VIRTUAL_MEMORY_SUPPORT:
+#ifdef __linux__
+    return ReturnValue(true);
+#else
     return ReturnValue(false);
+#endif
 
   case UR_DEVICE_INFO_COMMAND_BUFFER_SUPPORT_EXP:
+    return ReturnValue(true);
   case UR_DEVICE_INFO_COMMAND_BUFFER_EVENT_SUPPORT_EXP:
     return ReturnValue(false);
   case UR_DEVICE_INFO_COMMAND_BUFFER_UPDATE_CAPABILITIES_EXP:
     return ReturnValue(
-        static_cast<ur_device_command_buffer_update_capability_flags_t>(0));
+        static_cast<ur_device_command_buffer_update_capability_flags_t>(
+            UR_DEVICE_COMMAND_BUFFER_UPDATE_CAPABILITY_FLAG_KERNEL_ARGUMENTS |
+            UR_DEVICE_COMMAND_BUFFER_UPDATE_CAPABILITY_FLAG_LOCAL_WORK_SIZE |
+            UR_DEVICE_COMMAND_BUFFER_UPDATE_CAPABILITY_FLAG_GLOBAL_WORK_SIZE |
+            UR_DEVICE_COMMAND_BUFFER_UPDATE_CAPABILITY_FLAG_GLOBAL_WORK_OFFSET |
+            UR_DEVICE_COMMAND_BUFFER_UPDATE_CAPABILITY_FLAG_KERNEL_HANDLE));
 
   case UR_DEVICE_INFO_TIMESTAMP_RECORDING_SUPPORT_EXP:
-    return ReturnValue(false);
+    return ReturnValue(true);
 
   case UR_DEVICE_INFO_ENQUEUE_NATIVE_COMMAND_SUPPORT_EXP:
-    return ReturnValue(false);
+    return ReturnValue(true);
 
   default:
     DIE_NO_IMPLEMENTATION;
@@ -437,13 +463,35 @@ UR_APIEXPORT ur_result_t UR_APICALL urDevicePartition(
     ur_device_handle_t hDevice,
     const ur_device_partition_properties_t *pProperties, uint32_t NumDevices,
     ur_device_handle_t *phSubDevices, uint32_t *pNumDevicesRet) {
-  std::ignore = hDevice;
-  std::ignore = NumDevices;
-  std::ignore = pProperties;
-  std::ignore = phSubDevices;
-  std::ignore = pNumDevicesRet;
+  UR_ASSERT(hDevice, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pProperties, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  // Only partitioning by NUMA node is supported
+  UR_ASSERT(pProperties->PropCount == 1, UR_RESULT_ERROR_INVALID_VALUE);
+  const ur_device_partition_property_t &Property = *pProperties->pProperties;
+  if (Property.type != UR_DEVICE_PARTITION_BY_AFFINITY_DOMAIN ||
+      (Property.value.affinity_domain != UR_DEVICE_AFFINITY_DOMAIN_FLAG_NUMA &&
+       Property.value.affinity_domain !=
+           UR_DEVICE_AFFINITY_DOMAIN_FLAG_NEXT_PARTITIONABLE)) {
+    return UR_RESULT_ERROR_INVALID_VALUE;
+  }
 
-  DIE_NO_IMPLEMENTATION;
+  const auto &SubDevices = hDevice->getSubDevices();
+  if (SubDevices.empty()) {
+    return UR_RESULT_ERROR_DEVICE_PARTITION_FAILED;
+  }
+
+  // Partitioning always creates every sub-device
+  if (NumDevices != 0) {
+    UR_ASSERT(NumDevices == SubDevices.size(), UR_RESULT_ERROR_INVALID_VALUE);
+  }
+  for (uint32_t I = 0; I < NumDevices; I++) {
+    phSubDevices[I] = SubDevices[I].get();
+  }
+  if (pNumDevicesRet) {
+    *pNumDevicesRet = static_cast<uint32_t>(SubDevices.size());
+  }
+  return UR_RESULT_SUCCESS;
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urDeviceGetNativeHandle(
@@ -469,20 +517,14 @@ UR_APIEXPORT ur_result_t UR_APICALL urDeviceCreateWithNativeHandle(
 UR_APIEXPORT ur_result_t UR_APICALL urDeviceGetGlobalTimestamps(
     ur_device_handle_t hDevice, uint64_t *pDeviceTimestamp,
     uint64_t *pHostTimestamp) {
-  std::ignore = hDevice; // todo
-  if (pHostTimestamp) {
-    using namespace std::chrono;
-    *pHostTimestamp =
-        duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
-            .count();
-  }
-  if (pDeviceTimestamp) {
-    // todo: calculate elapsed time properly
-    using namespace std::chrono;
-    *pDeviceTimestamp =
-        duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
-            .count();
-  }
+  std::ignore = hDevice;
+  // The device runs on the host, so both share the clock that events are
+  // timestamped with.
+  const uint64_t timestamp = native_cpu::get_timestamp();
+  if (pHostTimestamp)
+    *pHostTimestamp = timestamp;
+  if (pDeviceTimestamp)
+    *pDeviceTimestamp = timestamp;
   return UR_RESULT_SUCCESS;
 }
 
@@ -511,4 +553,46 @@ UR_APIEXPORT ur_result_t UR_APICALL urDeviceSelectBinary(
 }
 
 ur_device_handle_t_::ur_device_handle_t_(ur_platform_handle_t ArgPlt)
-    : mem_size(os_memory_bounded_size()), Platform(ArgPlt) {}
+    : Nodes(native_cpu::get_numa_nodes()),
+      tp(native_cpu::get_worker_placement(native_cpu::detail::get_num_threads(),
+                                          native_cpu::get_affinity_policy(),
+                                          Nodes)),
+      mem_size(os_memory_bounded_size()), Platform(ArgPlt) {}
+
+// Sub-devices always keep their workers on their node, even if no affinity
+// policy was requested for the root device.
+static native_cpu::affinity_policy getSubDevicePolicy() {
+  auto Policy = native_cpu::get_affinity_policy();
+  return Policy == native_cpu::affinity_policy::none
+             ? native_cpu::affinity_policy::numa
+             : Policy;
+}
+
+ur_device_handle_t_::ur_device_handle_t_(ur_platform_handle_t ArgPlt,
+                                         ur_device_handle_t Parent,
+                                         native_cpu::numa_node Node,
+                                         size_t NumThreads)
+    : Nodes{std::move(Node)},
+      tp(native_cpu::get_worker_placement(NumThreads, getSubDevicePolicy(),
+                                          Nodes)),
+      mem_size(os_memory_bounded_size()), Platform(ArgPlt), Parent(Parent) {}
+
+const std::vector<std::unique_ptr<ur_device_handle_t_>> &
+ur_device_handle_t_::getSubDevices() {
+  std::call_once(SubDevicesFlag, [this]() {
+    if (getNumSubDevices() == 0)
+      return;
+    size_t NumCpus = 0;
+    for (auto &Node : Nodes)
+      NumCpus += Node.cpus.size();
+    // Share the root device's threads between the nodes according to their
+    // number of CPUs.
+    for (auto &Node : Nodes) {
+      size_t NumThreads =
+          std::max<size_t>(1, tp.num_threads() * Node.cpus.size() / NumCpus);
+      SubDevices.push_back(std::make_unique<ur_device_handle_t_>(
+          Platform, this, Node, NumThreads));
+    }
+  });
+  return SubDevices;
+}
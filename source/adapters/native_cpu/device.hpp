@@ -10,13 +10,45 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "numa.hpp"
 #include "threadpool.hpp"
 #include <ur/ur.hpp>
 
 struct ur_device_handle_t_ {
+  // NUMA nodes the device runs on, sub-devices run on exactly one.
+  const std::vector<native_cpu::numa_node> Nodes;
   native_cpu::threadpool_t tp;
   ur_device_handle_t_(ur_platform_handle_t ArgPlt);
 
+  // Creates the sub-device of `Parent` that runs on `Node`, with a thread
+  // pool of its own restricted to the node's CPUs.
+  ur_device_handle_t_(ur_platform_handle_t ArgPlt, ur_device_handle_t Parent,
+                      native_cpu::numa_node Node, size_t NumThreads);
+
   const uint64_t mem_size;
   ur_platform_handle_t Platform;
+  // The device this one was partitioned from, null for the root device.
+  const ur_device_handle_t Parent = nullptr;
+
+  bool isSubDevice() const { return Parent != nullptr; }
+
+  // Number of sub-devices partitioning creates: one per NUMA node, or none if
+  // the device can't be partitioned. Doesn't create them.
+  size_t getNumSubDevices() const {
+    // Sub-devices can't be partitioned further, and a device on a single
+    // node can't be split into at least two sub-devices.
+    return isSubDevice() || Nodes.size() < 2 ? 0 : Nodes.size();
+  }
+
+  // Returns one sub-device per NUMA node, creating them on first use. Empty
+  // if the device can't be partitioned.
+  const std::vector<std::unique_ptr<ur_device_handle_t_>> &getSubDevices();
+
+private:
+  std::once_flag SubDevicesFlag;
+  std::vector<std::unique_ptr<ur_device_handle_t_>> SubDevices;
 };
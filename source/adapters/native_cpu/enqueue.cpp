@@ -5,18 +5,28 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <vector>
 
 #include "ur_api.h"
 
 #include "common.hpp"
+#include "event.hpp"
 #include "kernel.hpp"
+#include "latch.hpp"
+#include "launch.hpp"
 #include "memory.hpp"
 #include "queue.hpp"
+#include "schedule.hpp"
 #include "threadpool.hpp"
+#include "transfer.hpp"
+#include "usm.hpp"
 
 namespace native_cpu {
 struct NDRDescT {
@@ -51,36 +61,260 @@ struct NDRDescT {
 };
 } // namespace native_cpu
 
+namespace native_cpu {
+// A launch in flight. All of its tasks run the same borrowed worker task, and
+// the last one to finish completes the event, releases the reference to it
+// that the queue handed over when the command was submitted, and frees the
+// launch, so a launch costs a single allocation whatever its number of tasks.
+struct launch_job {
+  launch_job(std::shared_ptr<launch_plan> plan, ur_event_handle_t event,
+             uint32_t numTasks)
+      : plan(std::move(plan)), event(event), remaining(numTasks),
+        task([this](size_t threadId) { runTask(threadId); }) {}
+
+  void runTask(size_t threadId) {
+    event->markStarted();
+    plan->run(threadId);
+    if (!remaining.count_down())
+      return;
+    if (plan->failed())
+      event->markFailed();
+    event->complete();
+    decrementOrDelete(event);
+    // Nothing is touched once the task that is running has been freed
+    delete this;
+  }
+
+  const std::shared_ptr<launch_plan> plan;
+  const ur_event_handle_t event;
+  latch remaining;
+  const worker_task_t task;
+};
+
+static void scheduleLaunch(threadpool_t &tp, std::shared_ptr<launch_plan> plan,
+                           ur_event_handle_t event) {
+  const size_t numTasks = plan->num_tasks();
+  if (numTasks == 0) {
+    event->complete();
+    decrementOrDelete(event);
+    return;
+  }
+  auto job = new launch_job(std::move(plan), event,
+                            static_cast<uint32_t>(numTasks));
+  tp.schedule_bulk(job->task, numTasks, event->getQueue()->priority());
+}
+
+// Enqueues a transfer, which runs `fn` as a task of the device's thread pool
+// once the command is submitted, like a launch. Only returns once the
+// transfer has completed if `blocking` is set.
+static ur_result_t enqueueTransfer(ur_command_t commandType,
+                                   ur_queue_handle_t hQueue, bool blocking,
+                                   uint32_t numEventsInWaitList,
+                                   const ur_event_handle_t *phEventWaitList,
+                                   ur_event_handle_t *phEvent,
+                                   std::function<void(threadpool_t &)> fn) {
+  auto &tp = hQueue->device->tp;
+  ur_event_handle_t event = nullptr;
+  ur_result_t result = hQueue->enqueue(
+      commandType, numEventsInWaitList, phEventWaitList,
+      phEvent || blocking ? &event : nullptr,
+      [&tp, fn = std::move(fn)](ur_event_handle_t event) {
+        tp.schedule(
+            [&tp, fn, event](size_t) {
+              event->markStarted();
+              fn(tp);
+              event->complete();
+              decrementOrDelete(event);
+            },
+            event->getQueue()->priority());
+      });
+  if (result != UR_RESULT_SUCCESS)
+    return result;
+  if (blocking)
+    event->wait();
+  if (phEvent)
+    *phEvent = event;
+  else if (event)
+    decrementOrDelete(event);
+  return UR_RESULT_SUCCESS;
+}
+} // namespace native_cpu
+
+namespace native_cpu {
+// Work shared by all the tasks of a launch. Every task keeps claiming ranges
+// of work units from the schedule until there are none left, so the launch
+// is balanced dynamically rather than split up front.
+struct DispatchBase : launch_plan {
+  DispatchBase(ur_kernel_handle_t hKernel, arg_arena *args, size_t numUnits,
+               size_t numTasks, const threadpool_t &tp)
+      : kernel(hKernel, args), tp(tp), numTasks(numTasks),
+        schedule(numUnits, tp.workers_per_node()) {
+    if (busy_time_report::enabled())
+      report = std::make_unique<busy_time_report>(kernel.getName(),
+                                                  tp.num_threads());
+  }
+
+  size_t num_tasks() const override { return numTasks; }
+
+  void reset() override {
+    schedule.reset();
+    ran.store(false, std::memory_order_relaxed);
+  }
+
+  bool failed() const override { return !ran.load(std::memory_order_relaxed); }
+
+  template <typename F> void runClaimed(size_t threadId, F &&runRange) {
+    ran.store(true, std::memory_order_relaxed);
+    auto start = busy_time_report::clock::now();
+    const size_t node = tp.worker_node(threadId);
+    size_t begin, end;
+    while (schedule.next(node, begin, end))
+      runRange(begin, end);
+    if (report)
+      report->add(threadId, start);
+  }
+
+  const kernel_launch kernel;
+  const threadpool_t &tp;
+  const size_t numTasks;
+  node_schedule schedule;
+  std::unique_ptr<busy_time_report> report;
+  // Set by the tasks that got their local memory
+  std::atomic<bool> ran = false;
+};
+
+// Dispatches the work-groups of an nd_range launch, the work units are the
+// linearized work-group IDs, dimension 0 being the fastest moving one.
+struct WGDispatch : DispatchBase {
+  WGDispatch(const state &ndrState, ur_kernel_handle_t hKernel,
+             arg_arena *args, size_t numWG0, size_t numWG1, size_t numWG2,
+             const threadpool_t &tp)
+      : DispatchBase(hKernel, args, numWG0 * numWG1 * numWG2,
+                     std::min(numWG0 * numWG1 * numWG2, tp.num_threads()), tp),
+        ndrState(ndrState), numWG0(numWG0), numWG1(numWG1) {}
+
+  void run(size_t threadId) override {
+    state groupState = ndrState;
+    std::vector<NativeCPUArgDesc> threadArgs;
+    const NativeCPUArgDesc *args = kernel.getArgs(threadArgs);
+    if (!args)
+      return;
+    runClaimed(threadId, [&](size_t begin, size_t end) {
+      size_t g0 = begin % numWG0;
+      size_t g1 = (begin / numWG0) % numWG1;
+      size_t g2 = begin / (numWG0 * numWG1);
+      for (size_t id = begin; id < end; id++) {
+        runGroup(args, groupState, g0, g1, g2);
+        if (++g0 == numWG0) {
+          g0 = 0;
+          if (++g1 == numWG1) {
+            g1 = 0;
+            g2++;
+          }
+        }
+      }
+    });
+  }
+
 #ifdef NATIVECPU_USE_OCK
-static native_cpu::state getResizedState(const native_cpu::NDRDescT &ndr,
-                                         size_t itemsPerThread) {
-  native_cpu::state resized_state(
+  // The kernel loops over the work-items of the group itself.
+  void runGroup(const NativeCPUArgDesc *args, state &groupState, size_t g0,
+                size_t g1, size_t g2) const {
+    groupState.update(g0, g1, g2);
+    kernel.run(args, &groupState);
+  }
+#else
+  // Without the work-item loop, the kernel runs one work-item per call. The
+  // items of a group run on the same thread, so they share its local memory.
+  void runGroup(const NativeCPUArgDesc *args, state &groupState, size_t g0,
+                size_t g1, size_t g2) const {
+    const size_t *localSize = ndrState.MWorkGroup_size;
+    for (size_t l2 = 0; l2 < localSize[2]; l2++) {
+      for (size_t l1 = 0; l1 < localSize[1]; l1++) {
+        for (size_t l0 = 0; l0 < localSize[0]; l0++) {
+          groupState.update(g0, g1, g2, l0, l1, l2);
+          kernel.run(args, &groupState);
+        }
+      }
+    }
+  }
+#endif
+
+  const state ndrState;
+  const size_t numWG0;
+  const size_t numWG1;
+};
+
+#ifdef NATIVECPU_USE_OCK
+static state getResizedState(const NDRDescT &ndr, size_t itemsPerThread) {
+  state resized_state(
       ndr.GlobalSize[0], ndr.GlobalSize[1], ndr.GlobalSize[2], itemsPerThread,
       ndr.LocalSize[1], ndr.LocalSize[2], ndr.GlobalOffset[0],
       ndr.GlobalOffset[1], ndr.GlobalOffset[2]);
   return resized_state;
 }
-#endif
-
-UR_APIEXPORT ur_result_t UR_APICALL urEnqueueKernelLaunch(
-    ur_queue_handle_t hQueue, ur_kernel_handle_t hKernel, uint32_t workDim,
-    const size_t *pGlobalWorkOffset, const size_t *pGlobalWorkSize,
-    const size_t *pLocalWorkSize, uint32_t numEventsInWaitList,
-    const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent) {
-  std::ignore = numEventsInWaitList;
-  std::ignore = phEventWaitList;
-  std::ignore = phEvent;
 
-  UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
-  UR_ASSERT(hKernel, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
-  UR_ASSERT(pGlobalWorkOffset, UR_RESULT_ERROR_INVALID_NULL_POINTER);
-  UR_ASSERT(workDim > 0, UR_RESULT_ERROR_INVALID_WORK_DIMENSION);
-  UR_ASSERT(workDim < 4, UR_RESULT_ERROR_INVALID_WORK_DIMENSION);
+// Dispatches a launch over a sycl::range, where the local size is one. Each
+// row of dimension 0 is cut into groups of `itemsPerGroup` work-items that
+// the vectorized kernel runs in one call, plus one more unit for the items
+// left over, which are run one at a time.
+struct RangeDispatch : DispatchBase {
+  RangeDispatch(const NDRDescT &ndr, ur_kernel_handle_t hKernel,
+                arg_arena *args, size_t itemsPerGroup, const threadpool_t &tp)
+      : DispatchBase(hKernel, args,
+                     getUnitsPerRow(ndr, itemsPerGroup) * ndr.GlobalSize[1] *
+                         ndr.GlobalSize[2],
+                     tp.num_threads(), tp),
+        ndr(ndr), itemsPerGroup(itemsPerGroup),
+        groupsPerRow(ndr.GlobalSize[0] / itemsPerGroup),
+        unitsPerRow(getUnitsPerRow(ndr, itemsPerGroup)) {}
+
+  static size_t getUnitsPerRow(const NDRDescT &ndr, size_t itemsPerGroup) {
+    return (ndr.GlobalSize[0] + itemsPerGroup - 1) / itemsPerGroup;
+  }
 
-  if (*pGlobalWorkSize == 0) {
-    DIE_NO_IMPLEMENTATION;
+  void run(size_t threadId) override {
+    state resizedState = getResizedState(ndr, itemsPerGroup);
+    state peelState = getResizedState(ndr, 1);
+    std::vector<NativeCPUArgDesc> threadArgs;
+    const NativeCPUArgDesc *args = kernel.getArgs(threadArgs);
+    if (!args)
+      return;
+    runClaimed(threadId, [&](size_t begin, size_t end) {
+      for (size_t unit = begin; unit < end; unit++) {
+        size_t row = unit / unitsPerRow;
+        size_t g0 = unit % unitsPerRow;
+        size_t g1 = row % ndr.GlobalSize[1];
+        size_t g2 = row / ndr.GlobalSize[1];
+        if (g0 < groupsPerRow) {
+          resizedState.update(g0, g1, g2);
+          kernel.run(args, &resizedState);
+          continue;
+        }
+        // Peel the remaining work items. Since the local size is 1, we
+        // iterate over the work groups.
+        for (size_t item = groupsPerRow * itemsPerGroup;
+             item < ndr.GlobalSize[0]; item++) {
+          peelState.update(item, g1, g2);
+          kernel.run(args, &peelState);
+        }
+      }
+    });
   }
 
+  const NDRDescT ndr;
+  const size_t itemsPerGroup;
+  const size_t groupsPerRow;
+  const size_t unitsPerRow;
+};
+#endif // NATIVECPU_USE_OCK
+} // namespace native_cpu
+
+ur_result_t native_cpu::make_launch_plan(
+    ur_kernel_handle_t hKernel, arg_arena *args, uint32_t workDim,
+    const size_t *pGlobalWorkOffset, const size_t *pGlobalWorkSize,
+    const size_t *pLocalWorkSize, const threadpool_t &tp,
+    std::unique_ptr<launch_plan> &plan) {
   // Check reqd_work_group_size and other kernel constraints
   if (pLocalWorkSize != nullptr) {
     uint64_t TotalNumWIs = 1;
@@ -102,39 +336,24 @@ UR_APIEXPORT ur_result_t UR_APICALL urEnqueueKernelLaunch(
     }
   }
 
+  if (kernel_launch::getLocalMemSize(*args) > local_mem_size)
+    return UR_RESULT_ERROR_OUT_OF_RESOURCES;
+
   // TODO: add proper error checking
-  // TODO: add proper event dep management
-  native_cpu::NDRDescT ndr(workDim, pGlobalWorkOffset, pGlobalWorkSize,
-                           pLocalWorkSize);
-  auto &tp = hQueue->device->tp;
-  const size_t numParallelThreads = tp.num_threads();
-  hKernel->updateMemPool(numParallelThreads);
-  std::vector<std::future<void>> futures;
-  std::vector<std::function<void(size_t, ur_kernel_handle_t_)>> groups;
+  NDRDescT ndr(workDim, pGlobalWorkOffset, pGlobalWorkSize, pLocalWorkSize);
   auto numWG0 = ndr.GlobalSize[0] / ndr.LocalSize[0];
   auto numWG1 = ndr.GlobalSize[1] / ndr.LocalSize[1];
   auto numWG2 = ndr.GlobalSize[2] / ndr.LocalSize[2];
-  native_cpu::state state(ndr.GlobalSize[0], ndr.GlobalSize[1],
-                          ndr.GlobalSize[2], ndr.LocalSize[0], ndr.LocalSize[1],
-                          ndr.LocalSize[2], ndr.GlobalOffset[0],
-                          ndr.GlobalOffset[1], ndr.GlobalOffset[2]);
+  state state(ndr.GlobalSize[0], ndr.GlobalSize[1], ndr.GlobalSize[2],
+              ndr.LocalSize[0], ndr.LocalSize[1], ndr.LocalSize[2],
+              ndr.GlobalOffset[0], ndr.GlobalOffset[1], ndr.GlobalOffset[2]);
 #ifndef NATIVECPU_USE_OCK
-  hKernel->handleLocalArgs(1, 0);
-  for (unsigned g2 = 0; g2 < numWG2; g2++) {
-    for (unsigned g1 = 0; g1 < numWG1; g1++) {
-      for (unsigned g0 = 0; g0 < numWG0; g0++) {
-        for (unsigned local2 = 0; local2 < ndr.LocalSize[2]; local2++) {
-          for (unsigned local1 = 0; local1 < ndr.LocalSize[1]; local1++) {
-            for (unsigned local0 = 0; local0 < ndr.LocalSize[0]; local0++) {
-              state.update(g0, g1, g2, local0, local1, local2);
-              hKernel->_subhandler(hKernel->_args.data(), &state);
-            }
-          }
-        }
-      }
-    }
-  }
+  // Without the work-item loop there is no vectorized range kernel, so every
+  // launch is split into work-groups.
+  plan = std::make_unique<WGDispatch>(state, hKernel, args, numWG0, numWG1,
+                                      numWG2, tp);
 #else
+  const size_t numParallelThreads = tp.num_threads();
   bool isLocalSizeOne =
       ndr.LocalSize[0] == 1 && ndr.LocalSize[1] == 1 && ndr.LocalSize[2] == 1;
   if (isLocalSizeOne && ndr.GlobalSize[0] > numParallelThreads) {
@@ -148,141 +367,92 @@ UR_APIEXPORT ur_result_t UR_APICALL urEnqueueKernelLaunch(
     // parallelize
 
     // Since we also vectorize the kernel, and vectorization happens within the
-    // work group loop, it's better to have a large-ish local size. We can
-    // divide the global range by the number of threads, set that as the local
-    // size and peel everything else.
-
-    size_t new_num_work_groups_0 = numParallelThreads;
-    size_t itemsPerThread = ndr.GlobalSize[0] / numParallelThreads;
-
-    for (unsigned g2 = 0; g2 < numWG2; g2++) {
-      for (unsigned g1 = 0; g1 < numWG1; g1++) {
-        for (unsigned g0 = 0; g0 < new_num_work_groups_0; g0 += 1) {
-          futures.emplace_back(
-              tp.schedule_task([&ndr = std::as_const(ndr), itemsPerThread,
-                                hKernel, g0, g1, g2](size_t) {
-                native_cpu::state resized_state =
-                    getResizedState(ndr, itemsPerThread);
-                resized_state.update(g0, g1, g2);
-                hKernel->_subhandler(hKernel->_args.data(), &resized_state);
-              }));
-        }
-        // Peel the remaining work items. Since the local size is 1, we iterate
-        // over the work groups.
-        for (unsigned g0 = new_num_work_groups_0 * itemsPerThread; g0 < numWG0;
-             g0++) {
-          state.update(g0, g1, g2);
-          hKernel->_subhandler(hKernel->_args.data(), &state);
-        }
-      }
-    }
-
+    // work group loop, it's better to have a large-ish local size. We divide
+    // the global range into a few groups per thread, so that the threads can
+    // balance them between themselves, and peel everything else.
+    size_t itemsPerGroup =
+        std::max<size_t>(1, ndr.GlobalSize[0] / (numParallelThreads * 4));
+    plan = std::make_unique<RangeDispatch>(ndr, hKernel, args, itemsPerGroup,
+                                           tp);
   } else {
-    // We are running a parallel_for over an nd_range
-
-    if (numWG1 * numWG2 >= numParallelThreads) {
-      // Dimensions 1 and 2 have enough work, split them across the threadpool
-      for (unsigned g2 = 0; g2 < numWG2; g2++) {
-        for (unsigned g1 = 0; g1 < numWG1; g1++) {
-          futures.emplace_back(
-              tp.schedule_task([state, kernel = *hKernel, numWG0, g1, g2,
-                                numParallelThreads](size_t threadId) mutable {
-                for (unsigned g0 = 0; g0 < numWG0; g0++) {
-                  kernel.handleLocalArgs(numParallelThreads, threadId);
-                  state.update(g0, g1, g2);
-                  kernel._subhandler(kernel._args.data(), &state);
-                }
-              }));
-        }
-      }
-    } else {
-      // Split dimension 0 across the threadpool
-      // Here we try to create groups of workgroups in order to reduce
-      // synchronization overhead
-      for (unsigned g2 = 0; g2 < numWG2; g2++) {
-        for (unsigned g1 = 0; g1 < numWG1; g1++) {
-          for (unsigned g0 = 0; g0 < numWG0; g0++) {
-            groups.push_back(
-                [state, g0, g1, g2, numParallelThreads](
-                    size_t threadId, ur_kernel_handle_t_ kernel) mutable {
-                  kernel.handleLocalArgs(numParallelThreads, threadId);
-                  state.update(g0, g1, g2);
-                  kernel._subhandler(kernel._args.data(), &state);
-                });
-          }
-        }
-      }
-      auto numGroups = groups.size();
-      auto groupsPerThread = numGroups / numParallelThreads;
-      auto remainder = numGroups % numParallelThreads;
-      for (unsigned thread = 0; thread < numParallelThreads; thread++) {
-        futures.emplace_back(tp.schedule_task(
-            [&groups, thread, groupsPerThread, hKernel](size_t threadId) {
-              for (unsigned i = 0; i < groupsPerThread; i++) {
-                auto index = thread * groupsPerThread + i;
-                groups[index](threadId, *hKernel);
-              }
-            }));
-      }
-
-      // schedule the remaining tasks
-      if (remainder) {
-        futures.emplace_back(
-            tp.schedule_task([&groups, remainder,
-                              scheduled = numParallelThreads * groupsPerThread,
-                              hKernel](size_t threadId) {
-              for (unsigned i = 0; i < remainder; i++) {
-                auto index = scheduled + i;
-                groups[index](threadId, *hKernel);
-              }
-            }));
-      }
-    }
+    // We are running a parallel_for over an nd_range. The work-groups are
+    // linearized and the threads claim ranges of them, so the number of tasks
+    // and allocations doesn't depend on the number of work-groups.
+    plan = std::make_unique<WGDispatch>(state, hKernel, args, numWG0, numWG1,
+                                        numWG2, tp);
   }
-
-  for (auto &f : futures)
-    f.get();
 #endif // NATIVECPU_USE_OCK
-  // TODO: we should avoid calling clear here by avoiding using push_back
-  // in setKernelArgs.
-  hKernel->_args.clear();
-  hKernel->_localArgInfo.clear();
   return UR_RESULT_SUCCESS;
 }
 
+UR_APIEXPORT ur_result_t UR_APICALL urEnqueueKernelLaunch(
+    ur_queue_handle_t hQueue, ur_kernel_handle_t hKernel, uint32_t workDim,
+    const size_t *pGlobalWorkOffset, const size_t *pGlobalWorkSize,
+    const size_t *pLocalWorkSize, uint32_t numEventsInWaitList,
+    const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent) {
+  UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(hKernel, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pGlobalWorkOffset, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  UR_ASSERT(workDim > 0, UR_RESULT_ERROR_INVALID_WORK_DIMENSION);
+  UR_ASSERT(workDim < 4, UR_RESULT_ERROR_INVALID_WORK_DIMENSION);
+
+  if (*pGlobalWorkSize == 0) {
+    DIE_NO_IMPLEMENTATION;
+  }
+
+  auto &tp = hQueue->device->tp;
+  std::unique_ptr<native_cpu::launch_plan> plan;
+  ur_result_t result = native_cpu::make_launch_plan(
+      hKernel, hKernel->getArgArena(), workDim, pGlobalWorkOffset,
+      pGlobalWorkSize, pLocalWorkSize, tp, plan);
+  if (result != UR_RESULT_SUCCESS)
+    return result;
+
+  return hQueue->enqueue(
+      UR_COMMAND_KERNEL_LAUNCH, numEventsInWaitList, phEventWaitList, phEvent,
+      [&tp, plan = std::shared_ptr<native_cpu::launch_plan>(std::move(plan))](
+          ur_event_handle_t event) {
+        native_cpu::scheduleLaunch(tp, plan, event);
+      });
+}
+
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueEventsWait(
     ur_queue_handle_t hQueue, uint32_t numEventsInWaitList,
     const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent) {
-  std::ignore = hQueue;
-  std::ignore = numEventsInWaitList;
-  std::ignore = phEventWaitList;
-  std::ignore = phEvent;
+  UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
 
-  DIE_NO_IMPLEMENTATION;
+  return hQueue->enqueueWait(UR_COMMAND_EVENTS_WAIT, numEventsInWaitList,
+                             phEventWaitList, phEvent, false);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueEventsWaitWithBarrier(
     ur_queue_handle_t hQueue, uint32_t numEventsInWaitList,
     const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent) {
-  std::ignore = hQueue;
-  std::ignore = numEventsInWaitList;
-  std::ignore = phEventWaitList;
-  std::ignore = phEvent;
+  UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
 
-  DIE_NO_IMPLEMENTATION;
+  return hQueue->enqueueWait(UR_COMMAND_EVENTS_WAIT_WITH_BARRIER,
+                             numEventsInWaitList, phEventWaitList, phEvent,
+                             true);
+}
+
+// Makes sure the rectangle of a buffer that a command touches holds the host
+// data the buffer was created with.
+static inline void materializeRect(ur_mem_handle_t Buff, size_t Origin,
+                                   ur_rect_region_t Region, size_t RowPitch,
+                                   size_t SlicePitch) {
+  Buff->materialize(Origin, (Region.depth - 1) * SlicePitch +
+                                (Region.height - 1) * RowPitch + Region.width);
 }
 
 template <bool IsRead>
 static inline ur_result_t enqueueMemBufferReadWriteRect_impl(
-    ur_queue_handle_t, ur_mem_handle_t Buff, bool,
-    ur_rect_offset_t BufferOffset, ur_rect_offset_t HostOffset,
+    ur_command_t CommandType, ur_queue_handle_t hQueue, ur_mem_handle_t Buff,
+    bool Blocking, ur_rect_offset_t BufferOffset, ur_rect_offset_t HostOffset,
     ur_rect_region_t region, size_t BufferRowPitch, size_t BufferSlicePitch,
     size_t HostRowPitch, size_t HostSlicePitch,
     typename std::conditional<IsRead, void *, const void *>::type DstMem,
-    uint32_t, const ur_event_handle_t *, ur_event_handle_t *) {
-  // TODO: events, blocking, check other constraints, performance optimizations
-  //       More sharing with level_zero where possible
-
+    uint32_t NumEventsInWaitList, const ur_event_handle_t *EventWaitList,
+    ur_event_handle_t *Event) {
   if (BufferRowPitch == 0)
     BufferRowPitch = region.width;
   if (BufferSlicePitch == 0)
@@ -291,59 +461,71 @@ static inline ur_result_t enqueueMemBufferReadWriteRect_impl(
     HostRowPitch = region.width;
   if (HostSlicePitch == 0)
     HostSlicePitch = HostRowPitch * region.height;
-  for (size_t w = 0; w < region.width; w++)
-    for (size_t h = 0; h < region.height; h++)
-      for (size_t d = 0; d < region.depth; d++) {
-        size_t buff_orign = (d + BufferOffset.z) * BufferSlicePitch +
-                            (h + BufferOffset.y) * BufferRowPitch + w +
-                            BufferOffset.x;
-        size_t host_origin = (d + HostOffset.z) * HostSlicePitch +
-                             (h + HostOffset.y) * HostRowPitch + w +
-                             HostOffset.x;
-        int8_t &buff_mem = ur_cast<int8_t *>(Buff->_mem)[buff_orign];
+  native_cpu::rect_region Region{region.width, region.height, region.depth,
+                                 0, 0, 0, 0};
+  size_t BufferOrigin = BufferOffset.z * BufferSlicePitch +
+                        BufferOffset.y * BufferRowPitch + BufferOffset.x;
+  size_t HostOrigin = HostOffset.z * HostSlicePitch +
+                      HostOffset.y * HostRowPitch + HostOffset.x;
+  materializeRect(Buff, BufferOrigin, region, BufferRowPitch,
+                  BufferSlicePitch);
+  int8_t *BufferMem = ur_cast<int8_t *>(Buff->_mem) + BufferOrigin;
+  if constexpr (IsRead) {
+    Region.srcRowPitch = BufferRowPitch;
+    Region.srcSlicePitch = BufferSlicePitch;
+    Region.dstRowPitch = HostRowPitch;
+    Region.dstSlicePitch = HostSlicePitch;
+  } else {
+    Region.srcRowPitch = HostRowPitch;
+    Region.srcSlicePitch = HostSlicePitch;
+    Region.dstRowPitch = BufferRowPitch;
+    Region.dstSlicePitch = BufferSlicePitch;
+  }
+  return native_cpu::enqueueTransfer(
+      CommandType, hQueue, Blocking, NumEventsInWaitList, EventWaitList, Event,
+      [=](native_cpu::threadpool_t &tp) {
         if constexpr (IsRead)
-          ur_cast<int8_t *>(DstMem)[host_origin] = buff_mem;
+          native_cpu::copy_rect(tp, ur_cast<int8_t *>(DstMem) + HostOrigin,
+                                BufferMem, Region);
         else
-          buff_mem = ur_cast<const int8_t *>(DstMem)[host_origin];
-      }
-  return UR_RESULT_SUCCESS;
+          native_cpu::copy_rect(tp, BufferMem,
+                                ur_cast<const int8_t *>(DstMem) + HostOrigin,
+                                Region);
+      });
 }
 
-static inline ur_result_t doCopy_impl(ur_queue_handle_t hQueue, void *DstPtr,
-                                      const void *SrcPtr, size_t Size,
-                                      uint32_t numEventsInWaitList,
-                                      const ur_event_handle_t *EventWaitList,
-                                      ur_event_handle_t *Event) {
-  // todo: non-blocking, events, UR integration
-  std::ignore = EventWaitList;
-  std::ignore = Event;
-  std::ignore = hQueue;
-  std::ignore = numEventsInWaitList;
-  if (SrcPtr != DstPtr && Size)
-    memmove(DstPtr, SrcPtr, Size);
-  return UR_RESULT_SUCCESS;
+static inline ur_result_t
+doCopy_impl(ur_command_t CommandType, ur_queue_handle_t hQueue, bool Blocking,
+            void *DstPtr, const void *SrcPtr, size_t Size,
+            uint32_t numEventsInWaitList,
+            const ur_event_handle_t *EventWaitList, ur_event_handle_t *Event) {
+  return native_cpu::enqueueTransfer(
+      CommandType, hQueue, Blocking, numEventsInWaitList, EventWaitList, Event,
+      [=](native_cpu::threadpool_t &tp) {
+        native_cpu::copy_bytes(tp, DstPtr, SrcPtr, Size);
+      });
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemBufferRead(
     ur_queue_handle_t hQueue, ur_mem_handle_t hBuffer, bool blockingRead,
     size_t offset, size_t size, void *pDst, uint32_t numEventsInWaitList,
     const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent) {
-  std::ignore = blockingRead;
-
+  hBuffer->materialize(offset, size);
   void *FromPtr = /*Src*/ hBuffer->_mem + offset;
-  return doCopy_impl(hQueue, pDst, FromPtr, size, numEventsInWaitList,
-                     phEventWaitList, phEvent);
+  return doCopy_impl(UR_COMMAND_MEM_BUFFER_READ, hQueue, blockingRead, pDst,
+                     FromPtr, size, numEventsInWaitList, phEventWaitList,
+                     phEvent);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemBufferWrite(
     ur_queue_handle_t hQueue, ur_mem_handle_t hBuffer, bool blockingWrite,
     size_t offset, size_t size, const void *pSrc, uint32_t numEventsInWaitList,
     const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent) {
-  std::ignore = blockingWrite;
-
+  hBuffer->materialize(offset, size);
   void *ToPtr = hBuffer->_mem + offset;
-  return doCopy_impl(hQueue, ToPtr, pSrc, size, numEventsInWaitList,
-                     phEventWaitList, phEvent);
+  return doCopy_impl(UR_COMMAND_MEM_BUFFER_WRITE, hQueue, blockingWrite, ToPtr,
+                     pSrc, size, numEventsInWaitList, phEventWaitList,
+                     phEvent);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemBufferReadRect(
@@ -354,9 +536,10 @@ UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemBufferReadRect(
     uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
     ur_event_handle_t *phEvent) {
   return enqueueMemBufferReadWriteRect_impl<true /*read*/>(
-      hQueue, hBuffer, blockingRead, bufferOrigin, hostOrigin, region,
-      bufferRowPitch, bufferSlicePitch, hostRowPitch, hostSlicePitch, pDst,
-      numEventsInWaitList, phEventWaitList, phEvent);
+      UR_COMMAND_MEM_BUFFER_READ_RECT, hQueue, hBuffer, blockingRead,
+      bufferOrigin, hostOrigin, region, bufferRowPitch, bufferSlicePitch,
+      hostRowPitch, hostSlicePitch, pDst, numEventsInWaitList, phEventWaitList,
+      phEvent);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemBufferWriteRect(
@@ -367,9 +550,10 @@ UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemBufferWriteRect(
     uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
     ur_event_handle_t *phEvent) {
   return enqueueMemBufferReadWriteRect_impl<false /*write*/>(
-      hQueue, hBuffer, blockingWrite, bufferOrigin, hostOrigin, region,
-      bufferRowPitch, bufferSlicePitch, hostRowPitch, hostSlicePitch, pSrc,
-      numEventsInWaitList, phEventWaitList, phEvent);
+      UR_COMMAND_MEM_BUFFER_WRITE_RECT, hQueue, hBuffer, blockingWrite,
+      bufferOrigin, hostOrigin, region, bufferRowPitch, bufferSlicePitch,
+      hostRowPitch, hostSlicePitch, pSrc, numEventsInWaitList, phEventWaitList,
+      phEvent);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemBufferCopy(
@@ -377,10 +561,12 @@ UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemBufferCopy(
     ur_mem_handle_t hBufferDst, size_t srcOffset, size_t dstOffset, size_t size,
     uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
     ur_event_handle_t *phEvent) {
+  hBufferSrc->materialize(srcOffset, size);
+  hBufferDst->materialize(dstOffset, size);
   const void *SrcPtr = hBufferSrc->_mem + srcOffset;
   void *DstPtr = hBufferDst->_mem + dstOffset;
-  return doCopy_impl(hQueue, DstPtr, SrcPtr, size, numEventsInWaitList,
-                     phEventWaitList, phEvent);
+  return doCopy_impl(UR_COMMAND_MEM_BUFFER_COPY, hQueue, false, DstPtr, SrcPtr,
+                     size, numEventsInWaitList, phEventWaitList, phEvent);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemBufferCopyRect(
@@ -390,8 +576,17 @@ UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemBufferCopyRect(
     size_t srcSlicePitch, size_t dstRowPitch, size_t dstSlicePitch,
     uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
     ur_event_handle_t *phEvent) {
+  // The destination is passed on as host memory, so it is materialized here
+  if (dstRowPitch == 0)
+    dstRowPitch = region.width;
+  if (dstSlicePitch == 0)
+    dstSlicePitch = dstRowPitch * region.height;
+  materializeRect(hBufferDst,
+                  dstOrigin.z * dstSlicePitch + dstOrigin.y * dstRowPitch +
+                      dstOrigin.x,
+                  region, dstRowPitch, dstSlicePitch);
   return enqueueMemBufferReadWriteRect_impl<true /*read*/>(
-      hQueue, hBufferSrc, false /*todo: check blocking*/, srcOrigin,
+      UR_COMMAND_MEM_BUFFER_COPY_RECT, hQueue, hBufferSrc, false, srcOrigin,
       /*HostOffset*/ dstOrigin, region, srcRowPitch, srcSlicePitch, dstRowPitch,
       dstSlicePitch, hBufferDst->_mem, numEventsInWaitList, phEventWaitList,
       phEvent);
@@ -402,22 +597,62 @@ UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemBufferFill(
     size_t patternSize, size_t offset, size_t size,
     uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
     ur_event_handle_t *phEvent) {
-  std::ignore = numEventsInWaitList;
-  std::ignore = phEventWaitList;
-  std::ignore = phEvent;
-
   UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
 
   // TODO: error checking
-  // TODO: handle async
-  void *startingPtr = hBuffer->_mem + offset;
-  unsigned steps = size / patternSize;
-  for (unsigned i = 0; i < steps; i++) {
-    memcpy(static_cast<int8_t *>(startingPtr) + i * patternSize, pPattern,
-           patternSize);
-  }
+  hBuffer->materialize(offset, size);
+  char *Dst = hBuffer->_mem + offset;
+  auto *First = static_cast<const uint8_t *>(pPattern);
+  std::vector<uint8_t> Pattern(First, First + patternSize);
+  return native_cpu::enqueueTransfer(
+      UR_COMMAND_MEM_BUFFER_FILL, hQueue, false, numEventsInWaitList,
+      phEventWaitList, phEvent,
+      [=, Pattern = std::move(Pattern)](native_cpu::threadpool_t &tp) {
+        native_cpu::fill_bytes(tp, Dst, size, Pattern.data(), Pattern.size());
+      });
+}
 
-  return UR_RESULT_SUCCESS;
+static bool imageRegionFits(const _ur_image *Image,
+                            const ur_rect_offset_t &Origin,
+                            const ur_rect_region_t &Region) {
+  return Origin.x + Region.width <= Image->Extent[0] &&
+         Origin.y + Region.height <= Image->Extent[1] &&
+         Origin.z + Region.depth <= Image->Extent[2];
+}
+
+// Reads or writes a region of an image from or to host memory laid out with
+// the given pitches, which are computed from the region when they are zero.
+template <bool IsRead, typename T>
+static inline ur_result_t enqueueMemImageReadWrite_impl(
+    ur_command_t CommandType, ur_queue_handle_t hQueue, ur_mem_handle_t hImage,
+    bool Blocking, ur_rect_offset_t Origin, ur_rect_region_t Region,
+    size_t RowPitch, size_t SlicePitch, T *HostPtr,
+    uint32_t NumEventsInWaitList, const ur_event_handle_t *EventWaitList,
+    ur_event_handle_t *Event) {
+  UR_ASSERT(hQueue && hImage, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(HostPtr, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  UR_ASSERT(hImage->isImage(), UR_RESULT_ERROR_INVALID_MEM_OBJECT);
+  auto *Image = static_cast<_ur_image *>(hImage);
+  UR_ASSERT(imageRegionFits(Image, Origin, Region),
+            UR_RESULT_ERROR_INVALID_SIZE);
+
+  const auto HostLayout = native_cpu::image_host_layout(
+      Image->Desc.type, Image->Layout.elementSize, Region.width,
+      Region.height, Region.depth, RowPitch, SlicePitch);
+  const size_t ImageOrigin[3] = {Origin.x, Origin.y, Origin.z};
+  const size_t HostOrigin[3] = {0, 0, 0};
+  const size_t Extent[3] = {Region.width, Region.height, Region.depth};
+  return native_cpu::enqueueTransfer(
+      CommandType, hQueue, Blocking, NumEventsInWaitList, EventWaitList, Event,
+      [=](native_cpu::threadpool_t &tp) {
+        if constexpr (IsRead)
+          native_cpu::copy_image(tp, HostPtr, HostLayout, HostOrigin,
+                                 Image->_mem, Image->Layout, ImageOrigin,
+                                 Extent);
+        else
+          native_cpu::copy_image(tp, Image->_mem, Image->Layout, ImageOrigin,
+                                 HostPtr, HostLayout, HostOrigin, Extent);
+      });
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemImageRead(
@@ -425,19 +660,10 @@ UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemImageRead(
     ur_rect_offset_t origin, ur_rect_region_t region, size_t rowPitch,
     size_t slicePitch, void *pDst, uint32_t numEventsInWaitList,
     const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent) {
-  std::ignore = hQueue;
-  std::ignore = hImage;
-  std::ignore = blockingRead;
-  std::ignore = origin;
-  std::ignore = region;
-  std::ignore = rowPitch;
-  std::ignore = slicePitch;
-  std::ignore = pDst;
-  std::ignore = numEventsInWaitList;
-  std::ignore = phEventWaitList;
-  std::ignore = phEvent;
-
-  DIE_NO_IMPLEMENTATION;
+  return enqueueMemImageReadWrite_impl<true /*read*/>(
+      UR_COMMAND_MEM_IMAGE_READ, hQueue, hImage, blockingRead, origin, region,
+      rowPitch,
+      slicePitch, pDst, numEventsInWaitList, phEventWaitList, phEvent);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemImageWrite(
@@ -445,19 +671,11 @@ UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemImageWrite(
     ur_rect_offset_t origin, ur_rect_region_t region, size_t rowPitch,
     size_t slicePitch, void *pSrc, uint32_t numEventsInWaitList,
     const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent) {
-  std::ignore = hQueue;
-  std::ignore = hImage;
-  std::ignore = blockingWrite;
-  std::ignore = origin;
-  std::ignore = region;
-  std::ignore = rowPitch;
-  std::ignore = slicePitch;
-  std::ignore = pSrc;
-  std::ignore = numEventsInWaitList;
-  std::ignore = phEventWaitList;
-  std::ignore = phEvent;
-
-  DIE_NO_IMPLEMENTATION;
+  return enqueueMemImageReadWrite_impl<false /*write*/>(
+      UR_COMMAND_MEM_IMAGE_WRITE, hQueue, hImage, blockingWrite, origin, region,
+      rowPitch,
+      slicePitch, static_cast<const void *>(pSrc), numEventsInWaitList,
+      phEventWaitList, phEvent);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemImageCopy(
@@ -466,17 +684,27 @@ UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemImageCopy(
     ur_rect_offset_t dstOrigin, ur_rect_region_t region,
     uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
     ur_event_handle_t *phEvent) {
-  std::ignore = hQueue;
-  std::ignore = hImageSrc;
-  std::ignore = hImageDst;
-  std::ignore = srcOrigin;
-  std::ignore = dstOrigin;
-  std::ignore = region;
-  std::ignore = numEventsInWaitList;
-  std::ignore = phEventWaitList;
-  std::ignore = phEvent;
-
-  DIE_NO_IMPLEMENTATION;
+  UR_ASSERT(hQueue && hImageSrc && hImageDst,
+            UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(hImageSrc->isImage() && hImageDst->isImage(),
+            UR_RESULT_ERROR_INVALID_MEM_OBJECT);
+  auto *Src = static_cast<_ur_image *>(hImageSrc);
+  auto *Dst = static_cast<_ur_image *>(hImageDst);
+  UR_ASSERT(Src->Layout.elementSize == Dst->Layout.elementSize,
+            UR_RESULT_ERROR_INVALID_IMAGE_FORMAT_DESCRIPTOR);
+  UR_ASSERT(imageRegionFits(Src, srcOrigin, region) &&
+                imageRegionFits(Dst, dstOrigin, region),
+            UR_RESULT_ERROR_INVALID_SIZE);
+
+  const size_t SrcOrigin[3] = {srcOrigin.x, srcOrigin.y, srcOrigin.z};
+  const size_t DstOrigin[3] = {dstOrigin.x, dstOrigin.y, dstOrigin.z};
+  const size_t Extent[3] = {region.width, region.height, region.depth};
+  return native_cpu::enqueueTransfer(
+      UR_COMMAND_MEM_IMAGE_COPY, hQueue, false, numEventsInWaitList,
+      phEventWaitList, phEvent, [=](native_cpu::threadpool_t &tp) {
+        native_cpu::copy_image(tp, Dst->_mem, Dst->Layout, DstOrigin,
+                               Src->_mem, Src->Layout, SrcOrigin, Extent);
+      });
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemBufferMap(
@@ -484,42 +712,39 @@ UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemBufferMap(
     ur_map_flags_t mapFlags, size_t offset, size_t size,
     uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
     ur_event_handle_t *phEvent, void **ppRetMap) {
-  std::ignore = hQueue;
   std::ignore = blockingMap;
   std::ignore = mapFlags;
-  std::ignore = size;
-  std::ignore = numEventsInWaitList;
-  std::ignore = phEventWaitList;
-  std::ignore = phEvent;
 
+  UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  hBuffer->materialize(offset, size);
   *ppRetMap = hBuffer->_mem + offset;
 
-  return UR_RESULT_SUCCESS;
+  // The buffer is mapped in place, but the mapped data is only valid once the
+  // commands it depends on have completed.
+  return hQueue->enqueueBlocking(UR_COMMAND_MEM_BUFFER_MAP,
+                                 numEventsInWaitList, phEventWaitList, phEvent,
+                                 []() {});
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueMemUnmap(
     ur_queue_handle_t hQueue, ur_mem_handle_t hMem, void *pMappedPtr,
     uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
     ur_event_handle_t *phEvent) {
-  std::ignore = hQueue;
   std::ignore = hMem;
   std::ignore = pMappedPtr;
-  std::ignore = numEventsInWaitList;
-  std::ignore = phEventWaitList;
-  std::ignore = phEvent;
 
-  return UR_RESULT_SUCCESS;
+  UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  return hQueue->enqueueBlocking(UR_COMMAND_MEM_UNMAP, numEventsInWaitList,
+                                 phEventWaitList, phEvent, []() {});
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueUSMFill(
     ur_queue_handle_t hQueue, void *ptr, size_t patternSize,
     const void *pPattern, size_t size, uint32_t numEventsInWaitList,
     const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent) {
-  std::ignore = hQueue;
-  std::ignore = numEventsInWaitList;
-  std::ignore = phEventWaitList;
-  std::ignore = phEvent;
-
+  UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
   UR_ASSERT(ptr, UR_RESULT_ERROR_INVALID_NULL_POINTER);
   UR_ASSERT(pPattern, UR_RESULT_ERROR_INVALID_NULL_POINTER);
   UR_ASSERT(patternSize != 0, UR_RESULT_ERROR_INVALID_SIZE)
@@ -528,91 +753,61 @@ UR_APIEXPORT ur_result_t UR_APICALL urEnqueueUSMFill(
   UR_ASSERT(size % patternSize == 0, UR_RESULT_ERROR_INVALID_SIZE)
   // TODO: add check for allocation size once the query is supported
 
-  switch (patternSize) {
-  case 1:
-    memset(ptr, *static_cast<const uint8_t *>(pPattern), size * patternSize);
-    break;
-  case 2: {
-    const auto pattern = *static_cast<const uint16_t *>(pPattern);
-    auto *start = reinterpret_cast<uint16_t *>(ptr);
-    auto *end =
-        reinterpret_cast<uint16_t *>(reinterpret_cast<uint8_t *>(ptr) + size);
-    std::fill(start, end, pattern);
-    break;
-  }
-  case 4: {
-    const auto pattern = *static_cast<const uint32_t *>(pPattern);
-    auto *start = reinterpret_cast<uint32_t *>(ptr);
-    auto *end =
-        reinterpret_cast<uint32_t *>(reinterpret_cast<uint8_t *>(ptr) + size);
-    std::fill(start, end, pattern);
-    break;
-  }
-  case 8: {
-    const auto pattern = *static_cast<const uint64_t *>(pPattern);
-    auto *start = reinterpret_cast<uint64_t *>(ptr);
-    auto *end =
-        reinterpret_cast<uint64_t *>(reinterpret_cast<uint8_t *>(ptr) + size);
-    std::fill(start, end, pattern);
-    break;
-  }
-  default: {
-    for (unsigned int step{0}; step < size; step += patternSize) {
-      auto *dest =
-          reinterpret_cast<void *>(reinterpret_cast<uint8_t *>(ptr) + step);
-      memcpy(dest, pPattern, patternSize);
-    }
-  }
-  }
-  return UR_RESULT_SUCCESS;
+  auto *First = static_cast<const uint8_t *>(pPattern);
+  std::vector<uint8_t> Pattern(First, First + patternSize);
+  return native_cpu::enqueueTransfer(
+      UR_COMMAND_USM_FILL, hQueue, false, numEventsInWaitList, phEventWaitList,
+      phEvent,
+      [=, Pattern = std::move(Pattern)](native_cpu::threadpool_t &tp) {
+        native_cpu::fill_bytes(tp, ptr, size, Pattern.data(), Pattern.size());
+      });
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueUSMMemcpy(
     ur_queue_handle_t hQueue, bool blocking, void *pDst, const void *pSrc,
     size_t size, uint32_t numEventsInWaitList,
     const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent) {
-  std::ignore = hQueue;
-  std::ignore = blocking;
-  std::ignore = numEventsInWaitList;
-  std::ignore = phEventWaitList;
-  std::ignore = phEvent;
-
   UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_QUEUE);
   UR_ASSERT(pDst, UR_RESULT_ERROR_INVALID_NULL_POINTER);
   UR_ASSERT(pSrc, UR_RESULT_ERROR_INVALID_NULL_POINTER);
 
-  memcpy(pDst, pSrc, size);
-
-  return UR_RESULT_SUCCESS;
+  return doCopy_impl(UR_COMMAND_USM_MEMCPY, hQueue, blocking, pDst, pSrc, size,
+                     numEventsInWaitList, phEventWaitList, phEvent);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueUSMPrefetch(
     ur_queue_handle_t hQueue, const void *pMem, size_t size,
     ur_usm_migration_flags_t flags, uint32_t numEventsInWaitList,
     const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent) {
-  std::ignore = hQueue;
-  std::ignore = pMem;
-  std::ignore = size;
   std::ignore = flags;
-  std::ignore = numEventsInWaitList;
-  std::ignore = phEventWaitList;
-  std::ignore = phEvent;
 
-  // TODO: properly implement USM prefetch
-  return UR_RESULT_SUCCESS;
+  UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pMem, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  return hQueue->enqueue(UR_COMMAND_USM_PREFETCH, numEventsInWaitList,
+                         phEventWaitList, phEvent,
+                         [pMem, size](ur_event_handle_t event) {
+                           event->markStarted();
+                           native_cpu::usm_prefetch(pMem, size);
+                           event->complete();
+                           decrementOrDelete(event);
+                         });
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL
 urEnqueueUSMAdvise(ur_queue_handle_t hQueue, const void *pMem, size_t size,
                    ur_usm_advice_flags_t advice, ur_event_handle_t *phEvent) {
-  std::ignore = hQueue;
-  std::ignore = pMem;
-  std::ignore = size;
-  std::ignore = advice;
-  std::ignore = phEvent;
-
-  // TODO: properly implement USM advise
-  return UR_RESULT_SUCCESS;
+  UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pMem, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  // Advice applies to the pages rather than to their contents, so it doesn't
+  // need to wait for the commands before it.
+  native_cpu::usm_advise(pMem, size, advice);
+  return hQueue->enqueue(UR_COMMAND_USM_ADVISE, 0, nullptr, phEvent,
+                         [](ur_event_handle_t event) {
+                           event->complete();
+                           decrementOrDelete(event);
+                         });
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueUSMFill2D(
@@ -620,18 +815,22 @@ UR_APIEXPORT ur_result_t UR_APICALL urEnqueueUSMFill2D(
     const void *pPattern, size_t width, size_t height,
     uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
     ur_event_handle_t *phEvent) {
-  std::ignore = hQueue;
-  std::ignore = pMem;
-  std::ignore = pitch;
-  std::ignore = patternSize;
-  std::ignore = pPattern;
-  std::ignore = width;
-  std::ignore = height;
-  std::ignore = numEventsInWaitList;
-  std::ignore = phEventWaitList;
-  std::ignore = phEvent;
-
-  DIE_NO_IMPLEMENTATION;
+  UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pMem, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  UR_ASSERT(pPattern, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  UR_ASSERT(patternSize != 0, UR_RESULT_ERROR_INVALID_SIZE);
+  UR_ASSERT(width != 0 && height != 0, UR_RESULT_ERROR_INVALID_SIZE);
+  UR_ASSERT(pitch >= width, UR_RESULT_ERROR_INVALID_SIZE);
+
+  auto *First = static_cast<const uint8_t *>(pPattern);
+  std::vector<uint8_t> Pattern(First, First + patternSize);
+  return native_cpu::enqueueTransfer(
+      UR_COMMAND_USM_FILL_2D, hQueue, false, numEventsInWaitList,
+      phEventWaitList, phEvent,
+      [=, Pattern = std::move(Pattern)](native_cpu::threadpool_t &tp) {
+        native_cpu::fill_2d(tp, pMem, pitch, width, height, Pattern.data(),
+                            Pattern.size());
+      });
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueUSMMemcpy2D(
@@ -639,19 +838,21 @@ UR_APIEXPORT ur_result_t UR_APICALL urEnqueueUSMMemcpy2D(
     const void *pSrc, size_t srcPitch, size_t width, size_t height,
     uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
     ur_event_handle_t *phEvent) {
-  std::ignore = hQueue;
-  std::ignore = blocking;
-  std::ignore = pDst;
-  std::ignore = dstPitch;
-  std::ignore = pSrc;
-  std::ignore = srcPitch;
-  std::ignore = width;
-  std::ignore = height;
-  std::ignore = numEventsInWaitList;
-  std::ignore = phEventWaitList;
-  std::ignore = phEvent;
-
-  DIE_NO_IMPLEMENTATION;
+  UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pDst, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  UR_ASSERT(pSrc, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  UR_ASSERT(width != 0 && height != 0, UR_RESULT_ERROR_INVALID_SIZE);
+  UR_ASSERT(dstPitch >= width && srcPitch >= width,
+            UR_RESULT_ERROR_INVALID_SIZE);
+
+  native_cpu::rect_region Region{width,    height,   1, srcPitch,
+                                 srcPitch * height, dstPitch,
+                                 dstPitch * height};
+  return native_cpu::enqueueTransfer(
+      UR_COMMAND_USM_MEMCPY_2D, hQueue, blocking, numEventsInWaitList,
+      phEventWaitList, phEvent, [=](native_cpu::threadpool_t &tp) {
+        native_cpu::copy_rect(tp, pDst, pSrc, Region);
+      });
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueDeviceGlobalVariableWrite(
@@ -729,9 +930,42 @@ UR_APIEXPORT ur_result_t UR_APICALL urEnqueueWriteHostPipe(
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueNativeCommandExp(
-    ur_queue_handle_t, ur_exp_enqueue_native_command_function_t, void *,
-    uint32_t, const ur_mem_handle_t *,
-    const ur_exp_enqueue_native_command_properties_t *, uint32_t,
-    const ur_event_handle_t *, ur_event_handle_t *) {
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_queue_handle_t hQueue,
+    ur_exp_enqueue_native_command_function_t pfnNativeEnqueue, void *data,
+    uint32_t numMemsInMemList, const ur_mem_handle_t *phMemList,
+    const ur_exp_enqueue_native_command_properties_t *pProperties,
+    uint32_t numEventsInWaitList, const ur_event_handle_t *phEventWaitList,
+    ur_event_handle_t *phEvent) {
+  UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pfnNativeEnqueue, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  UR_ASSERT(phMemList || numMemsInMemList == 0,
+            UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  UR_ASSERT(!pProperties || !(pProperties->flags &
+                                UR_EXP_ENQUEUE_NATIVE_COMMAND_FLAGS_MASK),
+            UR_RESULT_ERROR_INVALID_ENUMERATION);
+
+  // The function may reach the memory through urMemGetNativeHandle
+  for (uint32_t i = 0; i < numMemsInMemList; i++) {
+    UR_ASSERT(phMemList[i], UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+    phMemList[i]->materializeAll();
+  }
+
+  // The native API of the device is the host itself, so the function does the
+  // work of the command. It runs as a task of the device's thread pool once
+  // the command is submitted, so it is ordered like any other command of the
+  // queue and host work overlaps with the commands it doesn't depend on. The
+  // function must not wait for commands enqueued on hQueue after it.
+  auto &tp = hQueue->device->tp;
+  return hQueue->enqueue(
+      UR_COMMAND_ENQUEUE_NATIVE_EXP, numEventsInWaitList, phEventWaitList,
+      phEvent, [&tp, hQueue, pfnNativeEnqueue, data](ur_event_handle_t event) {
+        tp.schedule(
+            [hQueue, pfnNativeEnqueue, data, event](size_t) {
+              event->markStarted();
+              pfnNativeEnqueue(hQueue, data);
+              event->complete();
+              decrementOrDelete(event);
+            },
+            hQueue->priority());
+      });
 }
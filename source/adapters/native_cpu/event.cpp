@@ -11,50 +11,102 @@
 #include "ur_api.h"
 
 #include "common.hpp"
+#include "event.hpp"
+#include "queue.hpp"
+
+ur_event_handle_t_::ur_event_handle_t_(ur_queue_handle_t queue,
+                                       ur_context_handle_t context,
+                                       ur_command_t command_type,
+                                       bool profiling)
+    : queue(queue), context(context), command_type(command_type),
+      profiling(profiling),
+      queuedTime(profiling ? native_cpu::get_timestamp() : 0) {
+  queue->incrementReferenceCount();
+}
+
+ur_event_handle_t_::~ur_event_handle_t_() { decrementOrDelete(queue); }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEventGetInfo(ur_event_handle_t hEvent,
                                                    ur_event_info_t propName,
                                                    size_t propSize,
                                                    void *pPropValue,
                                                    size_t *pPropSizeRet) {
-  std::ignore = hEvent;
-  std::ignore = propName;
-  std::ignore = propSize;
-  std::ignore = pPropValue;
-  std::ignore = pPropSizeRet;
-
-  DIE_NO_IMPLEMENTATION;
+  UR_ASSERT(hEvent, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  UrReturnHelper ReturnValue(propSize, pPropValue, pPropSizeRet);
+  switch (propName) {
+  case UR_EVENT_INFO_COMMAND_QUEUE:
+    return ReturnValue(hEvent->getQueue());
+  case UR_EVENT_INFO_CONTEXT:
+    return ReturnValue(hEvent->getContext());
+  case UR_EVENT_INFO_COMMAND_TYPE:
+    return ReturnValue(hEvent->getCommandType());
+  case UR_EVENT_INFO_COMMAND_EXECUTION_STATUS:
+    return ReturnValue(hEvent->getExecutionStatus());
+  case UR_EVENT_INFO_REFERENCE_COUNT:
+    return ReturnValue(uint32_t{hEvent->getReferenceCount()});
+  default:
+    return UR_RESULT_ERROR_INVALID_ENUMERATION;
+  }
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEventGetProfilingInfo(
     ur_event_handle_t hEvent, ur_profiling_info_t propName, size_t propSize,
     void *pPropValue, size_t *pPropSizeRet) {
-  std::ignore = hEvent;
-  std::ignore = propName;
-  std::ignore = propSize;
-  std::ignore = pPropValue;
-  std::ignore = pPropSizeRet;
-
-  DIE_NO_IMPLEMENTATION;
+  UR_ASSERT(hEvent, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  if (!hEvent->isProfiling())
+    return UR_RESULT_ERROR_PROFILING_INFO_NOT_AVAILABLE;
+
+  UrReturnHelper ReturnValue(propSize, pPropValue, pPropSizeRet);
+  switch (propName) {
+  case UR_PROFILING_INFO_COMMAND_QUEUED:
+    return ReturnValue(hEvent->getQueuedTime());
+  case UR_PROFILING_INFO_COMMAND_SUBMIT:
+    if (!hEvent->getSubmitTime())
+      return UR_RESULT_ERROR_PROFILING_INFO_NOT_AVAILABLE;
+    return ReturnValue(hEvent->getSubmitTime());
+  case UR_PROFILING_INFO_COMMAND_START:
+    if (!hEvent->isComplete())
+      return UR_RESULT_ERROR_PROFILING_INFO_NOT_AVAILABLE;
+    return ReturnValue(hEvent->getStartTime());
+  case UR_PROFILING_INFO_COMMAND_END:
+  case UR_PROFILING_INFO_COMMAND_COMPLETE:
+    if (!hEvent->isComplete())
+      return UR_RESULT_ERROR_PROFILING_INFO_NOT_AVAILABLE;
+    return ReturnValue(hEvent->getEndTime());
+  default:
+    return UR_RESULT_ERROR_INVALID_ENUMERATION;
+  }
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL
 urEventWait(uint32_t numEvents, const ur_event_handle_t *phEventWaitList) {
-  std::ignore = numEvents;
-  std::ignore = phEventWaitList;
-  // TODO: currently we do everything synchronously so this is a no-op
-  return UR_RESULT_SUCCESS;
+  UR_ASSERT(phEventWaitList || numEvents == 0,
+            UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  bool failed = false;
+  for (uint32_t i = 0; i < numEvents; i++) {
+    UR_ASSERT(phEventWaitList[i], UR_RESULT_ERROR_INVALID_EVENT);
+    phEventWaitList[i]->wait();
+    failed |= phEventWaitList[i]->isFailed();
+  }
+  return failed ? UR_RESULT_ERROR_IN_EVENT_LIST_EXEC_STATUS
+                : UR_RESULT_SUCCESS;
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEventRetain(ur_event_handle_t hEvent) {
-  std::ignore = hEvent;
+  UR_ASSERT(hEvent, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
 
-  DIE_NO_IMPLEMENTATION;
+  hEvent->incrementReferenceCount();
+  return UR_RESULT_SUCCESS;
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEventRelease(ur_event_handle_t hEvent) {
-  std::ignore = hEvent;
-  DIE_NO_IMPLEMENTATION;
+  UR_ASSERT(hEvent, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  decrementOrDelete(hEvent);
+  return UR_RESULT_SUCCESS;
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEventGetNativeHandle(
@@ -80,22 +132,44 @@ UR_APIEXPORT ur_result_t UR_APICALL urEventCreateWithNativeHandle(
 UR_APIEXPORT ur_result_t UR_APICALL
 urEventSetCallback(ur_event_handle_t hEvent, ur_execution_info_t execStatus,
                    ur_event_callback_t pfnNotify, void *pUserData) {
-  std::ignore = hEvent;
-  std::ignore = execStatus;
-  std::ignore = pfnNotify;
-  std::ignore = pUserData;
-
-  DIE_NO_IMPLEMENTATION;
+  UR_ASSERT(hEvent, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pfnNotify, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  // Commands go straight from submitted to complete, so callbacks for the
+  // intermediate states are reported together with completion.
+  switch (execStatus) {
+  case UR_EXECUTION_INFO_COMPLETE:
+  case UR_EXECUTION_INFO_RUNNING:
+  case UR_EXECUTION_INFO_SUBMITTED:
+  case UR_EXECUTION_INFO_QUEUED:
+    break;
+  default:
+    return UR_RESULT_ERROR_INVALID_ENUMERATION;
+  }
+
+  hEvent->incrementReferenceCount();
+  hEvent->onComplete([hEvent, execStatus, pfnNotify, pUserData]() {
+    pfnNotify(hEvent, execStatus, pUserData);
+    decrementOrDelete(hEvent);
+  });
+  return UR_RESULT_SUCCESS;
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urEnqueueTimestampRecordingExp(
     ur_queue_handle_t hQueue, bool blocking, uint32_t numEventsInWaitList,
     const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent) {
-  std::ignore = hQueue;
-  std::ignore = blocking;
-  std::ignore = numEventsInWaitList;
-  std::ignore = phEventWaitList;
-  std::ignore = phEvent;
-
-  DIE_NO_IMPLEMENTATION;
+  UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(phEvent, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  // The event is always profiled, and its start and end are both the time at
+  // which everything it depends on has completed.
+  ur_result_t result = hQueue->enqueue(UR_COMMAND_TIMESTAMP_RECORDING_EXP,
+                                       numEventsInWaitList, phEventWaitList,
+                                       phEvent, [](ur_event_handle_t event) {
+                                         event->complete();
+                                         decrementOrDelete(event);
+                                       });
+  if (result == UR_RESULT_SUCCESS && blocking)
+    (*phEvent)->wait();
+  return result;
 }
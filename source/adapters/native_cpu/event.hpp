@@ -0,0 +1,172 @@
+//===----------- event.hpp - Native CPU Adapter ---------------------------===//
+//
+// Copyright (C) 2024 Intel Corporation
+//
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM
+// Exceptions. See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+#include "common.hpp"
+#include "ur_api.h"
+
+struct ur_event_handle_t_ : RefCounted {
+
+  // Events keep their queue alive, so that it can still be queried once the
+  // application has released it.
+  ur_event_handle_t_(ur_queue_handle_t queue, ur_context_handle_t context,
+                     ur_command_t command_type, bool profiling);
+
+  ~ur_event_handle_t_();
+
+  ur_queue_handle_t getQueue() const { return queue; }
+
+  ur_context_handle_t getContext() const { return context; }
+
+  ur_command_t getCommandType() const { return command_type; }
+
+  bool isComplete() const { return done.load(std::memory_order_acquire); }
+
+  bool isFailed() const { return failed.load(std::memory_order_relaxed); }
+
+  ur_event_status_t getExecutionStatus() const {
+    if (!isComplete())
+      return UR_EVENT_STATUS_SUBMITTED;
+    return isFailed() ? UR_EVENT_STATUS_ERROR : UR_EVENT_STATUS_COMPLETE;
+  }
+
+  bool isProfiling() const { return profiling; }
+
+  // Profiling timestamps, only recorded when profiling is enabled. Each one
+  // is written by a single thread before the event completes, so recording
+  // them takes neither locks nor allocations.
+  uint64_t getQueuedTime() const { return queuedTime; }
+  uint64_t getSubmitTime() const {
+    return submitTime.load(std::memory_order_relaxed);
+  }
+  // Start and end are only meaningful once the event is complete.
+  uint64_t getStartTime() const {
+    return startTime.load(std::memory_order_relaxed);
+  }
+  uint64_t getEndTime() const { return endTime; }
+
+  // Called once every dependency of the command has completed.
+  void markSubmitted() {
+    if (profiling)
+      submitTime.store(native_cpu::get_timestamp(), std::memory_order_relaxed);
+  }
+
+  // Called when the command starts running. Commands split into several
+  // tasks call it from each of them, and the first one wins.
+  void markStarted() {
+    if (!profiling || startTime.load(std::memory_order_relaxed))
+      return;
+    uint64_t expected = 0;
+    startTime.compare_exchange_strong(expected, native_cpu::get_timestamp(),
+                                      std::memory_order_relaxed);
+  }
+
+  // Called before complete() when the command couldn't run all of its work.
+  void markFailed() { failed.store(true, std::memory_order_relaxed); }
+
+  // Blocks the calling thread until the command has completed.
+  void wait() {
+    if (isComplete())
+      return;
+    // Waiting from a continuation, the event may only complete once the
+    // continuations deferred on this thread have run.
+    while (t_deferred && !t_deferred->empty() && !isComplete()) {
+      auto fn = std::move(t_deferred->front());
+      t_deferred->pop_front();
+      fn();
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return isComplete(); });
+  }
+
+  // Runs `fn` once the command has completed. If it already has, `fn` is
+  // called immediately on the calling thread, otherwise it is called on the
+  // thread that completes the event.
+  void onComplete(std::function<void()> fn) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!isComplete()) {
+        continuations.push_back(std::move(fn));
+        return;
+      }
+    }
+    fn();
+  }
+
+  // Marks the event as complete, wakes up any waiters and runs the
+  // continuations registered with onComplete. Continuations usually complete
+  // other events, so when called from one the continuations are deferred to
+  // the outermost call on the thread rather than run recursively, which
+  // would overflow the stack on long chains of commands.
+  void complete() {
+    if (profiling) {
+      endTime = native_cpu::get_timestamp();
+      // Commands that run as soon as they are submitted don't mark their start
+      if (!startTime.load(std::memory_order_relaxed)) {
+        const uint64_t submitted = submitTime.load(std::memory_order_relaxed);
+        startTime.store(submitted ? submitted : endTime,
+                        std::memory_order_relaxed);
+      }
+    }
+    std::vector<std::function<void()>> toRun;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      done.store(true, std::memory_order_release);
+      toRun.swap(continuations);
+    }
+    cv.notify_all();
+
+    if (t_deferred) {
+      for (auto &fn : toRun)
+        t_deferred->push_back(std::move(fn));
+      return;
+    }
+    std::deque<std::function<void()>> deferred(
+        std::make_move_iterator(toRun.begin()),
+        std::make_move_iterator(toRun.end()));
+    t_deferred = &deferred;
+    while (!deferred.empty()) {
+      auto fn = std::move(deferred.front());
+      deferred.pop_front();
+      fn();
+    }
+    t_deferred = nullptr;
+  }
+
+private:
+  // Continuations waiting to run on the current thread, set while complete()
+  // is draining them
+  static inline thread_local std::deque<std::function<void()>> *t_deferred =
+      nullptr;
+
+  ur_queue_handle_t queue;
+  ur_context_handle_t context;
+  ur_command_t command_type;
+  const bool profiling;
+  const uint64_t queuedTime;
+  std::atomic<uint64_t> submitTime = 0;
+  std::atomic<uint64_t> startTime = 0;
+  // Published by the release store to `done`
+  uint64_t endTime = 0;
+  std::atomic<bool> done = false;
+  // Set before the event completes
+  std::atomic<bool> failed = false;
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<std::function<void()>> continuations;
+};
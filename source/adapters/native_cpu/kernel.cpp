@@ -22,33 +22,15 @@ urKernelCreate(ur_program_handle_t hProgram, const char *pKernelName,
   UR_ASSERT(hProgram, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
   UR_ASSERT(pKernelName, UR_RESULT_ERROR_INVALID_NULL_POINTER);
 
-  auto kernelEntry = hProgram->_kernels.find(pKernelName);
-  if (kernelEntry == hProgram->_kernels.end())
+  const native_cpu::kernel_entry *entry = hProgram->getKernel(pKernelName);
+  if (!entry)
     return UR_RESULT_ERROR_INVALID_KERNEL;
 
   auto f = reinterpret_cast<nativecpu_ptr_t>(
-      const_cast<unsigned char *>(kernelEntry->second));
-  ur_kernel_handle_t_ *kernel;
-
-  // Set reqd_work_group_size for kernel if needed
-  std::optional<native_cpu::WGSize_t> ReqdWG;
-  const auto &ReqdMap = hProgram->KernelReqdWorkGroupSizeMD;
-  if (auto ReqdIt = ReqdMap.find(pKernelName); ReqdIt != ReqdMap.end()) {
-    ReqdWG = ReqdIt->second;
-  }
-
-  std::optional<native_cpu::WGSize_t> MaxWG;
-  const auto &MaxMap = hProgram->KernelMaxWorkGroupSizeMD;
-  if (auto MaxIt = MaxMap.find(pKernelName); MaxIt != MaxMap.end()) {
-    MaxWG = MaxIt->second;
-  }
-  std::optional<uint64_t> MaxLinearWG;
-  const auto &MaxLinMap = hProgram->KernelMaxLinearWorkGroupSizeMD;
-  if (auto MaxLIt = MaxLinMap.find(pKernelName); MaxLIt != MaxLinMap.end()) {
-    MaxLinearWG = MaxLIt->second;
-  }
-  kernel = new ur_kernel_handle_t_(hProgram, pKernelName, *f, ReqdWG, MaxWG,
-                                   MaxLinearWG);
+      const_cast<unsigned char *>(entry->ptr));
+  ur_kernel_handle_t_ *kernel =
+      new ur_kernel_handle_t_(hProgram, pKernelName, *f, entry->reqdWGSize,
+                              entry->maxWGSize, entry->maxLinearWGSize);
 
   *phKernel = kernel;
 
@@ -59,18 +41,13 @@ UR_APIEXPORT ur_result_t UR_APICALL urKernelSetArgValue(
     ur_kernel_handle_t hKernel, uint32_t argIndex, size_t argSize,
     const ur_kernel_arg_value_properties_t *pProperties,
     const void *pArgValue) {
-  // Todo: error checking
-  // Todo: I think that the opencl spec (and therefore the pi spec mandates that
-  // arg is copied (this is why it is defined as const void*, I guess we should
-  // do it
-  // TODO: can args arrive out of order?
-  std::ignore = argIndex;
   std::ignore = pProperties;
 
   UR_ASSERT(hKernel, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pArgValue, UR_RESULT_ERROR_INVALID_NULL_POINTER);
   UR_ASSERT(argSize, UR_RESULT_ERROR_INVALID_KERNEL_ARGUMENT_SIZE);
 
-  hKernel->_args.emplace_back(const_cast<void *>(pArgValue));
+  hKernel->getMutableArgs().setValue(argIndex, pArgValue, argSize);
 
   return UR_RESULT_SUCCESS;
 }
@@ -79,10 +56,13 @@ UR_APIEXPORT ur_result_t UR_APICALL urKernelSetArgLocal(
     ur_kernel_handle_t hKernel, uint32_t argIndex, size_t argSize,
     const ur_kernel_arg_local_properties_t *pProperties) {
   std::ignore = pProperties;
-  // emplace a placeholder kernel arg, gets replaced with a pointer to the
-  // memory pool before enqueueing the kernel.
-  hKernel->_args.emplace_back(nullptr);
-  hKernel->_localArgInfo.emplace_back(argIndex, argSize);
+
+  UR_ASSERT(hKernel, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(argSize, UR_RESULT_ERROR_INVALID_KERNEL_ARGUMENT_SIZE);
+
+  // The argument is a placeholder that gets replaced with a pointer to the
+  // launch's local memory before the kernel runs.
+  hKernel->getMutableArgs().setLocal(argIndex, argSize);
   return UR_RESULT_SUCCESS;
 }
 
@@ -136,13 +116,10 @@ urKernelGetGroupInfo(ur_kernel_handle_t hKernel, ur_device_handle_t hDevice,
   }
   case UR_KERNEL_GROUP_INFO_COMPILE_WORK_GROUP_SIZE: {
     size_t GroupSize[3] = {0, 0, 0};
-    const auto &ReqdWGSizeMDMap = hKernel->hProgram->KernelReqdWorkGroupSizeMD;
-    const auto ReqdWGSizeMD = ReqdWGSizeMDMap.find(hKernel->_name);
-    if (ReqdWGSizeMD != ReqdWGSizeMDMap.end()) {
-      const auto ReqdWGSize = ReqdWGSizeMD->second;
-      GroupSize[0] = std::get<0>(ReqdWGSize);
-      GroupSize[1] = std::get<1>(ReqdWGSize);
-      GroupSize[2] = std::get<2>(ReqdWGSize);
+    if (const auto ReqdWGSize = hKernel->getReqdWGSize()) {
+      GroupSize[0] = std::get<0>(*ReqdWGSize);
+      GroupSize[1] = std::get<1>(*ReqdWGSize);
+      GroupSize[2] = std::get<2>(*ReqdWGSize);
     }
     return returnValue(GroupSize, 3);
   }
@@ -221,14 +198,13 @@ UR_APIEXPORT ur_result_t UR_APICALL
 urKernelSetArgPointer(ur_kernel_handle_t hKernel, uint32_t argIndex,
                       const ur_kernel_arg_pointer_properties_t *pProperties,
                       const void *pArgValue) {
-  // TODO: out_of_order args?
-  std::ignore = argIndex;
   std::ignore = pProperties;
 
   UR_ASSERT(hKernel, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
   UR_ASSERT(pArgValue, UR_RESULT_ERROR_INVALID_NULL_POINTER);
 
-  hKernel->_args.push_back(const_cast<void *>(pArgValue));
+  hKernel->getMutableArgs().setPointer(argIndex,
+                                       const_cast<void *>(pArgValue));
 
   return UR_RESULT_SUCCESS;
 }
@@ -262,8 +238,6 @@ UR_APIEXPORT ur_result_t UR_APICALL
 urKernelSetArgMemObj(ur_kernel_handle_t hKernel, uint32_t argIndex,
                      const ur_kernel_arg_mem_obj_properties_t *pProperties,
                      ur_mem_handle_t hArgValue) {
-  // TODO: out_of_order args?
-  std::ignore = argIndex;
   std::ignore = pProperties;
 
   UR_ASSERT(hKernel, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
@@ -271,11 +245,13 @@ urKernelSetArgMemObj(ur_kernel_handle_t hKernel, uint32_t argIndex,
   // Taken from ur/adapters/cuda/kernel.cpp
   // zero-sized buffers are expected to be null.
   if (hArgValue == nullptr) {
-    hKernel->_args.emplace_back(nullptr);
+    hKernel->getMutableArgs().setPointer(argIndex, nullptr);
     return UR_RESULT_SUCCESS;
   }
 
-  hKernel->_args.emplace_back(hArgValue->_mem);
+  // The kernel may touch any part of the buffer
+  hArgValue->materializeAll();
+  hKernel->getMutableArgs().setPointer(argIndex, hArgValue->_mem);
   return UR_RESULT_SUCCESS;
 }
 
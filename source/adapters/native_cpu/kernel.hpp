@@ -9,9 +9,13 @@
 #pragma once
 
 #include "common.hpp"
+#include "local_memory.hpp"
 #include "nativecpu_state.hpp"
 #include "program.hpp"
+#include <algorithm>
 #include <array>
+#include <cstring>
+#include <memory>
 #include <ur_api.h>
 #include <utility>
 
@@ -37,26 +41,186 @@ struct local_arg_info_t {
       : argIndex(argIndex), argSize(argSize) {}
 };
 
+namespace native_cpu {
+
+// The arguments of a kernel, indexed by argIndex. Argument values are copied
+// into storage owned by the arena, which starts out as a small inline buffer
+// so that kernels with a few small arguments don't allocate at all.
+//
+// Arenas are reference counted: the kernel holds one reference and every
+// launch that hasn't completed yet holds another, so that launches don't
+// need to copy the arguments. The kernel copies the arena before changing an
+// argument that an in-flight launch may still read.
+struct arg_arena : RefCounted {
+  arg_arena() = default;
+
+  arg_arena(const arg_arena &other)
+      : RefCounted(), _args(other._args), _values(other._values),
+        _localArgInfo(other._localArgInfo), _heap(other._heap),
+        _capacity(other._capacity), _used(other._used) {
+    std::copy(std::begin(other._inline), std::end(other._inline),
+              std::begin(_inline));
+    rebase();
+  }
+
+  arg_arena &operator=(const arg_arena &) = delete;
+
+  void setValue(uint32_t argIndex, const void *pArgValue, size_t argSize) {
+    resize(argIndex);
+    clearLocal(argIndex);
+    if (_values[argIndex].size != argSize) {
+      _values[argIndex].size = 0;
+      _values[argIndex] = {allocate(argSize), argSize};
+    }
+    void *value = data() + _values[argIndex].offset;
+    std::memcpy(value, pArgValue, argSize);
+    _args[argIndex].MPtr = value;
+  }
+
+  void setPointer(uint32_t argIndex, void *ptr) {
+    resize(argIndex);
+    clearLocal(argIndex);
+    _values[argIndex].size = 0;
+    _args[argIndex].MPtr = ptr;
+  }
+
+  // Local arguments are replaced by pointers to the launch's local memory
+  // when the kernel runs.
+  void setLocal(uint32_t argIndex, size_t argSize) {
+    resize(argIndex);
+    _values[argIndex].size = 0;
+    _args[argIndex].MPtr = nullptr;
+    for (auto &entry : _localArgInfo) {
+      if (entry.argIndex == argIndex) {
+        entry.argSize = argSize;
+        return;
+      }
+    }
+    _localArgInfo.emplace_back(argIndex, argSize);
+  }
+
+  const std::vector<NativeCPUArgDesc> &getArgs() const { return _args; }
+
+  const std::vector<local_arg_info_t> &getLocalArgInfo() const {
+    return _localArgInfo;
+  }
+
+private:
+  // Storage is allocated in cache line sized chunks.
+  struct alignas(64) chunk_t {
+    char bytes[64];
+  };
+
+  struct value_t {
+    size_t offset = 0;
+    // Zero if the argument isn't a value stored in the arena
+    size_t size = 0;
+  };
+
+  // Values are aligned to the smallest power of two that holds them, up to
+  // the size of a chunk.
+  static size_t getAlignment(size_t size) {
+    size_t align = 1;
+    while (align < size && align < sizeof(chunk_t))
+      align *= 2;
+    return align;
+  }
+
+  char *data() {
+    return _heap.empty() ? _inline[0].bytes : _heap.front().bytes;
+  }
+
+  void resize(uint32_t argIndex) {
+    if (argIndex >= _args.size()) {
+      _args.resize(argIndex + 1, NativeCPUArgDesc(nullptr));
+      _values.resize(argIndex + 1);
+    }
+  }
+
+  void clearLocal(uint32_t argIndex) {
+    _localArgInfo.erase(std::remove_if(_localArgInfo.begin(),
+                                       _localArgInfo.end(),
+                                       [argIndex](const local_arg_info_t &e) {
+                                         return e.argIndex == argIndex;
+                                       }),
+                        _localArgInfo.end());
+  }
+
+  // Returns the offset of `size` free bytes. Arguments whose size changes get
+  // a new slot, the old ones are only reclaimed when the arena grows.
+  size_t allocate(size_t size) {
+    size_t align = getAlignment(size);
+    size_t offset = (_used + align - 1) / align * align;
+    if (offset + size > _capacity) {
+      grow(size);
+      offset = (_used + align - 1) / align * align;
+    }
+    _used = offset + size;
+    return offset;
+  }
+
+  // Moves the live values to a larger buffer, packing them on the way, with
+  // at least `extra` bytes left at the end.
+  void grow(size_t extra) {
+    size_t needed = sizeof(chunk_t) + extra;
+    for (auto &value : _values)
+      needed += value.size + getAlignment(value.size);
+    size_t numChunks = std::max(2 * _capacity, needed) / sizeof(chunk_t) + 1;
+    std::vector<chunk_t> heap(numChunks);
+    char *newData = heap.front().bytes;
+    size_t used = 0;
+    for (auto &value : _values) {
+      if (value.size == 0)
+        continue;
+      size_t align = getAlignment(value.size);
+      size_t offset = (used + align - 1) / align * align;
+      std::memcpy(newData + offset, data() + value.offset, value.size);
+      value.offset = offset;
+      used = offset + value.size;
+    }
+    _heap = std::move(heap);
+    _capacity = _heap.size() * sizeof(chunk_t);
+    _used = used;
+    rebase();
+  }
+
+  // Points the descriptors of value arguments back into this arena's storage.
+  void rebase() {
+    for (size_t i = 0; i < _values.size(); i++) {
+      if (_values[i].size)
+        _args[i].MPtr = data() + _values[i].offset;
+    }
+  }
+
+  std::vector<NativeCPUArgDesc> _args;
+  std::vector<value_t> _values;
+  std::vector<local_arg_info_t> _localArgInfo;
+  chunk_t _inline[2];
+  std::vector<chunk_t> _heap;
+  size_t _capacity = sizeof(_inline);
+  size_t _used = 0;
+};
+
+} // namespace native_cpu
+
 struct ur_kernel_handle_t_ : RefCounted {
 
   ur_kernel_handle_t_(ur_program_handle_t hProgram, const char *name,
                       nativecpu_task_t subhandler)
-      : hProgram(hProgram), _name{name}, _subhandler{std::move(subhandler)} {}
-
-  ur_kernel_handle_t_(const ur_kernel_handle_t_ &other)
-      : hProgram(other.hProgram), _name(other._name),
-        _subhandler(other._subhandler), _args(other._args),
-        _localArgInfo(other._localArgInfo), _localMemPool(other._localMemPool),
-        _localMemPoolSize(other._localMemPoolSize),
-        ReqdWGSize(other.ReqdWGSize) {
-    incrementReferenceCount();
+      : hProgram(hProgram), _name{name}, _subhandler{std::move(subhandler)} {
+    hProgram->incrementReferenceCount();
   }
 
+  ur_kernel_handle_t_(const ur_kernel_handle_t_ &) = delete;
+  ur_kernel_handle_t_ &operator=(const ur_kernel_handle_t_ &) = delete;
+
+  // Kernels keep their program alive, since their code may live in the
+  // program's library.
   ~ur_kernel_handle_t_() {
-    if (decrementReferenceCount() == 0) {
-      free(_localMemPool);
-    }
+    decrementOrDelete(_arena);
+    decrementOrDelete(hProgram);
   }
+
   ur_kernel_handle_t_(ur_program_handle_t hProgram, const char *name,
                       nativecpu_task_t subhandler,
                       std::optional<native_cpu::WGSize_t> ReqdWGSize,
@@ -64,13 +228,13 @@ struct ur_kernel_handle_t_ : RefCounted {
                       std::optional<uint64_t> MaxLinearWGSize)
       : hProgram(hProgram), _name{name}, _subhandler{std::move(subhandler)},
         ReqdWGSize(ReqdWGSize), MaxWGSize(MaxWGSize),
-        MaxLinearWGSize(MaxLinearWGSize) {}
+        MaxLinearWGSize(MaxLinearWGSize) {
+    hProgram->incrementReferenceCount();
+  }
 
   ur_program_handle_t hProgram;
   std::string _name;
   nativecpu_task_t _subhandler;
-  std::vector<native_cpu::NativeCPUArgDesc> _args;
-  std::vector<local_arg_info_t> _localArgInfo;
 
   std::optional<native_cpu::WGSize_t> getReqdWGSize() const {
     return ReqdWGSize;
@@ -80,36 +244,99 @@ struct ur_kernel_handle_t_ : RefCounted {
 
   std::optional<uint64_t> getMaxLinearWGSize() const { return MaxLinearWGSize; }
 
-  void updateMemPool(size_t numParallelThreads) {
-    // compute requested size.
-    size_t reqSize = 0;
-    for (auto &entry : _localArgInfo) {
-      reqSize += entry.argSize * numParallelThreads;
-    }
-    if (reqSize == 0 || reqSize == _localMemPoolSize) {
-      return;
-    }
-    // realloc handles nullptr case
-    _localMemPool = (char *)realloc(_localMemPool, reqSize);
-    _localMemPoolSize = reqSize;
-  }
+  // Arguments persist across launches until they are set again.
+  native_cpu::arg_arena *getArgArena() const { return _arena; }
 
-  // To be called before executing a work group
-  void handleLocalArgs(size_t numParallelThread, size_t threadId) {
-    // For each local argument we have size*numthreads
-    size_t offset = 0;
-    for (auto &entry : _localArgInfo) {
-      _args[entry.argIndex].MPtr =
-          _localMemPool + offset + (entry.argSize * threadId);
-      // update offset in the memory pool
-      offset += entry.argSize * numParallelThread;
+  // Returns the arena to change arguments in, copying it first if a launch
+  // still holds a reference to it.
+  native_cpu::arg_arena &getMutableArgs() {
+    if (_arena->getReferenceCount() > 1) {
+      auto *copy = new native_cpu::arg_arena(*_arena);
+      decrementOrDelete(_arena);
+      _arena = copy;
     }
+    return *_arena;
   }
 
 private:
-  char *_localMemPool = nullptr;
-  size_t _localMemPoolSize = 0;
+  native_cpu::arg_arena *_arena = new native_cpu::arg_arena();
   std::optional<native_cpu::WGSize_t> ReqdWGSize = std::nullopt;
   std::optional<native_cpu::WGSize_t> MaxWGSize = std::nullopt;
   std::optional<uint64_t> MaxLinearWGSize = std::nullopt;
 };
+
+namespace native_cpu {
+
+// What a launch needs from its kernel, taken when the launch is enqueued. It
+// holds references to the kernel and to the arguments the kernel had at that
+// point, so the kernel can be released, or its arguments set again and the
+// kernel relaunched, before the launch has completed. Local arguments live in
+// the local memory arena of the thread running the work-group.
+//
+// Command-buffer launches pass the arena of the command instead, which keeps
+// the arguments the command was recorded or last updated with.
+class kernel_launch {
+public:
+  kernel_launch(ur_kernel_handle_t kernel, arg_arena *arena)
+      : _kernel(kernel), _arena(arena),
+        _localMemSize(getLocalMemSize(*arena)) {
+    _kernel->incrementReferenceCount();
+    _arena->incrementReferenceCount();
+  }
+
+  kernel_launch(const kernel_launch &) = delete;
+  kernel_launch &operator=(const kernel_launch &) = delete;
+
+  ~kernel_launch() {
+    decrementOrDelete(_arena);
+    decrementOrDelete(_kernel);
+  }
+
+  const std::string &getName() const { return _kernel->_name; }
+
+  bool hasLocalArgs() const { return !_arena->getLocalArgInfo().empty(); }
+
+  // Local memory a work-group needs for the local arguments in `arena`
+  static size_t getLocalMemSize(const arg_arena &arena) {
+    size_t size = 0;
+    for (auto &entry : arena.getLocalArgInfo())
+      size += roundUpLocal(entry.argSize);
+    return size;
+  }
+
+  // Returns the arguments to run the kernel with on the calling thread. Local
+  // arguments point into the thread's local memory arena, so when there are
+  // any the arguments are patched in `threadArgs`, which the thread owns.
+  // They stay valid until the thread runs another launch. Returns nullptr if
+  // the thread's local memory can't be allocated.
+  const NativeCPUArgDesc *
+  getArgs(std::vector<NativeCPUArgDesc> &threadArgs) const {
+    if (!hasLocalArgs())
+      return _arena->getArgs().data();
+    char *localMem = thread_local_memory(_localMemSize);
+    if (!localMem)
+      return nullptr;
+    threadArgs = _arena->getArgs();
+    for (auto &entry : _arena->getLocalArgInfo()) {
+      threadArgs[entry.argIndex].MPtr = localMem;
+      localMem += roundUpLocal(entry.argSize);
+    }
+    return threadArgs.data();
+  }
+
+  void run(const NativeCPUArgDesc *args, state *s) const {
+    _kernel->_subhandler(args, s);
+  }
+
+private:
+  static size_t roundUpLocal(size_t size) {
+    return (size + local_arg_alignment - 1) / local_arg_alignment *
+           local_arg_alignment;
+  }
+
+  ur_kernel_handle_t _kernel;
+  arg_arena *_arena;
+  const size_t _localMemSize;
+};
+
+} // namespace native_cpu
@@ -0,0 +1,113 @@
+//===----------- latch.hpp - Native CPU Adapter ---------------------------===//
+//
+// Copyright (C) 2024 Intel Corporation
+//
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM
+// Exceptions. See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <tuple>
+
+#ifdef __linux__
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace native_cpu {
+
+// A single use countdown latch. Waiters spin for a short while, which is
+// enough for short launches, and then sleep on a futex until the count
+// reaches zero. Counting down doesn't touch the latch once the count is
+// zero, so the waiter may destroy it as soon as wait() returns.
+class latch {
+public:
+  explicit latch(uint32_t count) : m_count(count) {}
+
+  latch(const latch &) = delete;
+  latch &operator=(const latch &) = delete;
+
+  // Returns true for the call that brought the count to zero.
+  bool count_down() {
+    uint32_t *addr = reinterpret_cast<uint32_t *>(&m_count);
+    const uint32_t previous = m_count.fetch_sub(1, std::memory_order_acq_rel);
+    if ((previous & count_mask) != 1)
+      return false;
+    if (previous & waiter_bit)
+      wake(addr);
+    return true;
+  }
+
+  bool try_wait() const {
+    return (m_count.load(std::memory_order_acquire) & count_mask) == 0;
+  }
+
+  void wait() {
+    for (unsigned i = 0, n = spin_limit(); i < n; i++) {
+      if (try_wait())
+        return;
+      pause();
+    }
+    uint32_t value = m_count.fetch_or(waiter_bit, std::memory_order_acq_rel);
+    while (value & count_mask) {
+      sleep(value | waiter_bit);
+      value = m_count.load(std::memory_order_acquire);
+    }
+  }
+
+private:
+  static constexpr uint32_t waiter_bit = 1u << 31;
+  static constexpr uint32_t count_mask = waiter_bit - 1;
+
+  // Spinning only pays off when the threads that count down run on other
+  // cores, on a single core it delays them instead.
+  static unsigned spin_limit() {
+    static const unsigned limit =
+        std::thread::hardware_concurrency() > 1 ? 1024 : 0;
+    return limit;
+  }
+
+  static void pause() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#else
+    std::this_thread::yield();
+#endif
+  }
+
+  // Blocks while the count still holds `expected`.
+  void sleep(uint32_t expected) {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_count),
+            FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+    std::ignore = expected;
+    std::this_thread::yield();
+#endif
+  }
+
+  // Only uses the address, which may no longer hold a latch by now. A
+  // spurious wake-up is harmless for whoever waits there instead.
+  static void wake(uint32_t *addr) {
+#ifdef __linux__
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+    std::ignore = addr;
+#endif
+  }
+
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                "futexes need a plain 32-bit word");
+  std::atomic<uint32_t> m_count;
+};
+
+} // namespace native_cpu
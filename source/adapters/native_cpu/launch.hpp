@@ -0,0 +1,53 @@
+//===----------- launch.hpp - Native CPU Adapter --------------------------===//
+//
+// Copyright (C) 2024 Intel Corporation
+//
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM
+// Exceptions. See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "kernel.hpp"
+#include "threadpool.hpp"
+
+namespace native_cpu {
+
+// A kernel launch whose work has been partitioned between the threads of the
+// pool up front. A plan is run by scheduling num_tasks() tasks that each call
+// run() once. Command-buffers keep the plans of their kernel launches and run
+// them again on every submission.
+class launch_plan {
+public:
+  virtual ~launch_plan() = default;
+
+  virtual size_t num_tasks() const = 0;
+
+  // Rearms the plan for another run, must not be called while it runs.
+  virtual void reset() = 0;
+
+  virtual void run(size_t threadId) = 0;
+
+  // Whether the last run lost work because none of its tasks could allocate
+  // local memory. Tasks that can run the kernel keep claiming work until
+  // there is none left, so work is only lost when all of them fail. Only
+  // meaningful once every task of the run has returned.
+  virtual bool failed() const = 0;
+};
+
+// Checks the launch against the kernel's work-group size constraints and the
+// device's local memory size, and builds its plan, which runs the kernel with
+// the arguments in `args`.
+ur_result_t make_launch_plan(ur_kernel_handle_t hKernel, arg_arena *args,
+                             uint32_t workDim, const size_t *pGlobalWorkOffset,
+                             const size_t *pGlobalWorkSize,
+                             const size_t *pLocalWorkSize,
+                             const threadpool_t &tp,
+                             std::unique_ptr<launch_plan> &plan);
+
+} // namespace native_cpu
@@ -0,0 +1,71 @@
+//===----------- local_memory.cpp - Native CPU Adapter --------------------===//
+//
+// Copyright (C) 2024 Intel Corporation
+//
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM
+// Exceptions. See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "local_memory.hpp"
+
+#include <new>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace native_cpu {
+
+namespace {
+
+size_t page_size() {
+#ifdef __linux__
+  static const size_t size = sysconf(_SC_PAGESIZE);
+  return size;
+#else
+  return 4096;
+#endif
+}
+
+struct local_arena {
+  char *base = nullptr;
+  size_t capacity = 0;
+
+  local_arena() = default;
+  local_arena(const local_arena &) = delete;
+  local_arena &operator=(const local_arena &) = delete;
+
+  ~local_arena() { release(); }
+
+  void release() {
+    if (base)
+      ::operator delete(base, std::align_val_t(page_size()));
+    base = nullptr;
+    capacity = 0;
+  }
+
+  // Returns false, leaving the arena empty, if the memory can't be allocated.
+  bool reserve(size_t size) {
+    release();
+    const size_t rounded = (size + page_size() - 1) / page_size() * page_size();
+    base = static_cast<char *>(::operator new(
+        rounded, std::align_val_t(page_size()), std::nothrow));
+    if (!base)
+      return false;
+    capacity = rounded;
+    return true;
+  }
+};
+
+} // namespace
+
+char *thread_local_memory(size_t size) {
+  thread_local local_arena arena;
+  if (arena.capacity < size && !arena.reserve(size))
+    return nullptr;
+  return arena.base;
+}
+
+} // namespace native_cpu
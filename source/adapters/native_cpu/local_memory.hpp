@@ -0,0 +1,30 @@
+//===----------- local_memory.hpp - Native CPU Adapter --------------------===//
+//
+// Copyright (C) 2024 Intel Corporation
+//
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM
+// Exceptions. See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstddef>
+
+namespace native_cpu {
+
+// Local memory reported by the device. The local arguments of a launch must
+// fit in it.
+constexpr size_t local_mem_size = 32768;
+
+// Every local argument of a work-group starts on a cache line of its own.
+constexpr size_t local_arg_alignment = 64;
+
+// Returns at least `size` bytes of local memory owned by the calling thread.
+// The memory starts on a page boundary and stays valid until the thread asks
+// for more or exits. A thread runs one work-group at a time, so the local
+// memory of different threads, and of concurrent launches, never shares a
+// cache line. Returns nullptr if the memory can't be allocated.
+char *thread_local_memory(size_t size);
+
+} // namespace native_cpu
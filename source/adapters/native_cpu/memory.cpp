@@ -10,20 +10,329 @@
 
 #include "memory.hpp"
 #include "common.hpp"
+#include "transfer.hpp"
 #include "ur_api.h"
+#include "ur_util.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <new>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#endif
+
+namespace native_cpu {
+
+bool lazy_copy_host_pointer() {
+  static const bool lazy = [] {
+    auto value = ur_getenv("UR_NATIVE_CPU_LAZY_COPY_HOST_POINTER");
+    return value && *value == "1";
+  }();
+  return lazy;
+}
+
+size_t image_element_size(const ur_image_format_t &format) {
+  size_t numChannels = 0;
+  switch (format.channelOrder) {
+  case UR_IMAGE_CHANNEL_ORDER_A:
+  case UR_IMAGE_CHANNEL_ORDER_R:
+  case UR_IMAGE_CHANNEL_ORDER_INTENSITY:
+  case UR_IMAGE_CHANNEL_ORDER_LUMINANCE:
+    numChannels = 1;
+    break;
+  case UR_IMAGE_CHANNEL_ORDER_RG:
+  case UR_IMAGE_CHANNEL_ORDER_RA:
+  case UR_IMAGE_CHANNEL_ORDER_RX:
+    numChannels = 2;
+    break;
+  case UR_IMAGE_CHANNEL_ORDER_RGB:
+  case UR_IMAGE_CHANNEL_ORDER_RGX:
+    numChannels = 3;
+    break;
+  case UR_IMAGE_CHANNEL_ORDER_RGBA:
+  case UR_IMAGE_CHANNEL_ORDER_BGRA:
+  case UR_IMAGE_CHANNEL_ORDER_ARGB:
+  case UR_IMAGE_CHANNEL_ORDER_ABGR:
+  case UR_IMAGE_CHANNEL_ORDER_RGBX:
+  case UR_IMAGE_CHANNEL_ORDER_SRGBA:
+    numChannels = 4;
+    break;
+  default:
+    return 0;
+  }
+
+  const bool isRGB = numChannels == 3 ||
+                     format.channelOrder == UR_IMAGE_CHANNEL_ORDER_RGBX;
+  switch (format.channelType) {
+  case UR_IMAGE_CHANNEL_TYPE_SNORM_INT8:
+  case UR_IMAGE_CHANNEL_TYPE_UNORM_INT8:
+  case UR_IMAGE_CHANNEL_TYPE_SIGNED_INT8:
+  case UR_IMAGE_CHANNEL_TYPE_UNSIGNED_INT8:
+    return numChannels;
+  case UR_IMAGE_CHANNEL_TYPE_SNORM_INT16:
+  case UR_IMAGE_CHANNEL_TYPE_UNORM_INT16:
+  case UR_IMAGE_CHANNEL_TYPE_SIGNED_INT16:
+  case UR_IMAGE_CHANNEL_TYPE_UNSIGNED_INT16:
+  case UR_IMAGE_CHANNEL_TYPE_HALF_FLOAT:
+    return numChannels * 2;
+  case UR_IMAGE_CHANNEL_TYPE_SIGNED_INT32:
+  case UR_IMAGE_CHANNEL_TYPE_UNSIGNED_INT32:
+  case UR_IMAGE_CHANNEL_TYPE_FLOAT:
+    return numChannels * 4;
+  // Packed formats hold the whole element, and only come in RGB orders
+  case UR_IMAGE_CHANNEL_TYPE_UNORM_SHORT_565:
+  case UR_IMAGE_CHANNEL_TYPE_UNORM_SHORT_555:
+    return isRGB ? 2 : 0;
+  case UR_IMAGE_CHANNEL_TYPE_INT_101010:
+    return isRGB ? 4 : 0;
+  default:
+    return 0;
+  }
+}
+
+image_layout image_host_layout(ur_mem_type_t type, size_t elementSize,
+                               size_t width, size_t height, size_t depth,
+                               size_t rowPitch, size_t slicePitch) {
+  if (rowPitch == 0)
+    rowPitch = width * elementSize;
+  if (type == UR_MEM_TYPE_IMAGE1D_ARRAY)
+    return image_layout::linear(elementSize, width, height, 1,
+                                slicePitch ? slicePitch : rowPitch, 0);
+  if (slicePitch == 0)
+    slicePitch = rowPitch * height;
+  return image_layout::linear(elementSize, width, height, depth, rowPitch,
+                              slicePitch);
+}
+
+lazy_host_copy::lazy_host_copy(threadpool_t &tp, char *dst, const char *src,
+                               size_t size)
+    : tp(tp), dst(dst), src(src), size(size),
+      numChunks((size + transfer_chunk_size - 1) / transfer_chunk_size),
+      chunks(new std::atomic<uint8_t>[numChunks]), remaining(numChunks) {
+  for (size_t i = 0; i < numChunks; i++)
+    chunks[i].store(pending, std::memory_order_relaxed);
+}
+
+void lazy_host_copy::materialize(size_t offset, size_t len) {
+  if (remaining.load(std::memory_order_acquire) == 0 || len == 0 ||
+      offset >= size)
+    return;
+  len = std::min(len, size - offset);
+  const size_t first = offset / transfer_chunk_size;
+  const size_t last = (offset + len - 1) / transfer_chunk_size + 1;
+
+  auto copyRun = [&](size_t begin, size_t end) {
+    const size_t from = begin * transfer_chunk_size;
+    const size_t to = std::min(size, end * transfer_chunk_size);
+    copy_bytes(tp, dst + from, src + from, to - from);
+    for (size_t i = begin; i < end; i++)
+      chunks[i].store(done, std::memory_order_release);
+    remaining.fetch_sub(end - begin, std::memory_order_release);
+  };
+
+  // Copy each run of chunks this thread manages to claim in one go, so that
+  // large runs are split across the thread pool.
+  size_t runBegin = last;
+  for (size_t i = first; i < last; i++) {
+    uint8_t expected = pending;
+    if (chunks[i].compare_exchange_strong(expected, copying,
+                                          std::memory_order_acquire)) {
+      if (runBegin == last)
+        runBegin = i;
+    } else if (runBegin != last) {
+      copyRun(runBegin, i);
+      runBegin = last;
+    }
+  }
+  if (runBegin != last)
+    copyRun(runBegin, last);
+
+  for (size_t i = first; i < last; i++)
+    while (chunks[i].load(std::memory_order_acquire) != done)
+      std::this_thread::yield();
+}
+
+} // namespace native_cpu
+
+namespace {
+
+#ifdef __linux__
+// If [Src, Src + Size) lies in a read-only private mapping of a file, maps the
+// same part of the file copy-on-write, so that pages are only read in when
+// they are first touched. Returns nullptr if the data isn't file-backed.
+char *mapFileCopy(const void *Src, size_t Size, void **Mapping,
+                  size_t *MappingSize) {
+  const auto Begin = reinterpret_cast<uintptr_t>(Src);
+  std::ifstream Maps("/proc/self/maps");
+  std::string Line;
+  while (std::getline(Maps, Line)) {
+    unsigned long Start, End, Offset, Inode;
+    unsigned Major, Minor;
+    char Perms[5];
+    int PathPos = 0;
+    if (sscanf(Line.c_str(), "%lx-%lx %4s %lx %x:%x %lu %n", &Start, &End,
+               Perms, &Offset, &Major, &Minor, &Inode, &PathPos) < 7)
+      continue;
+    if (Begin < Start || Begin >= End)
+      continue;
+    // A writable mapping may hold changes that aren't in the file, and a
+    // shared one sees later changes to it.
+    if (Begin + Size > End || Perms[1] == 'w' || Perms[3] != 'p' ||
+        Inode == 0 || PathPos == 0 || Line[PathPos] != '/')
+      return nullptr;
+
+    int Fd = open(Line.c_str() + PathPos, O_RDONLY | O_CLOEXEC);
+    if (Fd < 0)
+      return nullptr;
+    // The path may have been replaced since the file was mapped
+    struct stat Stat;
+    if (fstat(Fd, &Stat) != 0 || Stat.st_ino != Inode ||
+        major(Stat.st_dev) != Major || minor(Stat.st_dev) != Minor) {
+      close(Fd);
+      return nullptr;
+    }
+    const size_t PageSize = sysconf(_SC_PAGESIZE);
+    const size_t Delta = Begin % PageSize;
+    *MappingSize = Size + Delta;
+    *Mapping = mmap(nullptr, *MappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                    Fd, Offset + (Begin - Start) - Delta);
+    close(Fd);
+    if (*Mapping == MAP_FAILED) {
+      *Mapping = nullptr;
+      return nullptr;
+    }
+    return static_cast<char *>(*Mapping) + Delta;
+  }
+  return nullptr;
+}
+#endif
+
+} // namespace
+
+ur_mem_handle_t_::ur_mem_handle_t_(native_cpu::threadpool_t &tp, void *HostPtr,
+                                   size_t Size, bool _IsImage)
+    : _mem{nullptr}, _ownsMem{true}, IsImage{_IsImage} {
+  const bool Lazy = native_cpu::lazy_copy_host_pointer() &&
+                    Size >= native_cpu::mapped_buffer_threshold;
+#ifdef __linux__
+  if (Lazy) {
+    _mem = mapFileCopy(HostPtr, Size, &_mapping, &_mappingSize);
+    if (_mem)
+      return;
+  }
+  if (Size >= native_cpu::mapped_buffer_threshold) {
+    void *Mapping = mmap(nullptr, Size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (Mapping != MAP_FAILED) {
+      _mapping = Mapping;
+      _mappingSize = Size;
+      _mem = static_cast<char *>(Mapping);
+    }
+  }
+#endif
+  if (!_mem) {
+    _mem = static_cast<char *>(malloc(Size));
+    if (!_mem)
+      throw std::bad_alloc();
+  }
+  if (Lazy) {
+    _lazyCopy = std::make_unique<native_cpu::lazy_host_copy>(
+        tp, _mem, static_cast<const char *>(HostPtr), Size);
+  } else {
+    native_cpu::copy_bytes(tp, _mem, HostPtr, Size);
+  }
+}
+
+ur_mem_handle_t_::~ur_mem_handle_t_() {
+#ifdef __linux__
+  if (_mapping) {
+    munmap(_mapping, _mappingSize);
+    return;
+  }
+#endif
+  if (_ownsMem) {
+    free(_mem);
+  }
+}
 
 UR_APIEXPORT ur_result_t UR_APICALL urMemImageCreate(
     ur_context_handle_t hContext, ur_mem_flags_t flags,
     const ur_image_format_t *pImageFormat, const ur_image_desc_t *pImageDesc,
     void *pHost, ur_mem_handle_t *phMem) {
-  std::ignore = hContext;
-  std::ignore = flags;
-  std::ignore = pImageFormat;
-  std::ignore = pImageDesc;
-  std::ignore = pHost;
-  std::ignore = phMem;
+  UR_ASSERT(hContext, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pImageFormat && pImageDesc && phMem,
+            UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  UR_ASSERT((flags & UR_MEM_FLAGS_MASK) == 0,
+            UR_RESULT_ERROR_INVALID_ENUMERATION);
+  const bool useHostPtr = flags & UR_MEM_FLAG_USE_HOST_POINTER;
+  const bool copyHostPtr = flags & UR_MEM_FLAG_ALLOC_COPY_HOST_POINTER;
+  UR_ASSERT(pHost || !(useHostPtr || copyHostPtr),
+            UR_RESULT_ERROR_INVALID_HOST_PTR);
+
+  const size_t elementSize = native_cpu::image_element_size(*pImageFormat);
+  UR_ASSERT(elementSize, UR_RESULT_ERROR_UNSUPPORTED_IMAGE_FORMAT);
+  UR_ASSERT(pImageDesc->numMipLevel == 0 && pImageDesc->numSamples == 0,
+            UR_RESULT_ERROR_INVALID_IMAGE_FORMAT_DESCRIPTOR);
+
+  const ur_image_desc_t &desc = *pImageDesc;
+  size_t extent[3];
+  switch (desc.type) {
+  case UR_MEM_TYPE_IMAGE1D:
+    extent[0] = desc.width, extent[1] = 1, extent[2] = 1;
+    break;
+  case UR_MEM_TYPE_IMAGE1D_ARRAY:
+    extent[0] = desc.width, extent[1] = desc.arraySize, extent[2] = 1;
+    break;
+  case UR_MEM_TYPE_IMAGE2D:
+    extent[0] = desc.width, extent[1] = desc.height, extent[2] = 1;
+    break;
+  case UR_MEM_TYPE_IMAGE2D_ARRAY:
+    extent[0] = desc.width, extent[1] = desc.height,
+    extent[2] = desc.arraySize;
+    break;
+  case UR_MEM_TYPE_IMAGE3D:
+    extent[0] = desc.width, extent[1] = desc.height, extent[2] = desc.depth;
+    break;
+  default:
+    return UR_RESULT_ERROR_INVALID_IMAGE_FORMAT_DESCRIPTOR;
+  }
+  UR_ASSERT(extent[0] && extent[1] && extent[2],
+            UR_RESULT_ERROR_INVALID_IMAGE_SIZE);
 
-  DIE_NO_IMPLEMENTATION
+  const auto hostLayout = native_cpu::image_host_layout(
+      desc.type, elementSize, extent[0], extent[1], extent[2], desc.rowPitch,
+      desc.slicePitch);
+  try {
+    if (useHostPtr) {
+      // The host data is used in place, so the image keeps its layout
+      *phMem = new _ur_image(*pImageFormat, desc, extent, hostLayout, pHost);
+      return UR_RESULT_SUCCESS;
+    }
+    // 1D images gain nothing from tiles
+    const auto layout =
+        extent[1] == 1 && extent[2] == 1
+            ? native_cpu::image_layout::linear(elementSize, extent[0], 1, 1,
+                                               extent[0] * elementSize, 0)
+            : native_cpu::image_layout::tiled(elementSize, extent[0],
+                                              extent[1], extent[2]);
+    auto image = new _ur_image(*pImageFormat, desc, extent, layout);
+    if (copyHostPtr) {
+      const size_t origin[3] = {0, 0, 0};
+      native_cpu::copy_image(hContext->_device->tp, image->_mem, layout,
+                             origin, pHost, hostLayout, origin, extent);
+    }
+    *phMem = image;
+  } catch (const std::bad_alloc &) {
+    return UR_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+  }
+  return UR_RESULT_SUCCESS;
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urMemBufferCreate(
@@ -31,7 +340,6 @@ UR_APIEXPORT ur_result_t UR_APICALL urMemBufferCreate(
     const ur_buffer_properties_t *pProperties, ur_mem_handle_t *phBuffer) {
 
   // TODO: add proper error checking and double check flag semantics
-  // TODO: support UR_MEM_FLAG_ALLOC_COPY_HOST_POINTER flag
 
   UR_ASSERT(phBuffer, UR_RESULT_ERROR_INVALID_NULL_POINTER);
 
@@ -50,12 +358,16 @@ UR_APIEXPORT ur_result_t UR_APICALL urMemBufferCreate(
 
   ur_mem_handle_t_ *retMem;
 
-  if (useHostPtr) {
-    retMem = new _ur_buffer(hContext, pProperties->pHost);
-  } else if (copyHostPtr) {
-    retMem = new _ur_buffer(hContext, pProperties->pHost, size);
-  } else {
-    retMem = new _ur_buffer(hContext, size);
+  try {
+    if (useHostPtr) {
+      retMem = new _ur_buffer(hContext, pProperties->pHost);
+    } else if (copyHostPtr) {
+      retMem = new _ur_buffer(hContext, pProperties->pHost, size);
+    } else {
+      retMem = new _ur_buffer(hContext, size);
+    }
+  } catch (const std::bad_alloc &) {
+    return UR_RESULT_ERROR_OUT_OF_HOST_MEMORY;
   }
 
   *phBuffer = retMem;
@@ -113,11 +425,14 @@ UR_APIEXPORT ur_result_t UR_APICALL urMemBufferPartition(
 UR_APIEXPORT ur_result_t UR_APICALL
 urMemGetNativeHandle(ur_mem_handle_t hMem, ur_device_handle_t hDevice,
                      ur_native_handle_t *phNativeMem) {
-  std::ignore = hMem;
   std::ignore = hDevice;
-  std::ignore = phNativeMem;
+  UR_ASSERT(hMem, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(phNativeMem, UR_RESULT_ERROR_INVALID_NULL_POINTER);
 
-  DIE_NO_IMPLEMENTATION
+  // The native handle is the host memory itself
+  hMem->materializeAll();
+  *phNativeMem = reinterpret_cast<ur_native_handle_t>(hMem->_mem);
+  return UR_RESULT_SUCCESS;
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urMemBufferCreateWithNativeHandle(
@@ -164,11 +479,40 @@ UR_APIEXPORT ur_result_t UR_APICALL urMemImageGetInfo(ur_mem_handle_t hMemory,
                                                       size_t propSize,
                                                       void *pPropValue,
                                                       size_t *pPropSizeRet) {
-  std::ignore = hMemory;
-  std::ignore = propName;
-  std::ignore = propSize;
-  std::ignore = pPropValue;
-  std::ignore = pPropSizeRet;
-
-  DIE_NO_IMPLEMENTATION
+  UR_ASSERT(hMemory, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(hMemory->isImage(), UR_RESULT_ERROR_INVALID_MEM_OBJECT);
+
+  const auto *image = static_cast<const _ur_image *>(hMemory);
+  const auto &layout = image->Layout;
+  UrReturnHelper ReturnValue(propSize, pPropValue, pPropSizeRet);
+  switch (propName) {
+  case UR_IMAGE_INFO_FORMAT:
+    return ReturnValue(image->Format);
+  case UR_IMAGE_INFO_ELEMENT_SIZE:
+    return ReturnValue(layout.elementSize);
+  // Tiled images report the pitches of the linear layout they are read and
+  // written in by default.
+  case UR_IMAGE_INFO_ROW_PITCH:
+    return ReturnValue(layout.isTiled ? image->Extent[0] * layout.elementSize
+                                      : layout.rowPitch);
+  case UR_IMAGE_INFO_SLICE_PITCH:
+    if (image->Desc.type == UR_MEM_TYPE_IMAGE1D)
+      return ReturnValue(size_t{0});
+    if (!layout.isTiled)
+      return ReturnValue(image->Desc.type == UR_MEM_TYPE_IMAGE1D_ARRAY
+                             ? layout.rowPitch
+                             : layout.slicePitch);
+    return ReturnValue(image->Extent[0] * layout.elementSize *
+                       (image->Desc.type == UR_MEM_TYPE_IMAGE1D_ARRAY
+                            ? 1
+                            : image->Extent[1]));
+  case UR_IMAGE_INFO_WIDTH:
+    return ReturnValue(image->Desc.width);
+  case UR_IMAGE_INFO_HEIGHT:
+    return ReturnValue(image->Desc.height);
+  case UR_IMAGE_INFO_DEPTH:
+    return ReturnValue(image->Desc.depth);
+  default:
+    return UR_RESULT_ERROR_INVALID_ENUMERATION;
+  }
 }
@@ -11,57 +11,122 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
 
 #include "common.hpp"
 #include "context.hpp"
+#include "threadpool.hpp"
+#include "transfer.hpp"
+
+namespace native_cpu {
+
+// Copies of host data at least this large get an anonymous mapping of their
+// own, so that pages which are never touched don't take up any memory.
+constexpr size_t mapped_buffer_threshold = 1 << 20;
+
+// Set by UR_NATIVE_CPU_LAZY_COPY_HOST_POINTER=1. The application promises to
+// neither change nor free the host data of UR_MEM_FLAG_ALLOC_COPY_HOST_POINTER
+// buffers while they are alive (and not to truncate the file, if it is a
+// read-only file mapping), so the copy can be left until the data is used.
+bool lazy_copy_host_pointer();
+
+// Returns the size of an element of the format in bytes, or 0 if the format
+// isn't valid.
+size_t image_element_size(const ur_image_format_t &format);
+
+// The layout of host data for an image or a region of one, with the default
+// pitches filled in. Layers of 1D image arrays are `slicePitch` apart.
+image_layout image_host_layout(ur_mem_type_t type, size_t elementSize,
+                               size_t width, size_t height, size_t depth,
+                               size_t rowPitch, size_t slicePitch);
+
+// Copies host data into a buffer a chunk at a time, when commands first touch
+// the chunks.
+class lazy_host_copy {
+public:
+  lazy_host_copy(threadpool_t &tp, char *dst, const char *src, size_t size);
+
+  // Makes sure [offset, offset + size) holds the host data. Chunks that aren't
+  // copied yet are claimed and copied in parallel, chunks that another thread
+  // is copying are waited for.
+  void materialize(size_t offset, size_t size);
+
+private:
+  enum : uint8_t { pending, copying, done };
+
+  threadpool_t &tp;
+  char *const dst;
+  const char *const src;
+  const size_t size;
+  const size_t numChunks;
+  std::unique_ptr<std::atomic<uint8_t>[]> chunks;
+  std::atomic<size_t> remaining;
+};
+
+} // namespace native_cpu
 
 struct ur_mem_handle_t_ : _ur_object {
   ur_mem_handle_t_(size_t Size, bool _IsImage)
       : _mem{static_cast<char *>(malloc(Size))}, _ownsMem{true},
         IsImage{_IsImage} {}
 
-  ur_mem_handle_t_(void *HostPtr, size_t Size, bool _IsImage)
-      : _mem{static_cast<char *>(malloc(Size))}, _ownsMem{true}, IsImage{
-                                                                     _IsImage} {
-    memcpy(_mem, HostPtr, Size);
-  }
+  // Copies the host data, or arranges for it to be copied on first use.
+  // Throws std::bad_alloc if the memory can't be allocated.
+  ur_mem_handle_t_(native_cpu::threadpool_t &tp, void *HostPtr, size_t Size,
+                   bool _IsImage);
 
   ur_mem_handle_t_(void *HostPtr, bool _IsImage)
       : _mem{static_cast<char *>(HostPtr)}, _ownsMem{false}, IsImage{_IsImage} {
   }
 
-  ~ur_mem_handle_t_() {
-    if (_ownsMem) {
-      free(_mem);
-    }
-  }
+  // Memory objects are released through the base, whatever their type.
+  virtual ~ur_mem_handle_t_();
 
   void decrementRefCount() noexcept { _refCount--; }
 
   // Method to get type of the derived object (image or buffer)
   bool isImage() const { return this->IsImage; }
 
+  // Must be called before touching [Offset, Offset + Size) of _mem, in case
+  // the host data hasn't been copied there yet.
+  void materialize(size_t Offset, size_t Size) {
+    if (_lazyCopy)
+      _lazyCopy->materialize(Offset, Size);
+  }
+
+  // For uses of _mem that may touch any part of it, such as kernel arguments.
+  void materializeAll() { materialize(0, SIZE_MAX); }
+
   char *_mem;
   bool _ownsMem;
   std::atomic_uint32_t _refCount = {1};
 
 private:
   const bool IsImage;
+
+  // Set when _mem lies in a mapping of its own, which is unmapped instead of
+  // freed.
+  void *_mapping = nullptr;
+  size_t _mappingSize = 0;
+
+  std::unique_ptr<native_cpu::lazy_host_copy> _lazyCopy;
 };
 
 struct _ur_buffer final : ur_mem_handle_t_ {
   // Buffer constructor
   _ur_buffer(ur_context_handle_t /* Context*/, void *HostPtr)
       : ur_mem_handle_t_(HostPtr, false) {}
-  _ur_buffer(ur_context_handle_t /* Context*/, void *HostPtr, size_t Size)
-      : ur_mem_handle_t_(HostPtr, Size, false) {}
+  _ur_buffer(ur_context_handle_t Context, void *HostPtr, size_t Size)
+      : ur_mem_handle_t_(Context->_device->tp, HostPtr, Size, false) {}
   _ur_buffer(ur_context_handle_t /* Context*/, size_t Size)
       : ur_mem_handle_t_(Size, false) {}
   _ur_buffer(_ur_buffer *b, size_t Offset, size_t Size)
       : ur_mem_handle_t_(b->_mem + Offset, false), SubBuffer(b) {
-    std::ignore = Size;
+    // Sub-buffers use the parent's memory directly
+    b->materialize(Offset, Size);
     SubBuffer.Origin = Offset;
   }
 
@@ -74,3 +139,30 @@ struct _ur_buffer final : ur_mem_handle_t_ {
     size_t Origin; // only valid if Parent != nullptr
   } SubBuffer;
 };
+
+struct _ur_image final : ur_mem_handle_t_ {
+  // An image with memory of its own, laid out as `Layout`. Throws
+  // std::bad_alloc if the memory can't be allocated.
+  _ur_image(const ur_image_format_t &Format, const ur_image_desc_t &Desc,
+            const size_t Extent[3], const native_cpu::image_layout &Layout)
+      : ur_mem_handle_t_(Layout.size, true), Format(Format), Desc(Desc),
+        Layout(Layout), Extent{Extent[0], Extent[1], Extent[2]} {
+    if (!_mem)
+      throw std::bad_alloc();
+  }
+
+  // An image that uses the host data directly, in its linear layout.
+  _ur_image(const ur_image_format_t &Format, const ur_image_desc_t &Desc,
+            const size_t Extent[3], const native_cpu::image_layout &Layout,
+            void *HostPtr)
+      : ur_mem_handle_t_(HostPtr, true), Format(Format), Desc(Desc),
+        Layout(Layout), Extent{Extent[0], Extent[1], Extent[2]} {}
+
+  const ur_image_format_t Format;
+  const ur_image_desc_t Desc;
+  const native_cpu::image_layout Layout;
+  // Width, height and depth in elements. Layers of image arrays count as rows
+  // of 1D arrays and as slices of 2D arrays, as in the origins and regions of
+  // image commands.
+  const size_t Extent[3];
+};
@@ -0,0 +1,209 @@
+//===----------- numa.cpp - Native CPU Adapter ----------------------------===//
+//
+// Copyright (C) 2024 Intel Corporation
+//
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM
+// Exceptions. See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "numa.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <tuple>
+
+#include "logger/ur_logger.hpp"
+#include "ur_util.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace native_cpu {
+
+namespace {
+
+// Parses a sysfs list such as "0-3,8,10-11".
+std::vector<unsigned> parse_list(const std::string &list) {
+  std::vector<unsigned> values;
+  std::stringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    unsigned first, last;
+    char dash;
+    std::stringstream rangeStream(range);
+    if (!(rangeStream >> first))
+      continue;
+    if (!(rangeStream >> dash >> last) || dash != '-')
+      last = first;
+    for (unsigned value = first; value <= last; value++)
+      values.push_back(value);
+  }
+  return values;
+}
+
+std::optional<std::vector<unsigned>> read_list(const std::string &path) {
+  std::ifstream file(path);
+  std::string list;
+  if (!file || !std::getline(file, list))
+    return std::nullopt;
+  return parse_list(list);
+}
+
+// The CPUs this process is allowed to run on, which may be fewer than the
+// CPUs of the machine when running under taskset or in a container.
+std::vector<unsigned> get_allowed_cpus() {
+  std::vector<unsigned> cpus;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (unsigned cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &set))
+        cpus.push_back(cpu);
+    }
+  }
+#endif
+  if (cpus.empty()) {
+    unsigned numCpus = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned cpu = 0; cpu < numCpus; cpu++)
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+} // namespace
+
+std::vector<numa_node> get_numa_nodes(const std::string &sysfsRoot) {
+  const std::vector<unsigned> allowed = get_allowed_cpus();
+  std::vector<numa_node> nodes;
+  if (auto nodeIds = read_list(sysfsRoot + "/online")) {
+    for (unsigned id : *nodeIds) {
+      auto cpus =
+          read_list(sysfsRoot + "/node" + std::to_string(id) + "/cpulist");
+      if (!cpus)
+        continue;
+      numa_node node{id, {}};
+      for (unsigned cpu : *cpus) {
+        if (std::binary_search(allowed.begin(), allowed.end(), cpu))
+          node.cpus.push_back(cpu);
+      }
+      // Skip memory-only nodes and nodes we can't run on
+      if (!node.cpus.empty())
+        nodes.push_back(std::move(node));
+    }
+  }
+  if (nodes.empty())
+    nodes.push_back({0, allowed});
+  return nodes;
+}
+
+affinity_policy get_affinity_policy() {
+  auto value = ur_getenv("SYCL_NATIVE_CPU_AFFINITY");
+  if (!value || value->empty() || *value == "none")
+    return affinity_policy::none;
+  if (*value == "compact")
+    return affinity_policy::compact;
+  if (*value == "scatter")
+    return affinity_policy::scatter;
+  if (*value == "numa")
+    return affinity_policy::numa;
+  logger::warning("native_cpu: unknown SYCL_NATIVE_CPU_AFFINITY value '{}', "
+                  "workers won't be pinned",
+                  *value);
+  return affinity_policy::none;
+}
+
+std::vector<worker_placement>
+get_worker_placement(size_t numThreads, affinity_policy policy,
+                     const std::vector<numa_node> &nodes) {
+  std::vector<worker_placement> placement(numThreads);
+  size_t numCpus = 0;
+  for (auto &node : nodes)
+    numCpus += node.cpus.size();
+  if (policy == affinity_policy::none || numCpus == 0)
+    return placement;
+
+  // (node index, cpu) in the order workers are assigned to them
+  std::vector<std::pair<size_t, unsigned>> order;
+  if (policy == affinity_policy::scatter) {
+    for (size_t i = 0; order.size() < numThreads; i++) {
+      bool any = false;
+      for (size_t n = 0; n < nodes.size(); n++) {
+        if (i < nodes[n].cpus.size()) {
+          order.emplace_back(n, nodes[n].cpus[i]);
+          any = true;
+        }
+      }
+      // More threads than CPUs, start over
+      if (!any)
+        i = size_t(-1);
+    }
+  } else {
+    while (order.size() < numThreads) {
+      for (size_t n = 0; n < nodes.size(); n++) {
+        for (unsigned cpu : nodes[n].cpus)
+          order.emplace_back(n, cpu);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < numThreads; i++) {
+    auto [node, cpu] = order[i];
+    placement[i].node = node;
+    if (policy == affinity_policy::numa)
+      placement[i].cpus = nodes[node].cpus;
+    else
+      placement[i].cpus = {cpu};
+  }
+  return placement;
+}
+
+void pin_current_thread(const std::vector<unsigned> &cpus) {
+  if (cpus.empty())
+    return;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (unsigned cpu : cpus) {
+    if (cpu < CPU_SETSIZE)
+      CPU_SET(cpu, &set);
+  }
+  if (int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+    logger::warning("native_cpu: failed to pin worker thread: {}", err);
+#endif
+}
+
+void prefer_numa_node(void *ptr, size_t size, unsigned nodeId) {
+#if defined(__linux__) && defined(SYS_mbind)
+  // From linux/mempolicy.h, which isn't always installed
+  constexpr int MPOL_PREFERRED = 1;
+  constexpr unsigned long maxNodes = 1024;
+  static const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+
+  uintptr_t begin = (reinterpret_cast<uintptr_t>(ptr) + pageSize - 1) &
+                    ~(pageSize - 1);
+  uintptr_t end = (reinterpret_cast<uintptr_t>(ptr) + size) & ~(pageSize - 1);
+  if (nodeId >= maxNodes || end <= begin)
+    return;
+  unsigned long mask[maxNodes / (8 * sizeof(unsigned long))] = {};
+  mask[nodeId / (8 * sizeof(unsigned long))] |=
+      1ul << (nodeId % (8 * sizeof(unsigned long)));
+  syscall(SYS_mbind, begin, end - begin, MPOL_PREFERRED, mask, maxNodes, 0);
+#else
+  std::ignore = ptr;
+  std::ignore = size;
+  std::ignore = nodeId;
+#endif
+}
+
+} // namespace native_cpu
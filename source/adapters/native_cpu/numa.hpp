@@ -0,0 +1,64 @@
+//===----------- numa.hpp - Native CPU Adapter ----------------------------===//
+//
+// Copyright (C) 2024 Intel Corporation
+//
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM
+// Exceptions. See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace native_cpu {
+
+struct numa_node {
+  // The node's number in /sys/devices/system/node
+  unsigned id;
+  // The CPUs of the node this process is allowed to run on
+  std::vector<unsigned> cpus;
+};
+
+// Returns the NUMA nodes that have CPUs this process may run on, read from
+// `sysfsRoot`. Without NUMA information all the CPUs are reported as a single
+// node.
+std::vector<numa_node>
+get_numa_nodes(const std::string &sysfsRoot = "/sys/devices/system/node");
+
+// How the workers of a thread pool are pinned, set with
+// SYCL_NATIVE_CPU_AFFINITY:
+//  - none: workers aren't pinned, this is the default.
+//  - compact: worker i is pinned to the i-th CPU, filling up a node before
+//    moving on to the next one.
+//  - scatter: workers are pinned to one CPU each, going round-robin across
+//    the nodes.
+//  - numa: workers are split between the nodes like with compact, but each
+//    may run on any CPU of its node.
+enum class affinity_policy { none, compact, scatter, numa };
+
+affinity_policy get_affinity_policy();
+
+struct worker_placement {
+  // The CPUs the worker may run on, empty if it isn't pinned
+  std::vector<unsigned> cpus;
+  // Index of the worker's node in the list the placement was computed from
+  size_t node = 0;
+};
+
+// Decides where each of the `numThreads` workers of a pool runs.
+std::vector<worker_placement>
+get_worker_placement(size_t numThreads, affinity_policy policy,
+                     const std::vector<numa_node> &nodes);
+
+// Restricts the calling thread to `cpus`, does nothing if it is empty.
+void pin_current_thread(const std::vector<unsigned> &cpus);
+
+// Asks the kernel to place the pages fully inside [ptr, ptr + size) on the
+// given node when they are first touched. This is only a hint, failures are
+// ignored.
+void prefer_numa_node(void *ptr, size_t size, unsigned nodeId);
+
+} // namespace native_cpu
@@ -11,19 +11,69 @@
 #include "physical_mem.hpp"
 #include "common.hpp"
 #include "context.hpp"
+#include "virtual_mem.hpp"
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+ur_physical_mem_handle_t_::ur_physical_mem_handle_t_(
+    ur_context_handle_t context, int fd, size_t size)
+    : context(context), fd(fd), size(size) {
+  context->incrementReferenceCount();
+}
+
+ur_physical_mem_handle_t_::~ur_physical_mem_handle_t_() {
+#ifdef __linux__
+  close(fd);
+#endif
+  decrementOrDelete(context);
+}
 
 UR_APIEXPORT ur_result_t UR_APICALL urPhysicalMemCreate(
-    ur_context_handle_t, ur_device_handle_t, size_t,
-    const ur_physical_mem_properties_t *, ur_physical_mem_handle_t *) {
+    ur_context_handle_t hContext, ur_device_handle_t hDevice, size_t size,
+    const ur_physical_mem_properties_t *,
+    ur_physical_mem_handle_t *phPhysicalMem) {
+  UR_ASSERT(hContext, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(hDevice, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(phPhysicalMem, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+#ifdef __linux__
+  UR_ASSERT(size && size % native_cpu::virtual_mem_page_size() == 0,
+            UR_RESULT_ERROR_INVALID_SIZE);
+
+  int fd = memfd_create("ur_native_cpu_physical_mem", MFD_CLOEXEC);
+  if (fd < 0)
+    return native_cpu::virtual_mem_error(errno);
+  // The file is sparse, pages are only allocated when they are first touched
+  if (ftruncate(fd, size) != 0) {
+    const int error = errno;
+    close(fd);
+    return native_cpu::virtual_mem_error(error);
+  }
+  *phPhysicalMem = new ur_physical_mem_handle_t_(hContext, fd, size);
+  return UR_RESULT_SUCCESS;
+#else
+  std::ignore = size;
   return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+#endif
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL
-urPhysicalMemRetain(ur_physical_mem_handle_t) {
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+urPhysicalMemRetain(ur_physical_mem_handle_t hPhysicalMem) {
+  UR_ASSERT(hPhysicalMem, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  hPhysicalMem->incrementReferenceCount();
+  return UR_RESULT_SUCCESS;
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL
-urPhysicalMemRelease(ur_physical_mem_handle_t) {
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+urPhysicalMemRelease(ur_physical_mem_handle_t hPhysicalMem) {
+  UR_ASSERT(hPhysicalMem, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  // Mappings keep the memory alive on their own, so the file can be closed
+  // even if some are left.
+  decrementOrDelete(hPhysicalMem);
+  return UR_RESULT_SUCCESS;
 }
@@ -9,8 +9,24 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
-/// UR queue mapping on physical memory allocations used in virtual memory
-/// management.
-/// TODO: Implement.
+#include <cstddef>
+#include <ur_api.h>
+
+#include "common.hpp"
+
+/// Physical memory that virtual memory ranges can be mapped to. It is backed
+/// by an anonymous file, so the same memory can be mapped at several
+/// addresses, and stays alive while any of its mappings do.
 ///
-struct ur_physical_mem_handle_t_ {};
+struct ur_physical_mem_handle_t_ : RefCounted {
+  ur_physical_mem_handle_t_(ur_context_handle_t context, int fd, size_t size);
+  ~ur_physical_mem_handle_t_();
+
+  ur_physical_mem_handle_t_(const ur_physical_mem_handle_t_ &) = delete;
+  ur_physical_mem_handle_t_ &
+  operator=(const ur_physical_mem_handle_t_ &) = delete;
+
+  ur_context_handle_t const context;
+  const int fd;
+  const size_t size;
+};
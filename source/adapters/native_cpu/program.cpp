@@ -14,19 +14,90 @@
 #include "common/ur_util.hpp"
 #include "program.hpp"
 #include <cstdint>
+#include <cstring>
 #include <memory>
 
-UR_APIEXPORT ur_result_t UR_APICALL
-urProgramCreateWithIL(ur_context_handle_t hContext, const void *pIL,
-                      size_t length, const ur_program_properties_t *pProperties,
-                      ur_program_handle_t *phProgram) {
-  std::ignore = hContext;
-  std::ignore = pIL;
-  std::ignore = length;
-  std::ignore = pProperties;
-  std::ignore = phProgram;
+#ifdef __linux__
+#include <dlfcn.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+ur_program_handle_t_::~ur_program_handle_t_() {
+#ifdef __linux__
+  if (_library)
+    dlclose(_library);
+#endif
+}
 
-  DIE_NO_IMPLEMENTATION
+ur_result_t ur_program_handle_t_::loadLibrary(const void *pImage,
+                                              size_t size) {
+#ifdef __linux__
+  // The library is loaded from an anonymous file, so nothing is left behind
+  // on disk.
+  int fd = memfd_create("nativecpu_program", MFD_CLOEXEC);
+  if (fd < 0)
+    return UR_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+  const char *data = static_cast<const char *>(pImage);
+  for (size_t written = 0; written < size;) {
+    ssize_t res = write(fd, data + written, size - written);
+    if (res < 0) {
+      close(fd);
+      return UR_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    written += static_cast<size_t>(res);
+  }
+  const std::string path = "/proc/self/fd/" + std::to_string(fd);
+  _library = dlopen(path.c_str(), RTLD_LAZY | RTLD_LOCAL);
+  close(fd);
+  if (!_library) {
+    const char *err = dlerror();
+    logger::error("native_cpu: failed to load the program library: {}",
+                  err ? err : "unknown error");
+    return UR_RESULT_ERROR_INVALID_BINARY;
+  }
+  return UR_RESULT_SUCCESS;
+#else
+  std::ignore = pImage;
+  std::ignore = size;
+  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+#endif
+}
+
+const native_cpu::kernel_entry *
+ur_program_handle_t_::getKernel(const char *name) {
+  if (!_library) {
+    auto it = _kernels.find(name);
+    return it != _kernels.end() && it->second.ptr ? &it->second : nullptr;
+  }
+
+#ifdef __linux__
+  // Library kernels are exported under their own name. Entries are only
+  // added here, and references to them stay valid as the table grows.
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto &entry = _kernels[name];
+  if (!entry.ptr)
+    entry.ptr = static_cast<const unsigned char *>(dlsym(_library, name));
+  if (entry.ptr)
+    return &entry;
+  if (!entry.reqdWGSize && !entry.maxWGSize && !entry.maxLinearWGSize)
+    _kernels.erase(name);
+#endif
+  return nullptr;
+}
+
+// Shared libraries of ahead-of-time compiled kernels are marked by a program
+// metadata entry, binaries without it are the table of kernels linked into
+// the application.
+static bool isSharedLibrary(const ur_program_properties_t *pProps) {
+  if (pProps == nullptr)
+    return false;
+  for (uint32_t i = 0; i < pProps->count; i++) {
+    if (splitMetadataName(pProps->pMetadatas[i].pName).second ==
+        __SYCL_UR_PROGRAM_METADATA_TAG_NATIVE_CPU_SHARED_LIBRARY)
+      return true;
+  }
+  return false;
 }
 
 static ur_result_t
@@ -53,6 +124,56 @@ deserializeWGMetadata(const ur_program_metadata_t &MetadataElement,
   return UR_RESULT_SUCCESS;
 }
 
+// Records the work-group size metadata of each kernel in its entry.
+static ur_result_t readProgramMetadata(ur_program_handle_t_ &program,
+                                       const ur_program_properties_t *pProps) {
+  if (pProps == nullptr)
+    return UR_RESULT_SUCCESS;
+  for (uint32_t i = 0; i < pProps->count; i++) {
+    const auto &mdNode = pProps->pMetadatas[i];
+    std::string mdName(mdNode.pName);
+    auto [Prefix, Tag] = splitMetadataName(mdName);
+    if (Tag == __SYCL_UR_PROGRAM_METADATA_TAG_REQD_WORK_GROUP_SIZE ||
+        Tag == __SYCL_UR_PROGRAM_METADATA_TAG_MAX_WORK_GROUP_SIZE) {
+      bool isReqd = Tag == __SYCL_UR_PROGRAM_METADATA_TAG_REQD_WORK_GROUP_SIZE;
+      native_cpu::WGSize_t wgSizeProp;
+      auto res = deserializeWGMetadata(
+          mdNode, wgSizeProp,
+          isReqd ? 1 : std::numeric_limits<std::uint32_t>::max());
+      if (res != UR_RESULT_SUCCESS) {
+        return res;
+      }
+      auto &entry = program._kernels[Prefix];
+      (isReqd ? entry.reqdWGSize : entry.maxWGSize) = wgSizeProp;
+    } else if (Tag ==
+               __SYCL_UR_PROGRAM_METADATA_TAG_MAX_LINEAR_WORK_GROUP_SIZE) {
+      program._kernels[Prefix].maxLinearWGSize = mdNode.value.data64;
+    }
+  }
+  return UR_RESULT_SUCCESS;
+}
+
+UR_APIEXPORT ur_result_t UR_APICALL
+urProgramCreateWithIL(ur_context_handle_t hContext, const void *pIL,
+                      size_t length, const ur_program_properties_t *pProperties,
+                      ur_program_handle_t *phProgram) {
+  UR_ASSERT(hContext, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pIL && phProgram, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  // There is no compiler to turn IL into kernels at run time, but native code
+  // is native_cpu's IL, so shared libraries are accepted here as well.
+  if (!isSharedLibrary(pProperties))
+    return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+
+  auto hProgram = std::make_unique<ur_program_handle_t_>(hContext, nullptr);
+  if (auto res = readProgramMetadata(*hProgram, pProperties))
+    return res;
+  if (auto res = hProgram->loadLibrary(pIL, length))
+    return res;
+  *phProgram = hProgram.release();
+  return UR_RESULT_SUCCESS;
+}
+
 UR_APIEXPORT ur_result_t UR_APICALL urProgramCreateWithBinary(
     ur_context_handle_t hContext, uint32_t numDevices,
     ur_device_handle_t *phDevices, size_t *pLengths, const uint8_t **ppBinaries,
@@ -63,8 +184,6 @@ UR_APIEXPORT ur_result_t UR_APICALL urProgramCreateWithBinary(
 
   auto hDevice = phDevices[0];
   auto pBinary = ppBinaries[0];
-  std::ignore = pLengths;
-  std::ignore = pProperties;
 
   UR_ASSERT(hContext, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
   UR_ASSERT(hDevice, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
@@ -73,40 +192,23 @@ UR_APIEXPORT ur_result_t UR_APICALL urProgramCreateWithBinary(
 
   auto hProgram = std::make_unique<ur_program_handle_t_>(
       hContext, reinterpret_cast<const unsigned char *>(pBinary));
-  if (pProperties != nullptr) {
-    for (uint32_t i = 0; i < pProperties->count; i++) {
-      const auto &mdNode = pProperties->pMetadatas[i];
-      std::string mdName(mdNode.pName);
-      auto [Prefix, Tag] = splitMetadataName(mdName);
-      if (Tag == __SYCL_UR_PROGRAM_METADATA_TAG_REQD_WORK_GROUP_SIZE ||
-          Tag == __SYCL_UR_PROGRAM_METADATA_TAG_MAX_WORK_GROUP_SIZE) {
-        bool isReqd =
-            Tag == __SYCL_UR_PROGRAM_METADATA_TAG_REQD_WORK_GROUP_SIZE;
-        native_cpu::WGSize_t wgSizeProp;
-        auto res = deserializeWGMetadata(
-            mdNode, wgSizeProp,
-            isReqd ? 1 : std::numeric_limits<std::uint32_t>::max());
-        if (res != UR_RESULT_SUCCESS) {
-          return res;
-        }
-        (isReqd ? hProgram->KernelReqdWorkGroupSizeMD
-                : hProgram->KernelMaxWorkGroupSizeMD)[Prefix] =
-            std::move(wgSizeProp);
-      } else if (Tag ==
-                 __SYCL_UR_PROGRAM_METADATA_TAG_MAX_LINEAR_WORK_GROUP_SIZE) {
-        hProgram->KernelMaxLinearWorkGroupSizeMD[Prefix] = mdNode.value.data64;
-      }
+  if (auto res = readProgramMetadata(*hProgram, pProperties))
+    return res;
+
+  if (isSharedLibrary(pProperties)) {
+    UR_ASSERT(pLengths, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+    if (auto res = hProgram->loadLibrary(pBinary, pLengths[0]))
+      return res;
+  } else {
+    const nativecpu_entry *nativecpu_it =
+        reinterpret_cast<const nativecpu_entry *>(pBinary);
+    while (nativecpu_it->kernel_ptr != nullptr) {
+      hProgram->_kernels[nativecpu_it->kernelname].ptr =
+          nativecpu_it->kernel_ptr;
+      nativecpu_it++;
     }
   }
 
-  const nativecpu_entry *nativecpu_it =
-      reinterpret_cast<const nativecpu_entry *>(pBinary);
-  while (nativecpu_it->kernel_ptr != nullptr) {
-    hProgram->_kernels.insert(
-        std::make_pair(nativecpu_it->kernelname, nativecpu_it->kernel_ptr));
-    nativecpu_it++;
-  }
-
   *phProgram = hProgram.release();
 
   return UR_RESULT_SUCCESS;
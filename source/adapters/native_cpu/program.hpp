@@ -15,32 +15,54 @@
 #include "context.hpp"
 
 #include <array>
-#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
 
 namespace native_cpu {
 using WGSize_t = std::array<uint32_t, 3>;
-}
+
+// What urKernelCreate needs to know about a kernel, gathered once per program
+// so that creating a kernel takes a single hashed lookup.
+struct kernel_entry {
+  // Null until the kernel is first created if the program is a shared library
+  const unsigned char *ptr = nullptr;
+  std::optional<WGSize_t> reqdWGSize;
+  std::optional<WGSize_t> maxWGSize;
+  std::optional<uint64_t> maxLinearWGSize;
+};
+} // namespace native_cpu
 
 struct ur_program_handle_t_ : RefCounted {
   ur_program_handle_t_(ur_context_handle_t ctx, const unsigned char *pBinary)
       : _ctx{ctx}, _ptr{pBinary} {}
 
+  ~ur_program_handle_t_();
+
   uint32_t getReferenceCount() const noexcept { return _refCount; }
 
+  // Programs are either the table of kernels linked into the application, or
+  // a shared library of ahead-of-time compiled kernels. Kernels of a library
+  // are only looked up in it when they are first created, so loading a
+  // library with many kernels costs the same as loading one with a few.
+  // Returns UR_RESULT_ERROR_INVALID_BINARY if the library can't be loaded.
+  ur_result_t loadLibrary(const void *pImage, size_t size);
+
+  // Returns the kernel called `name`, with its function resolved, or null if
+  // the program has no such kernel.
+  const native_cpu::kernel_entry *getKernel(const char *name);
+
   ur_context_handle_t _ctx;
   const unsigned char *_ptr;
-  struct _compare {
-    bool operator()(char const *a, char const *b) const {
-      return std::strcmp(a, b) < 0;
-    }
-  };
-
-  std::map<const char *, const unsigned char *, _compare> _kernels;
-  std::unordered_map<std::string, native_cpu::WGSize_t>
-      KernelReqdWorkGroupSizeMD;
-  std::unordered_map<std::string, native_cpu::WGSize_t>
-      KernelMaxWorkGroupSizeMD;
-  std::unordered_map<std::string, uint64_t> KernelMaxLinearWorkGroupSizeMD;
+
+  // Filled in when the program is created, entries of library kernels are
+  // added or completed by getKernel.
+  std::unordered_map<std::string, native_cpu::kernel_entry> _kernels;
+
+private:
+  void *_library = nullptr;
+  std::mutex _mutex;
 };
 
 // The nativecpu_entry struct is also defined as LLVM-IR in the
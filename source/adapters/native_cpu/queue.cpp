@@ -8,34 +8,233 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <vector>
+
 #include "queue.hpp"
 #include "common.hpp"
+#include "event.hpp"
 
 #include "ur/ur.hpp"
 #include "ur_api.h"
 
+ur_result_t ur_queue_handle_t_::enqueue(
+    ur_command_t commandType, uint32_t numEventsInWaitList,
+    const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent,
+    std::function<void(ur_event_handle_t)> submit) {
+  return enqueueImpl(commandType, numEventsInWaitList, phEventWaitList,
+                     phEvent, ordering::command, std::move(submit));
+}
+
+ur_result_t ur_queue_handle_t_::enqueueWait(
+    ur_command_t commandType, uint32_t numEventsInWaitList,
+    const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent,
+    bool barrier) {
+  ordering order = barrier                    ? ordering::barrier
+                   : numEventsInWaitList == 0 ? ordering::wait_all
+                                              : ordering::command;
+  return enqueueImpl(commandType, numEventsInWaitList, phEventWaitList,
+                     phEvent, order, [](ur_event_handle_t event) {
+                       event->complete();
+                       decrementOrDelete(event);
+                     });
+}
+
+ur_result_t ur_queue_handle_t_::enqueueImpl(
+    ur_command_t commandType, uint32_t numEventsInWaitList,
+    const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent,
+    ordering order, std::function<void(ur_event_handle_t)> submit) {
+  UR_ASSERT(phEventWaitList || numEventsInWaitList == 0,
+            UR_RESULT_ERROR_INVALID_EVENT_WAIT_LIST);
+
+  // The reference created here is handed over to `submit`
+  auto event = new ur_event_handle_t_(
+      this, context, commandType,
+      (flags & UR_QUEUE_FLAG_PROFILING_ENABLE) ||
+          commandType == UR_COMMAND_TIMESTAMP_RECORDING_EXP);
+  if (phEvent) {
+    event->incrementReferenceCount();
+    *phEvent = event;
+  }
+
+  // The queue keeps a reference to each event it tracks. We take our own
+  // references to the events we depend on, or are passed on the queue's when
+  // the new command replaces them.
+  ur_event_handle_t previous;
+  std::vector<ur_event_handle_t> others;
+  if (isInOrder()) {
+    std::lock_guard<std::mutex> lock(mutex);
+    previous = tail;
+    event->incrementReferenceCount();
+    tail = event;
+  } else {
+    std::lock_guard<std::mutex> lock(mutex);
+    previous = tail;
+    if (order == ordering::barrier) {
+      others.swap(outstanding);
+      event->incrementReferenceCount();
+      tail = event;
+    } else {
+      if (previous)
+        previous->incrementReferenceCount();
+      if (order == ordering::wait_all) {
+        others = outstanding;
+        for (auto other : others)
+          other->incrementReferenceCount();
+      }
+      event->incrementReferenceCount();
+      outstanding.push_back(event);
+    }
+  }
+
+  // Events keep the queue alive, so it must stop tracking them once they
+  // have completed. The continuation holds its own reference to the event,
+  // which stays valid even after the queue has dropped its one.
+  event->incrementReferenceCount();
+  event->onComplete([this, event]() {
+    untrack(event);
+    decrementOrDelete(event);
+  });
+
+  struct pending_t {
+    std::atomic<uint32_t> count;
+    std::function<void(ur_event_handle_t)> submit;
+    ur_event_handle_t event;
+  };
+  auto pending = std::make_shared<pending_t>();
+  // One extra count so that `submit` can't run before every dependency has
+  // been registered.
+  pending->count = 1;
+  pending->submit = std::move(submit);
+  pending->event = event;
+  auto release = [pending]() {
+    if (pending->count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      pending->event->markSubmitted();
+      pending->submit(pending->event);
+    }
+  };
+  auto addDependency = [&](ur_event_handle_t dep) {
+    if (dep && !dep->isComplete()) {
+      pending->count.fetch_add(1, std::memory_order_relaxed);
+      dep->onComplete(release);
+    }
+  };
+
+  for (uint32_t i = 0; i < numEventsInWaitList; i++)
+    addDependency(phEventWaitList[i]);
+  if (previous) {
+    addDependency(previous);
+    decrementOrDelete(previous);
+  }
+  for (auto other : others) {
+    addDependency(other);
+    decrementOrDelete(other);
+  }
+  release();
+
+  return UR_RESULT_SUCCESS;
+}
+
+ur_result_t ur_queue_handle_t_::enqueueBlocking(
+    ur_command_t commandType, uint32_t numEventsInWaitList,
+    const ur_event_handle_t *phEventWaitList, ur_event_handle_t *phEvent,
+    std::function<void()> fn) {
+  auto ready = std::make_shared<std::promise<ur_event_handle_t>>();
+  auto readyFuture = ready->get_future();
+  auto result = enqueue(
+      commandType, numEventsInWaitList, phEventWaitList, phEvent,
+      [ready](ur_event_handle_t event) { ready->set_value(event); });
+  if (result != UR_RESULT_SUCCESS)
+    return result;
+
+  ur_event_handle_t event = readyFuture.get();
+  event->markStarted();
+  fn();
+  event->complete();
+  decrementOrDelete(event);
+  return UR_RESULT_SUCCESS;
+}
+
+void ur_queue_handle_t_::untrack(ur_event_handle_t event) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (tail == event) {
+    tail = nullptr;
+    decrementOrDelete(event);
+    return;
+  }
+  auto it = std::find(outstanding.begin(), outstanding.end(), event);
+  if (it != outstanding.end()) {
+    *it = outstanding.back();
+    outstanding.pop_back();
+    decrementOrDelete(event);
+  }
+}
+
+void ur_queue_handle_t_::finish() {
+  // Once the tail has completed so has everything that was enqueued before
+  // it, except for the commands of out-of-order queues enqueued after the last
+  // barrier.
+  std::vector<ur_event_handle_t> last;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    last = outstanding;
+    if (tail)
+      last.push_back(tail);
+    for (auto event : last)
+      event->incrementReferenceCount();
+  }
+  for (auto event : last) {
+    event->wait();
+    decrementOrDelete(event);
+  }
+}
+
+bool ur_queue_handle_t_::isEmpty() {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto event : outstanding) {
+    if (!event->isComplete())
+      return false;
+  }
+  return !tail || tail->isComplete();
+}
+
 UR_APIEXPORT ur_result_t UR_APICALL urQueueGetInfo(ur_queue_handle_t hQueue,
                                                    ur_queue_info_t propName,
                                                    size_t propSize,
                                                    void *pPropValue,
                                                    size_t *pPropSizeRet) {
-  std::ignore = hQueue;
-  std::ignore = propName;
-  std::ignore = propSize;
-  std::ignore = pPropValue;
-  std::ignore = pPropSizeRet;
+  UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
 
-  DIE_NO_IMPLEMENTATION;
+  UrReturnHelper ReturnValue(propSize, pPropValue, pPropSizeRet);
+  switch (propName) {
+  case UR_QUEUE_INFO_CONTEXT:
+    return ReturnValue(hQueue->context);
+  case UR_QUEUE_INFO_DEVICE:
+    return ReturnValue(ur_device_handle_t{hQueue->device});
+  case UR_QUEUE_INFO_FLAGS:
+    return ReturnValue(hQueue->flags);
+  case UR_QUEUE_INFO_REFERENCE_COUNT:
+    return ReturnValue(uint32_t{hQueue->getReferenceCount()});
+  case UR_QUEUE_INFO_EMPTY:
+    return ReturnValue(hQueue->isEmpty());
+  case UR_QUEUE_INFO_DEVICE_DEFAULT:
+  case UR_QUEUE_INFO_SIZE:
+    return UR_RESULT_ERROR_UNSUPPORTED_ENUMERATION;
+  default:
+    return UR_RESULT_ERROR_INVALID_ENUMERATION;
+  }
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urQueueCreate(
     ur_context_handle_t hContext, ur_device_handle_t hDevice,
     const ur_queue_properties_t *pProperties, ur_queue_handle_t *phQueue) {
-  std::ignore = hContext;
-  std::ignore = hDevice;
-  std::ignore = pProperties;
-
-  auto Queue = new ur_queue_handle_t_(hDevice);
+  ur_queue_flags_t Flags = pProperties ? pProperties->flags : 0;
+  if ((Flags & UR_QUEUE_FLAG_PRIORITY_HIGH) &&
+      (Flags & UR_QUEUE_FLAG_PRIORITY_LOW))
+    return UR_RESULT_ERROR_INVALID_QUEUE_PROPERTIES;
+  auto Queue = new ur_queue_handle_t_(hDevice, hContext, Flags);
   *phQueue = Queue;
 
   return UR_RESULT_SUCCESS;
@@ -78,13 +277,16 @@ UR_APIEXPORT ur_result_t UR_APICALL urQueueCreateWithNativeHandle(
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urQueueFinish(ur_queue_handle_t hQueue) {
-  std::ignore = hQueue;
-  // TODO: is this fine as no-op?
+  UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  hQueue->finish();
   return UR_RESULT_SUCCESS;
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urQueueFlush(ur_queue_handle_t hQueue) {
-  std::ignore = hQueue;
+  UR_ASSERT(hQueue, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
 
-  DIE_NO_IMPLEMENTATION;
+  // Commands are submitted to the thread pool as soon as their dependencies
+  // are met, so there is nothing to flush.
+  return UR_RESULT_SUCCESS;
 }
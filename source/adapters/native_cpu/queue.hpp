@@ -8,11 +8,89 @@
 //
 //===----------------------------------------------------------------------===//
 #pragma once
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
 #include "common.hpp"
 #include "device.hpp"
+#include "event.hpp"
 
 struct ur_queue_handle_t_ : RefCounted {
   ur_device_handle_t_ *const device;
+  ur_context_handle_t const context;
+  const ur_queue_flags_t flags;
+
+  ur_queue_handle_t_(ur_device_handle_t_ *device, ur_context_handle_t context,
+                     ur_queue_flags_t flags)
+      : device(device), context(context), flags(flags) {}
+
+  // Commands of in-order queues run one after the other, those of out-of-order
+  // queues only wait for their wait list and for the last barrier.
+  bool isInOrder() const {
+    return !(flags & UR_QUEUE_FLAG_OUT_OF_ORDER_EXEC_MODE_ENABLE);
+  }
+
+  // The priority the tasks of this queue's commands are scheduled with.
+  native_cpu::task_priority priority() const {
+    if (flags & UR_QUEUE_FLAG_PRIORITY_HIGH)
+      return native_cpu::task_priority::high;
+    if (flags & UR_QUEUE_FLAG_PRIORITY_LOW)
+      return native_cpu::task_priority::low;
+    return native_cpu::task_priority::normal;
+  }
+
+  // Creates the event of a new command and calls `submit` once every event in
+  // the wait list and the commands it must follow on this queue have
+  // completed. `submit` may be called on the calling thread or on a thread
+  // of the device's thread pool. It owns a reference to the event it is given
+  // and must eventually call complete() on it and release that reference.
+  ur_result_t enqueue(ur_command_t commandType, uint32_t numEventsInWaitList,
+                      const ur_event_handle_t *phEventWaitList,
+                      ur_event_handle_t *phEvent,
+                      std::function<void(ur_event_handle_t)> submit);
+
+  // Enqueues a command that does nothing but wait. With an empty wait list it
+  // waits for every command enqueued so far. A barrier also makes every
+  // command enqueued after it wait for it.
+  ur_result_t enqueueWait(ur_command_t commandType,
+                          uint32_t numEventsInWaitList,
+                          const ur_event_handle_t *phEventWaitList,
+                          ur_event_handle_t *phEvent, bool barrier);
+
+  // Like enqueue, but runs `fn` on the calling thread and only returns once it
+  // has run. Used by commands that aren't offloaded to the thread pool.
+  ur_result_t enqueueBlocking(ur_command_t commandType,
+                              uint32_t numEventsInWaitList,
+                              const ur_event_handle_t *phEventWaitList,
+                              ur_event_handle_t *phEvent,
+                              std::function<void()> fn);
+
+  // Blocks until every command enqueued so far has completed.
+  void finish();
+
+  // Returns true if every command enqueued so far has completed.
+  bool isEmpty();
+
+private:
+  enum class ordering { command, wait_all, barrier };
+
+  // Stops tracking `event` as the tail or as an outstanding command, called
+  // once it has completed.
+  void untrack(ur_event_handle_t event);
+
+  ur_result_t enqueueImpl(ur_command_t commandType,
+                          uint32_t numEventsInWaitList,
+                          const ur_event_handle_t *phEventWaitList,
+                          ur_event_handle_t *phEvent, ordering order,
+                          std::function<void(ur_event_handle_t)> submit);
 
-  ur_queue_handle_t_(ur_device_handle_t_ *device) : device(device) {}
+  std::mutex mutex;
+  // The command every new command depends on: the previous one on in-order
+  // queues and the last barrier on out-of-order ones.
+  ur_event_handle_t tail = nullptr;
+  // Out-of-order queues only. The commands enqueued since the last barrier,
+  // which the next barrier waits for. Completed ones are dropped by untrack.
+  std::vector<ur_event_handle_t> outstanding;
 };
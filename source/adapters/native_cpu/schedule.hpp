@@ -0,0 +1,196 @@
+//===----------- schedule.hpp - Native CPU Adapter ------------------------===//
+//
+// Copyright (C) 2024 Intel Corporation
+//
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM
+// Exceptions. See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+#include "ur_util.hpp"
+
+namespace native_cpu {
+
+// Number of work units claimed at once by a thread, overrides the guided
+// schedule with a dynamic one when set.
+inline std::optional<size_t> get_chunk_size_override() {
+  static const std::optional<size_t> chunkSize =
+      []() -> std::optional<size_t> {
+    auto value = getenv_to_unsigned("SYCL_NATIVE_CPU_CHUNK_SIZE");
+    if (value && *value > 0)
+      return *value;
+    return std::nullopt;
+  }();
+  return chunkSize;
+}
+
+// Hands out ranges of [0, size) to the threads running a launch. Threads keep
+// claiming ranges until the space is exhausted, so a thread that gets cheap
+// work-groups simply claims more of them.
+//
+// By default ranges follow a guided schedule: each claim takes a share of the
+// remaining units, so early claims are large and cheap to hand out, and late
+// claims are small enough for threads to finish at roughly the same time.
+// SYCL_NATIVE_CPU_CHUNK_SIZE switches to fixed-size chunks instead.
+class guided_schedule {
+public:
+  guided_schedule(size_t size, size_t numThreads)
+      : m_size(size), m_divisor(2 * std::max<size_t>(numThreads, 1)) {
+    if (auto chunkSize = get_chunk_size_override()) {
+      m_minChunk = *chunkSize;
+      m_fixed = true;
+    } else {
+      // Don't go below a few claims per thread, past that point contention
+      // on the counter costs more than the imbalance it removes.
+      m_minChunk = std::max<size_t>(1, size / (m_divisor * 16));
+      m_fixed = false;
+    }
+  }
+
+  // Claims the next range [begin, end), returns false once everything has
+  // been claimed.
+  bool next(size_t &begin, size_t &end) {
+    size_t current = m_next.load(std::memory_order_relaxed);
+    while (current < m_size) {
+      size_t remaining = m_size - current;
+      size_t chunk = m_fixed ? m_minChunk
+                             : std::max(m_minChunk, remaining / m_divisor);
+      chunk = std::min(chunk, remaining);
+      if (m_next.compare_exchange_weak(current, current + chunk,
+                                       std::memory_order_relaxed)) {
+        begin = current;
+        end = current + chunk;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Makes the whole range available again.
+  void reset() { m_next.store(0, std::memory_order_relaxed); }
+
+private:
+  std::atomic<size_t> m_next{0};
+  const size_t m_size;
+  const size_t m_divisor;
+  size_t m_minChunk;
+  bool m_fixed;
+};
+
+// Splits [0, size) into one contiguous part per NUMA node, sized after the
+// number of workers on the node, and hands out each part with a guided
+// schedule. Workers claim from their own node's part first and only help with
+// the other parts once it is exhausted. Launches over the same range thus run
+// each work-group on the same node, which is also the node that first touched,
+// and so holds, the data the work-group accesses.
+class node_schedule {
+public:
+  node_schedule(size_t size, const std::vector<size_t> &workersPerNode) {
+    size_t numWorkers = 0;
+    for (size_t workers : workersPerNode)
+      numWorkers += workers;
+    if (workersPerNode.size() <= 1) {
+      m_single.emplace(0, size, numWorkers);
+      return;
+    }
+    size_t before = 0;
+    size_t offset = 0;
+    for (size_t workers : workersPerNode) {
+      before += workers;
+      size_t end = size / numWorkers * before + size % numWorkers * before /
+                                                   numWorkers;
+      m_parts.push_back(std::make_unique<part>(offset, end - offset, workers));
+      offset = end;
+    }
+  }
+
+  // Claims the next range [begin, end) for a worker of `node`.
+  bool next(size_t node, size_t &begin, size_t &end) {
+    size_t numParts = m_parts.empty() ? 1 : m_parts.size();
+    for (size_t i = 0; i < numParts; i++) {
+      part &p = getPart((node + i) % numParts);
+      if (p.schedule.next(begin, end)) {
+        begin += p.offset;
+        end += p.offset;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void reset() {
+    size_t numParts = m_parts.empty() ? 1 : m_parts.size();
+    for (size_t i = 0; i < numParts; i++)
+      getPart(i).schedule.reset();
+  }
+
+private:
+  struct part {
+    part(size_t offset, size_t size, size_t numThreads)
+        : offset(offset), schedule(size, numThreads) {}
+    const size_t offset;
+    guided_schedule schedule;
+  };
+
+  part &getPart(size_t i) { return m_parts.empty() ? *m_single : *m_parts[i]; }
+
+  // Most thread pools only span one node, which doesn't need an allocation
+  std::optional<part> m_single;
+  std::vector<std::unique_ptr<part>> m_parts;
+};
+
+// Accumulates the time each thread spends running the tasks of a launch and
+// logs it at debug level once the launch is done, so that load imbalance
+// across the thread pool can be measured.
+class busy_time_report {
+public:
+  using clock = std::chrono::steady_clock;
+
+  busy_time_report(std::string name, size_t numThreads)
+      : m_name(std::move(name)), m_busy(numThreads) {}
+
+  ~busy_time_report() {
+    uint64_t total = 0, max = 0;
+    std::string perThread;
+    for (size_t i = 0; i < m_busy.size(); i++) {
+      uint64_t ns = m_busy[i].load(std::memory_order_relaxed);
+      total += ns;
+      max = std::max(max, ns);
+      perThread += (i ? " " : "") + std::to_string(ns / 1000);
+    }
+    double mean = double(total) / std::max<size_t>(m_busy.size(), 1);
+    logger::debug("native_cpu: {} busy time per thread (us): {}, imbalance "
+                  "(max/mean): {}",
+                  m_name, perThread, mean > 0 ? max / mean : 1.0);
+  }
+
+  // Only collect busy times when they are going to be reported.
+  static bool enabled() {
+    return logger::get_logger().getLevel() <= logger::Level::DEBUG;
+  }
+
+  void add(size_t threadId, clock::time_point start) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  clock::now() - start)
+                  .count();
+    m_busy[threadId].fetch_add(ns, std::memory_order_relaxed);
+  }
+
+private:
+  std::string m_name;
+  std::vector<std::atomic<uint64_t>> m_busy;
+};
+
+} // namespace native_cpu
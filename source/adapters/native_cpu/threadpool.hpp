@@ -10,34 +10,60 @@
 #include <algorithm>
 #include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <cstdlib>
+#include <deque>
 #include <forward_list>
 #include <functional>
-#include <future>
 #include <iterator>
 #include <mutex>
+#include <memory>
 #include <numeric>
+#include <optional>
 #include <queue>
 #include <string>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
+#include "numa.hpp"
+
 namespace native_cpu {
 
 using worker_task_t = std::function<void(size_t)>;
 
+// Idle workers pick up the tasks of higher priority first. Queues created
+// with UR_QUEUE_FLAG_PRIORITY_HIGH or _LOW schedule their commands with the
+// matching priority.
+enum class task_priority { high, normal, low };
+
 namespace detail {
 
+// Pools always have at least one worker, even if the variable asks for none
+// or the number of hardware threads can't be determined.
+inline size_t get_num_threads() {
+  size_t numThreads;
+  char *envVar = std::getenv("SYCL_NATIVE_CPU_HOST_THREADS");
+  if (envVar) {
+    numThreads = std::stoul(envVar);
+  } else {
+    numThreads = std::thread::hardware_concurrency();
+  }
+  return std::max<size_t>(numThreads, 1);
+}
+
 class worker_thread {
 public:
-  // Initializes state, but does not start the worker thread
-  worker_thread(size_t threadId) noexcept
+  // Initializes state and starts the worker thread, pinned to `cpus` if
+  // there are any
+  worker_thread(size_t threadId, std::vector<unsigned> cpus = {}) noexcept
       : m_threadId(threadId), m_isRunning(false), m_numTasks(0) {
     std::lock_guard<std::mutex> lock(m_workMutex);
     if (this->is_running()) {
       return;
     }
-    m_worker = std::thread([this]() {
+    m_worker = std::thread([this, cpus = std::move(cpus)]() {
+      pin_current_thread(cpus);
       while (true) {
         std::unique_lock<std::mutex> lock(m_workMutex);
         // Wait until there's work available
@@ -121,9 +147,22 @@ private:
 class simple_thread_pool {
 public:
   simple_thread_pool() noexcept
-      : m_isRunning(false), m_numThreads(get_num_threads()) {
+      : simple_thread_pool(std::vector<worker_placement>(get_num_threads())) {}
+
+  // Starts one worker per entry of `placement`, like
+  // work_stealing_thread_pool does.
+  explicit simple_thread_pool(std::vector<worker_placement> placement) noexcept
+      : m_isRunning(false),
+        m_numThreads(std::max<size_t>(placement.size(), 1)),
+        m_workerNodes(m_numThreads) {
+    placement.resize(m_numThreads);
     for (size_t i = 0; i < m_numThreads; i++) {
-      m_workers.emplace_front(i);
+      size_t node = placement[i].node;
+      m_workerNodes[i] = node;
+      if (node >= m_workersPerNode.size())
+        m_workersPerNode.resize(node + 1);
+      m_workersPerNode[node]++;
+      m_workers.emplace_front(i, std::move(placement[i].cpus));
     }
     m_isRunning.store(true, std::memory_order_release);
   }
@@ -135,17 +174,42 @@ public:
     m_isRunning.store(false, std::memory_order_release);
   }
 
-  inline void schedule(const worker_task_t &task) {
+  // Every worker runs its tasks in order, so the priority is ignored
+  inline void schedule(const worker_task_t &task,
+                       task_priority = task_priority::normal) {
     // Schedule the task on the best available worker thread
     this->best_worker().schedule(task);
   }
 
+  // Workers keep a copy of their tasks, so borrowed tasks are scheduled like
+  // any other.
+  inline void
+  schedule_borrowed(const worker_task_t &task,
+                    task_priority priority = task_priority::normal) {
+    schedule(task, priority);
+  }
+
+  inline void schedule_bulk(const worker_task_t &task, size_t count,
+                            task_priority priority = task_priority::normal) {
+    for (size_t i = 0; i < count; i++) {
+      schedule(task, priority);
+    }
+  }
+
   inline bool is_running() const noexcept {
     return m_isRunning.load(std::memory_order_acquire);
   }
 
   inline size_t num_threads() const noexcept { return m_numThreads; }
 
+  inline const std::vector<size_t> &workers_per_node() const noexcept {
+    return m_workersPerNode;
+  }
+
+  inline size_t worker_node(size_t threadId) const noexcept {
+    return m_workerNodes[threadId];
+  }
+
   inline size_t num_pending_tasks() const noexcept {
     return std::accumulate(std::begin(m_workers), std::end(m_workers),
                            size_t(0),
@@ -174,22 +238,416 @@ protected:
   }
 
 private:
-  static size_t get_num_threads() {
-    size_t numThreads;
-    char *envVar = std::getenv("SYCL_NATIVE_CPU_HOST_THREADS");
-    if (envVar) {
-      numThreads = std::stoul(envVar);
+  std::forward_list<worker_thread> m_workers;
+
+  std::atomic<bool> m_isRunning;
+
+  const size_t m_numThreads;
+
+  // Node of every worker, indexed by thread ID
+  std::vector<size_t> m_workerNodes;
+
+  std::vector<size_t> m_workersPerNode;
+};
+
+// Lock-free work-stealing deque (Chase and Lev, "Dynamic Circular
+// Work-Stealing Deque", using the memory orderings from Le et al., "Correct
+// and Efficient Work-Stealing for Weak Memory Models"). Only the owning worker
+// may push and pop at the bottom, any other thread may steal from the top.
+template <typename T> class work_stealing_deque {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "work_stealing_deque elements are copied without locking");
+
+  struct ring_buffer {
+    explicit ring_buffer(int64_t capacity)
+        : m_capacity(capacity), m_mask(capacity - 1),
+          m_data(new std::atomic<T>[capacity]) {}
+
+    int64_t capacity() const noexcept { return m_capacity; }
+
+    void put(int64_t index, T item) noexcept {
+      m_data[index & m_mask].store(item, std::memory_order_relaxed);
+    }
+
+    T get(int64_t index) const noexcept {
+      return m_data[index & m_mask].load(std::memory_order_relaxed);
+    }
+
+    ring_buffer *grow(int64_t bottom, int64_t top) const {
+      auto *newBuffer = new ring_buffer(m_capacity * 2);
+      for (int64_t i = top; i != bottom; i++) {
+        newBuffer->put(i, get(i));
+      }
+      return newBuffer;
+    }
+
+  private:
+    const int64_t m_capacity;
+    const int64_t m_mask;
+    std::unique_ptr<std::atomic<T>[]> m_data;
+  };
+
+public:
+  // The capacity must be a power of two, the deque grows as needed.
+  explicit work_stealing_deque(int64_t capacity = 256)
+      : m_top(0), m_bottom(0), m_buffer(new ring_buffer(capacity)) {
+    m_retiredBuffers.emplace_back(m_buffer.load(std::memory_order_relaxed));
+  }
+
+  work_stealing_deque(const work_stealing_deque &) = delete;
+  work_stealing_deque &operator=(const work_stealing_deque &) = delete;
+
+  // Owner only
+  void push(T item) {
+    int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    int64_t top = m_top.load(std::memory_order_acquire);
+    ring_buffer *buffer = m_buffer.load(std::memory_order_relaxed);
+    if (bottom - top > buffer->capacity() - 1) {
+      // Thieves may still be reading from the old buffer, so it is only
+      // released together with the deque.
+      buffer = buffer->grow(bottom, top);
+      m_retiredBuffers.emplace_back(buffer);
+      m_buffer.store(buffer, std::memory_order_release);
+    }
+    buffer->put(bottom, item);
+    // Release store rather than a fence, so that thieves which acquire the
+    // new bottom are also ordered after the put for race detectors
+    m_bottom.store(bottom + 1, std::memory_order_release);
+  }
+
+  // Owner only
+  std::optional<T> pop() {
+    int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    ring_buffer *buffer = m_buffer.load(std::memory_order_relaxed);
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = m_top.load(std::memory_order_relaxed);
+
+    std::optional<T> item;
+    if (top <= bottom) {
+      item = buffer->get(bottom);
+      if (top == bottom) {
+        // Last element, race against the thieves for it
+        if (!m_top.compare_exchange_strong(top, top + 1,
+                                           std::memory_order_seq_cst,
+                                           std::memory_order_relaxed)) {
+          item.reset();
+        }
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      }
     } else {
-      numThreads = std::thread::hardware_concurrency();
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
     }
-    return numThreads;
+    return item;
   }
 
-  std::forward_list<worker_thread> m_workers;
+  // Any thread. Returns an empty optional if the deque is empty or if another
+  // thread won the race for the top element.
+  std::optional<T> steal() {
+    int64_t top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = m_bottom.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return std::nullopt;
+    }
+    ring_buffer *buffer = m_buffer.load(std::memory_order_acquire);
+    T item = buffer->get(top);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+      return std::nullopt;
+    }
+    return item;
+  }
+
+  bool empty() const noexcept {
+    return m_bottom.load(std::memory_order_relaxed) <=
+           m_top.load(std::memory_order_relaxed);
+  }
+
+private:
+  // top and bottom are written by different threads, keep them on separate
+  // cache lines
+  alignas(64) std::atomic<int64_t> m_top;
+  alignas(64) std::atomic<int64_t> m_bottom;
+  std::atomic<ring_buffer *> m_buffer;
+  std::vector<std::unique_ptr<ring_buffer>> m_retiredBuffers;
+};
+
+// Thread pool where every worker owns a work-stealing deque. Tasks scheduled
+// from a worker of the pool go to that worker's deque, tasks scheduled from
+// any other thread go to a shared injection queue. Idle workers first drain
+// their own deque, then take a batch from the injection queue and finally
+// steal from a randomly chosen victim, so work that is queued behind a long
+// running task is picked up by whichever thread becomes free first.
+class work_stealing_thread_pool {
+  struct worker {
+    work_stealing_deque<worker_task_t *> m_deque;
+    std::thread m_thread;
+    uint64_t m_rngState;
+    worker_placement m_placement;
+  };
+
+public:
+  work_stealing_thread_pool() noexcept
+      : work_stealing_thread_pool(
+            std::vector<worker_placement>(get_num_threads())) {}
+
+  // Starts one worker per entry of `placement`, pinned to its CPUs. An
+  // empty placement still gets a single, unpinned, worker.
+  explicit work_stealing_thread_pool(
+      std::vector<worker_placement> placement) noexcept
+      : m_isRunning(false),
+        m_numThreads(std::max<size_t>(placement.size(), 1)),
+        m_workers(m_numThreads) {
+    for (size_t i = 0; i < m_numThreads; i++) {
+      // Any non-zero seed will do for xorshift
+      m_workers[i].m_rngState = 0x9E3779B97F4A7C15ull * (i + 1);
+      if (i < placement.size())
+        m_workers[i].m_placement = std::move(placement[i]);
+      size_t node = m_workers[i].m_placement.node;
+      if (node >= m_workersPerNode.size())
+        m_workersPerNode.resize(node + 1);
+      m_workersPerNode[node]++;
+    }
+    m_isRunning.store(true, std::memory_order_release);
+    for (size_t i = 0; i < m_numThreads; i++) {
+      m_workers[i].m_thread = std::thread([this, i]() {
+        pin_current_thread(m_workers[i].m_placement.cpus);
+        run(i);
+      });
+    }
+  }
+
+  ~work_stealing_thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(m_sleepMutex);
+      m_isRunning.store(false, std::memory_order_seq_cst);
+    }
+    m_wakeCondition.notify_all();
+    for (auto &w : m_workers) {
+      if (w.m_thread.joinable()) {
+        // Workers only exit once every queued task has been run
+        w.m_thread.join();
+      }
+    }
+  }
+
+  inline void schedule(const worker_task_t &task,
+                       task_priority priority = task_priority::normal) {
+    push(new worker_task_t(task), 1, priority);
+  }
+
+  // Schedules a task that stays owned by the caller, who must keep it alive
+  // until it has run. The same task may be scheduled several times at once.
+  inline void
+  schedule_borrowed(const worker_task_t &task,
+                    task_priority priority = task_priority::normal) {
+    schedule_bulk(task, 1, priority);
+  }
+
+  // Schedules `count` runs of a borrowed task at once, taking the injection
+  // lock and waking the workers once rather than for every run.
+  inline void schedule_bulk(const worker_task_t &task, size_t count,
+                            task_priority priority = task_priority::normal) {
+    if (count == 0)
+      return;
+    // Allocations are aligned, so the low bit is free to tell borrowed tasks
+    // apart from the ones the pool deletes once they have run
+    push(reinterpret_cast<worker_task_t *>(reinterpret_cast<uintptr_t>(&task) |
+                                           borrowed_tag),
+         count, priority);
+  }
+
+  inline bool is_running() const noexcept {
+    return m_isRunning.load(std::memory_order_acquire);
+  }
+
+  inline size_t num_threads() const noexcept { return m_numThreads; }
+
+  // Number of workers on each of the NUMA nodes the pool is spread over,
+  // there is a single node unless the workers are pinned
+  inline const std::vector<size_t> &workers_per_node() const noexcept {
+    return m_workersPerNode;
+  }
+
+  inline size_t worker_node(size_t threadId) const noexcept {
+    return m_workers[threadId].m_placement.node;
+  }
+
+  // Number of tasks that have been scheduled but haven't finished yet
+  inline size_t num_pending_tasks() const noexcept {
+    return m_numPending.load(std::memory_order_acquire);
+  }
+
+  void wait_for_all_pending_tasks() {
+    while (num_pending_tasks() > 0) {
+      std::this_thread::yield();
+    }
+  }
+
+private:
+  static constexpr uintptr_t borrowed_tag = 1;
+
+  // Queues `count` runs of `newTask`. Workers keep normal priority tasks in
+  // their own deque, everything else goes to the injection queue of its
+  // priority so that the priority isn't lost.
+  void push(worker_task_t *newTask, size_t count, task_priority priority) {
+    m_numPending.fetch_add(count, std::memory_order_relaxed);
+    if (t_currentPool == this && priority == task_priority::normal) {
+      for (size_t i = 0; i < count; i++)
+        m_workers[t_currentWorker].m_deque.push(newTask);
+    } else {
+      const auto p = static_cast<size_t>(priority);
+      std::lock_guard<std::mutex> lock(m_injectionMutex);
+      m_injectionQueues[p].insert(m_injectionQueues[p].end(), count, newTask);
+      m_numInjected[p].fetch_add(count, std::memory_order_relaxed);
+    }
+    m_numQueued.fetch_add(count, std::memory_order_seq_cst);
+    wake_workers(count);
+  }
+
+  void wake_workers(size_t numTasks) {
+    if (m_numSleeping.load(std::memory_order_seq_cst) > 0) {
+      // Taking the lock guarantees that a worker that is about to sleep
+      // either sees the new task or is already waiting for the notification
+      { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+      if (numTasks == 1)
+        m_wakeCondition.notify_one();
+      else
+        m_wakeCondition.notify_all();
+    }
+  }
+
+  void run(size_t threadId) {
+    t_currentPool = this;
+    t_currentWorker = threadId;
+    while (true) {
+      if (worker_task_t *task = find_task(threadId)) {
+        m_numQueued.fetch_sub(1, std::memory_order_relaxed);
+        const auto bits = reinterpret_cast<uintptr_t>(task);
+        if (bits & borrowed_tag) {
+          (*reinterpret_cast<worker_task_t *>(bits & ~borrowed_tag))(threadId);
+        } else {
+          (*task)(threadId);
+          delete task;
+        }
+        m_numPending.fetch_sub(1, std::memory_order_acq_rel);
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(m_sleepMutex);
+      if (!is_running() && m_numQueued.load(std::memory_order_seq_cst) == 0) {
+        break;
+      }
+      m_numSleeping.fetch_add(1, std::memory_order_seq_cst);
+      m_wakeCondition.wait(lock, [this]() {
+        return m_numQueued.load(std::memory_order_seq_cst) > 0 ||
+               !is_running();
+      });
+      m_numSleeping.fetch_sub(1, std::memory_order_seq_cst);
+    }
+    t_currentPool = nullptr;
+  }
+
+  worker_task_t *find_task(size_t threadId) {
+    worker &self = m_workers[threadId];
+    if (auto *task = take_injected(self, task_priority::high)) {
+      return task;
+    }
+
+    if (auto task = self.m_deque.pop()) {
+      return *task;
+    }
+
+    if (auto *task = take_injected(self, task_priority::normal)) {
+      return task;
+    }
+
+    // Start from a random victim so that thieves don't all pile up on the
+    // same deque
+    size_t start = next_random(self) % m_numThreads;
+    for (size_t i = 0; i < m_numThreads; i++) {
+      size_t victim = (start + i) % m_numThreads;
+      if (victim == threadId) {
+        continue;
+      }
+      if (auto task = m_workers[victim].m_deque.steal()) {
+        return *task;
+      }
+    }
+    return take_injected(self, task_priority::low);
+  }
+
+  // Takes a fair share of the injection queue of the given priority, the first
+  // task is returned and the rest goes to the worker's own deque where it can
+  // be stolen without locking. Low priority tasks are taken one at a time, as
+  // the deque would run them ahead of normal priority ones.
+  worker_task_t *take_injected(worker &self, task_priority priority) {
+    const auto p = static_cast<size_t>(priority);
+    if (m_numInjected[p].load(std::memory_order_relaxed) == 0) {
+      return nullptr;
+    }
+    auto &queue = m_injectionQueues[p];
+    std::lock_guard<std::mutex> lock(m_injectionMutex);
+    if (queue.empty()) {
+      return nullptr;
+    }
+    size_t batch = priority == task_priority::low
+                       ? 1
+                       : std::max<size_t>(1, queue.size() / m_numThreads);
+    worker_task_t *first = queue.front();
+    queue.pop_front();
+    for (size_t i = 1; i < batch; i++) {
+      self.m_deque.push(queue.front());
+      queue.pop_front();
+    }
+    m_numInjected[p].fetch_sub(batch, std::memory_order_relaxed);
+    return first;
+  }
+
+  static uint64_t next_random(worker &w) noexcept {
+    // xorshift64
+    uint64_t x = w.m_rngState;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    w.m_rngState = x;
+    return x;
+  }
 
   std::atomic<bool> m_isRunning;
 
   const size_t m_numThreads;
+
+  std::vector<size_t> m_workersPerNode;
+
+  std::vector<worker> m_workers;
+
+  std::mutex m_injectionMutex;
+
+  static constexpr size_t num_priorities = 3;
+
+  // One per task_priority
+  std::deque<worker_task_t *> m_injectionQueues[num_priorities];
+
+  std::atomic<size_t> m_numInjected[num_priorities] = {};
+
+  // Tasks that are queued somewhere but haven't been picked up by a worker
+  std::atomic<size_t> m_numQueued{0};
+
+  // Tasks that haven't finished running yet
+  std::atomic<size_t> m_numPending{0};
+
+  std::mutex m_sleepMutex;
+
+  std::condition_variable m_wakeCondition;
+
+  std::atomic<size_t> m_numSleeping{0};
+
+  // Identifies the pool and worker the current thread belongs to, if any
+  static inline thread_local work_stealing_thread_pool *t_currentPool =
+      nullptr;
+  static inline thread_local size_t t_currentWorker = 0;
 };
 } // namespace detail
 
@@ -199,16 +657,44 @@ template <typename ThreadPoolT> class threadpool_interface {
 public:
   size_t num_threads() const noexcept { return threadpool.num_threads(); }
 
+  const std::vector<size_t> &workers_per_node() const noexcept {
+    return threadpool.workers_per_node();
+  }
+
+  size_t worker_node(size_t threadId) const noexcept {
+    return threadpool.worker_node(threadId);
+  }
+
   threadpool_interface() : threadpool() {}
 
-  auto schedule_task(worker_task_t &&task) {
-    auto workerTask = std::make_shared<std::packaged_task<void(size_t)>>(
-        [task](auto &&PH1) { return task(std::forward<decltype(PH1)>(PH1)); });
-    threadpool.schedule([=](size_t threadId) { (*workerTask)(threadId); });
-    return workerTask->get_future();
+  explicit threadpool_interface(std::vector<worker_placement> placement)
+      : threadpool(std::move(placement)) {}
+
+  // Schedules a task without tracking its completion, the task is
+  // responsible for signalling it.
+  void schedule(worker_task_t &&task,
+                task_priority priority = task_priority::normal) {
+    threadpool.schedule(std::move(task), priority);
+  }
+
+  // Like schedule, but `task` is only referenced, see
+  // work_stealing_thread_pool::schedule_borrowed.
+  void schedule_borrowed(const worker_task_t &task,
+                         task_priority priority = task_priority::normal) {
+    threadpool.schedule_borrowed(task, priority);
+  }
+
+  // Like schedule_borrowed, but schedules `count` runs of `task` at once.
+  void schedule_bulk(const worker_task_t &task, size_t count,
+                     task_priority priority = task_priority::normal) {
+    threadpool.schedule_bulk(task, count, priority);
   }
 };
 
-using threadpool_t = threadpool_interface<detail::simple_thread_pool>;
+using simple_threadpool_t = threadpool_interface<detail::simple_thread_pool>;
+using work_stealing_threadpool_t =
+    threadpool_interface<detail::work_stealing_thread_pool>;
+
+using threadpool_t = work_stealing_threadpool_t;
 
 } // namespace native_cpu
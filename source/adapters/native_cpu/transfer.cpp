@@ -0,0 +1,256 @@
+//===----------- transfer.cpp - Native CPU Adapter ------------------------===//
+//
+// Copyright (C) 2024 Intel Corporation
+//
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM
+// Exceptions. See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "transfer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+
+#include "latch.hpp"
+
+namespace native_cpu {
+
+namespace {
+
+// Runs `fn(begin, end)` over ranges of [0, numUnits) that are about
+// transfer_chunk_size bytes long. Idle workers help with the ranges, but the
+// calling thread claims them too, so the transfer completes even when every
+// worker is busy with a kernel.
+template <typename F>
+void for_each_chunk(threadpool_t &tp, size_t numUnits, size_t unitBytes,
+                    F &&fn) {
+  const size_t unitsPerChunk =
+      std::max<size_t>(1, transfer_chunk_size / std::max<size_t>(1, unitBytes));
+  const size_t numChunks = (numUnits + unitsPerChunk - 1) / unitsPerChunk;
+  if (numChunks < 2 || tp.num_threads() == 0) {
+    fn(size_t{0}, numUnits);
+    return;
+  }
+
+  struct job {
+    explicit job(size_t numChunks)
+        : done(static_cast<uint32_t>(numChunks)), numChunks(numChunks) {}
+
+    std::atomic<size_t> next{0};
+    latch done;
+    size_t numChunks;
+    size_t numUnits;
+    size_t unitsPerChunk;
+    // Only called for claimed chunks, which the calling thread waits for, so
+    // it may refer to the caller's stack.
+    std::function<void(size_t, size_t)> run;
+
+    bool runOne() {
+      const size_t chunk = next.fetch_add(1, std::memory_order_relaxed);
+      if (chunk >= numChunks)
+        return false;
+      const size_t begin = chunk * unitsPerChunk;
+      run(begin, std::min(numUnits, begin + unitsPerChunk));
+      done.count_down();
+      return true;
+    }
+  };
+
+  auto j = std::make_shared<job>(numChunks);
+  j->numUnits = numUnits;
+  j->unitsPerChunk = unitsPerChunk;
+  j->run = [&fn](size_t begin, size_t end) { fn(begin, end); };
+
+  const size_t numHelpers = std::min(numChunks - 1, tp.num_threads());
+  for (size_t i = 0; i < numHelpers; i++) {
+    tp.schedule([j](size_t) {
+      while (j->runOne())
+        ;
+    });
+  }
+  while (j->runOne())
+    ;
+  j->done.wait();
+}
+
+constexpr size_t block_size = 256;
+
+// Fills `size` bytes with the pattern, starting `phase` bytes into it. Small
+// patterns are first broadcast into a block of whole copies, which is then
+// stored with large copies instead of one copy per pattern.
+void fill_range(uint8_t *dst, size_t size, const uint8_t *pattern,
+                size_t patternSize, size_t phase) {
+  if (patternSize == 1) {
+    std::memset(dst, *pattern, size);
+    return;
+  }
+  if (patternSize > block_size) {
+    while (size) {
+      const size_t n = std::min(size, patternSize - phase);
+      std::memcpy(dst, pattern + phase, n);
+      dst += n;
+      size -= n;
+      phase = 0;
+    }
+    return;
+  }
+
+  alignas(64) uint8_t block[block_size];
+  const size_t blockLen = block_size - block_size % patternSize;
+  const size_t used = std::min(size, blockLen);
+  for (size_t i = 0, p = phase; i < used; i++) {
+    block[i] = pattern[p];
+    if (++p == patternSize)
+      p = 0;
+  }
+  if (blockLen == block_size) {
+    // Constant size copies of the block compile to vector stores
+    for (; size >= block_size; dst += block_size, size -= block_size)
+      std::memcpy(dst, block, block_size);
+  } else {
+    for (; size >= blockLen; dst += blockLen, size -= blockLen)
+      std::memcpy(dst, block, blockLen);
+  }
+  // The block holds whole patterns, so the remainder starts at the same phase
+  std::memcpy(dst, block, size);
+}
+
+} // namespace
+
+void copy_bytes(threadpool_t &tp, void *dst, const void *src, size_t size) {
+  if (dst == src || size == 0)
+    return;
+  auto *d = static_cast<uint8_t *>(dst);
+  auto *s = static_cast<const uint8_t *>(src);
+  if ((d < s && s < d + size) || (s < d && d < s + size)) {
+    std::memmove(d, s, size);
+    return;
+  }
+  for_each_chunk(tp, size, 1, [=](size_t begin, size_t end) {
+    std::memcpy(d + begin, s + begin, end - begin);
+  });
+}
+
+void copy_rect(threadpool_t &tp, void *dst, const void *src,
+               const rect_region &r) {
+  const bool contiguousRows =
+      r.srcRowPitch == r.rowBytes && r.dstRowPitch == r.rowBytes;
+  const size_t sliceBytes = r.rowBytes * r.height;
+  if (contiguousRows &&
+      (r.depth == 1 ||
+       (r.srcSlicePitch == sliceBytes && r.dstSlicePitch == sliceBytes))) {
+    copy_bytes(tp, dst, src, sliceBytes * r.depth);
+    return;
+  }
+
+  auto *d = static_cast<uint8_t *>(dst);
+  auto *s = static_cast<const uint8_t *>(src);
+  for_each_chunk(tp, r.height * r.depth, r.rowBytes,
+                 [=](size_t begin, size_t end) {
+                   for (size_t row = begin; row < end; row++) {
+                     const size_t z = row / r.height;
+                     const size_t y = row % r.height;
+                     std::memmove(d + z * r.dstSlicePitch + y * r.dstRowPitch,
+                                  s + z * r.srcSlicePitch + y * r.srcRowPitch,
+                                  r.rowBytes);
+                   }
+                 });
+}
+
+void fill_bytes(threadpool_t &tp, void *dst, size_t size, const void *pattern,
+                size_t patternSize) {
+  auto *d = static_cast<uint8_t *>(dst);
+  auto *p = static_cast<const uint8_t *>(pattern);
+  for_each_chunk(tp, size, 1, [=](size_t begin, size_t end) {
+    fill_range(d + begin, end - begin, p, patternSize, begin % patternSize);
+  });
+}
+
+void fill_2d(threadpool_t &tp, void *dst, size_t pitch, size_t width,
+             size_t height, const void *pattern, size_t patternSize) {
+  if (pitch == width) {
+    fill_bytes(tp, dst, width * height, pattern, patternSize);
+    return;
+  }
+  auto *d = static_cast<uint8_t *>(dst);
+  auto *p = static_cast<const uint8_t *>(pattern);
+  for_each_chunk(tp, height, width, [=](size_t begin, size_t end) {
+    for (size_t row = begin; row < end; row++)
+      fill_range(d + row * pitch, width, p, patternSize,
+                 (row * width) % patternSize);
+  });
+}
+
+image_layout image_layout::linear(size_t elementSize, size_t width,
+                                  size_t height, size_t depth, size_t rowPitch,
+                                  size_t slicePitch) {
+  image_layout layout;
+  layout.elementSize = elementSize;
+  layout.rowPitch = rowPitch;
+  layout.slicePitch = slicePitch;
+  // The last row and slice end with the last element rather than the pitch,
+  // since host data may not be padded after it.
+  layout.size = (depth - 1) * slicePitch + (height - 1) * rowPitch +
+                width * elementSize;
+  return layout;
+}
+
+image_layout image_layout::tiled(size_t elementSize, size_t width,
+                                 size_t height, size_t depth) {
+  // Tiles are 4KiB at most: rows of 256 bytes, 16 rows high for 2D images and
+  // 4 x 4 rows for 3D ones. They shrink to fit small images.
+  constexpr size_t tileRowBytes = 256;
+  image_layout layout;
+  layout.isTiled = true;
+  layout.elementSize = elementSize;
+  layout.tileWidth =
+      std::min(width, std::max<size_t>(1, tileRowBytes / elementSize));
+  layout.tileHeight = std::min<size_t>(height, depth > 1 ? 4 : 16);
+  layout.tileDepth = std::min<size_t>(depth, 4);
+  layout.rowPitch = layout.tileWidth * elementSize;
+  layout.slicePitch = layout.rowPitch * layout.tileHeight;
+  layout.tileBytes = layout.slicePitch * layout.tileDepth;
+  layout.tilesPerRow = (width + layout.tileWidth - 1) / layout.tileWidth;
+  layout.tilesPerSlice = layout.tilesPerRow *
+                         ((height + layout.tileHeight - 1) / layout.tileHeight);
+  layout.size = layout.tileBytes * layout.tilesPerSlice *
+                ((depth + layout.tileDepth - 1) / layout.tileDepth);
+  return layout;
+}
+
+void copy_image(threadpool_t &tp, void *dst, const image_layout &dstLayout,
+                const size_t dstOrigin[3], const void *src,
+                const image_layout &srcLayout, const size_t srcOrigin[3],
+                const size_t region[3]) {
+  const size_t elementSize = srcLayout.elementSize;
+  const size_t width = region[0];
+  const size_t height = region[1];
+  auto *d = static_cast<uint8_t *>(dst);
+  auto *s = static_cast<const uint8_t *>(src);
+  const size_t dx = dstOrigin[0], dy = dstOrigin[1], dz = dstOrigin[2];
+  const size_t sx = srcOrigin[0], sy = srcOrigin[1], sz = srcOrigin[2];
+  for_each_chunk(
+      tp, height * region[2], width * elementSize,
+      [&, d, s](size_t begin, size_t end) {
+        for (size_t row = begin; row < end; row++) {
+          const size_t y = row % height;
+          const size_t z = row / height;
+          for (size_t x = 0; x < width;) {
+            const size_t n = std::min({width - x, dstLayout.run(dx + x),
+                                       srcLayout.run(sx + x)});
+            std::memcpy(d + dstLayout.offset(dx + x, dy + y, dz + z),
+                        s + srcLayout.offset(sx + x, sy + y, sz + z),
+                        n * elementSize);
+            x += n;
+          }
+        }
+      });
+}
+
+} // namespace native_cpu
@@ -0,0 +1,107 @@
+//===----------- transfer.hpp - Native CPU Adapter ------------------------===//
+//
+// Copyright (C) 2024 Intel Corporation
+//
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM
+// Exceptions. See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "threadpool.hpp"
+
+namespace native_cpu {
+
+// Copies and fills of at least twice this size are split across the thread
+// pool, smaller ones don't make up for the cost of waking up workers.
+constexpr size_t transfer_chunk_size = 256 * 1024;
+
+// A 3D region of `depth` slices of `height` rows of `rowBytes` bytes each, at
+// given pitches in the source and the destination.
+struct rect_region {
+  size_t rowBytes;
+  size_t height;
+  size_t depth;
+  size_t srcRowPitch;
+  size_t srcSlicePitch;
+  size_t dstRowPitch;
+  size_t dstSlicePitch;
+};
+
+// Copies `size` bytes, the ranges may overlap.
+void copy_bytes(threadpool_t &tp, void *dst, const void *src, size_t size);
+
+// Copies the region whole rows at a time, `dst` and `src` point at its first
+// byte in each memory.
+void copy_rect(threadpool_t &tp, void *dst, const void *src,
+               const rect_region &region);
+
+// Fills `size` bytes with copies of the `patternSize` bytes long pattern.
+void fill_bytes(threadpool_t &tp, void *dst, size_t size, const void *pattern,
+                size_t patternSize);
+
+// Fills `height` rows of `width` bytes, `pitch` bytes apart. The pattern runs
+// on from one row to the next as if the rows were contiguous.
+void fill_2d(threadpool_t &tp, void *dst, size_t pitch, size_t width,
+             size_t height, const void *pattern, size_t patternSize);
+
+// Where the elements of an image live in memory. Tiled images are split into
+// tiles of about a page, each holding a small block of the image whose rows
+// are contiguous, so that neighbouring rows and slices share pages and cache
+// lines. Linear images, such as host data, are rows of elements at given
+// pitches.
+struct image_layout {
+  // A linear layout for an image of the given size in elements, with
+  // pitches in bytes.
+  static image_layout linear(size_t elementSize, size_t width, size_t height,
+                             size_t depth, size_t rowPitch, size_t slicePitch);
+
+  // A tiled layout for an image of the given size in elements.
+  static image_layout tiled(size_t elementSize, size_t width, size_t height,
+                            size_t depth);
+
+  // Byte offset of element (x, y, z).
+  size_t offset(size_t x, size_t y, size_t z) const {
+    if (!isTiled)
+      return z * slicePitch + y * rowPitch + x * elementSize;
+    const size_t tile = (z / tileDepth) * tilesPerSlice +
+                        (y / tileHeight) * tilesPerRow + x / tileWidth;
+    return tile * tileBytes + (z % tileDepth) * slicePitch +
+           (y % tileHeight) * rowPitch + (x % tileWidth) * elementSize;
+  }
+
+  // Number of elements from (x, y, z) onwards that are contiguous in memory.
+  size_t run(size_t x) const {
+    return isTiled ? tileWidth - x % tileWidth : SIZE_MAX;
+  }
+
+  bool isTiled = false;
+  size_t elementSize = 0;
+  // Pitches within a tile, or within the whole image if it is linear
+  size_t rowPitch = 0;
+  size_t slicePitch = 0;
+  // Tiled images only, dimensions are in elements
+  size_t tileWidth = 1;
+  size_t tileHeight = 1;
+  size_t tileDepth = 1;
+  size_t tileBytes = 0;
+  size_t tilesPerRow = 0;
+  size_t tilesPerSlice = 0;
+  // Bytes spanned by the image
+  size_t size = 0;
+};
+
+// Copies a `width` x `height` x `depth` region of elements between two images,
+// starting at the given element in each. Rows are split into the runs that
+// are contiguous in both images and copied with memcpy, and are spread over
+// the thread pool.
+void copy_image(threadpool_t &tp, void *dst, const image_layout &dstLayout,
+                const size_t dstOrigin[3], const void *src,
+                const image_layout &srcLayout, const size_t srcOrigin[3],
+                const size_t region[3]);
+
+} // namespace native_cpu
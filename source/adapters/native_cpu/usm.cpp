@@ -13,7 +13,23 @@
 
 #include "common.hpp"
 #include "context.hpp"
+#include "logger/ur_logger.hpp"
+#include "usm.hpp"
+#include "ur_util.hpp"
+#include "virtual_mem.hpp"
+
 #include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 
 namespace umf {
 ur_result_t getProviderNativeError(const char *, int32_t) {
@@ -21,28 +37,335 @@ ur_result_t getProviderNativeError(const char *, int32_t) {
 }
 } // namespace umf
 
+namespace native_cpu {
+
+usm::DisjointPoolAllConfigs InitializeDisjointPoolConfig() {
+  int PoolTrace = 0;
+  if (auto TraceVal = ur_getenv("UR_NATIVE_CPU_USM_ALLOCATOR_TRACE"))
+    PoolTrace = std::atoi(TraceVal->c_str());
+
+  if (auto ConfigVal = ur_getenv("UR_NATIVE_CPU_USM_ALLOCATOR"))
+    return usm::parseDisjointPoolConfig(*ConfigVal, PoolTrace);
+
+  return usm::DisjointPoolAllConfigs(PoolTrace);
+}
+
+static size_t getPageSize() {
+#ifdef _WIN32
+  SYSTEM_INFO Info;
+  GetSystemInfo(&Info);
+  static const size_t PageSize = Info.dwPageSize;
+#else
+  static const size_t PageSize = sysconf(_SC_PAGESIZE);
+#endif
+  return PageSize;
+}
+
+static size_t roundUp(size_t Size, size_t Align) {
+  return (Size + Align - 1) / Align * Align;
+}
+
+// How allocations of at least a huge page are backed.
+static usm_backing getLargeAllocBacking() {
+  static const usm_backing Backing = [] {
+    auto Value = ur_getenv("UR_NATIVE_CPU_USM_HUGE_PAGES");
+    if (Value && *Value == "0")
+      return usm_backing::heap;
+    if (Value && *Value == "hugetlb")
+      return usm_backing::hugetlb;
+    return usm_backing::transparent_huge_pages;
+  }();
+  return Backing;
+}
+
+static const char *getBackingName(usm_backing Backing) {
+  switch (Backing) {
+  case usm_backing::heap:
+    return "heap";
+  case usm_backing::transparent_huge_pages:
+    return "transparent huge pages";
+  case usm_backing::hugetlb:
+    return "hugetlbfs";
+  }
+  return "unknown";
+}
+
+umf_result_t usm_memory_provider::initialize(ur_device_handle_t Dev) {
+  Device = Dev;
+  return UMF_RESULT_SUCCESS;
+}
+
+// Maps Size bytes aligned to at least a huge page, or returns nullptr.
+void *usm_memory_provider::map(size_t Size, size_t Align,
+                               usm_backing Backing) {
+#ifdef __linux__
+  const size_t HugePage = virtual_mem_huge_page_size();
+  Align = std::max(Align, HugePage);
+  Size = roundUp(Size, HugePage);
+  mapping Mapping{nullptr, Size};
+  void *Ptr = nullptr;
+  if (Backing == usm_backing::hugetlb) {
+    // Explicit huge pages are naturally aligned, but only to their own size
+    if (Align > HugePage)
+      return nullptr;
+    Ptr = mmap(nullptr, Size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (Ptr == MAP_FAILED)
+      return nullptr;
+    Mapping.base = Ptr;
+  } else {
+    // Over-allocate and trim the ends so that the range is aligned, the
+    // kernel can only back aligned ranges with huge pages.
+    const size_t Mapped = Size + Align;
+    void *Base = mmap(nullptr, Mapped, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (Base == MAP_FAILED)
+      return nullptr;
+    const auto Addr = reinterpret_cast<uintptr_t>(Base);
+    const uintptr_t Aligned = roundUp(Addr, Align);
+    if (Aligned > Addr)
+      munmap(Base, Aligned - Addr);
+    if (Addr + Mapped > Aligned + Size)
+      munmap(reinterpret_cast<void *>(Aligned + Size),
+             Addr + Mapped - (Aligned + Size));
+    Ptr = reinterpret_cast<void *>(Aligned);
+    madvise(Ptr, Size, MADV_HUGEPAGE);
+    Mapping.base = Ptr;
+  }
+  logger::debug("native_cpu: mapped {} bytes of USM memory at {} backed by {}",
+                Size, Ptr, getBackingName(Backing));
+  std::lock_guard<std::mutex> Lock(MappingsMutex);
+  Mappings.emplace(Ptr, Mapping);
+  return Ptr;
+#else
+  std::ignore = Size;
+  std::ignore = Align;
+  std::ignore = Backing;
+  return nullptr;
+#endif
+}
+
+umf_result_t usm_memory_provider::alloc(size_t Size, size_t Align,
+                                        void **Ptr) {
+  *Ptr = nullptr;
+  const usm_backing Backing = getLargeAllocBacking();
+  if (Backing != usm_backing::heap && Size >= virtual_mem_huge_page_size()) {
+    if (Backing == usm_backing::hugetlb)
+      *Ptr = map(Size, Align, usm_backing::hugetlb);
+    if (!*Ptr)
+      *Ptr = map(Size, Align, usm_backing::transparent_huge_pages);
+  }
+  if (*Ptr) {
+    if (Device && Device->isSubDevice())
+      prefer_numa_node(*Ptr, Size, Device->Nodes[0].id);
+    return UMF_RESULT_SUCCESS;
+  }
+
+  // Keep slabs page aligned, which is what we report as the minimum page
+  // size.
+  Align = std::max(Align, getPageSize());
+  Size = (Size + Align - 1) & ~(Align - 1);
+#ifdef _MSC_VER
+  *Ptr = _aligned_malloc(Size, Align);
+#else
+  *Ptr = std::aligned_alloc(Align, Size);
+#endif
+  if (!*Ptr)
+    return UMF_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+  // Memory of a context on a sub-device goes to the sub-device's node, even
+  // if the host is the first to touch it.
+  if (Device && Device->isSubDevice())
+    prefer_numa_node(*Ptr, Size, Device->Nodes[0].id);
+  return UMF_RESULT_SUCCESS;
+}
+
+umf_result_t usm_memory_provider::free(void *Ptr, size_t) {
+#ifdef __linux__
+  {
+    std::unique_lock<std::mutex> Lock(MappingsMutex);
+    auto It = Mappings.find(Ptr);
+    if (It != Mappings.end()) {
+      const mapping Mapping = It->second;
+      Mappings.erase(It);
+      Lock.unlock();
+      munmap(Mapping.base, Mapping.size);
+      return UMF_RESULT_SUCCESS;
+    }
+  }
+#endif
+#ifdef _MSC_VER
+  _aligned_free(Ptr);
+#else
+  std::free(Ptr);
+#endif
+  return UMF_RESULT_SUCCESS;
+}
+
+void usm_memory_provider::get_last_native_error(const char **ErrMsg,
+                                                int32_t *ErrCode) {
+  // Failures are reported with generic UMF errors only
+  if (ErrMsg)
+    *ErrMsg = nullptr;
+  *ErrCode = UR_RESULT_ERROR_UNKNOWN;
+}
+
+umf_result_t usm_memory_provider::get_min_page_size(void *,
+                                                    size_t *PageSize) {
+  *PageSize = getPageSize();
+  return UMF_RESULT_SUCCESS;
+}
+
+umf_result_t usm_memory_provider::get_recommended_page_size(size_t Size,
+                                                            size_t *PageSize) {
+  const size_t HugePage = virtual_mem_huge_page_size();
+  *PageSize = getLargeAllocBacking() != usm_backing::heap && Size >= HugePage
+                  ? HugePage
+                  : getPageSize();
+  return UMF_RESULT_SUCCESS;
+}
+
+#ifdef __linux__
+// Applies `Advice` to the pages [Ptr, Ptr + Size) lies in.
+static int advisePages(const void *Ptr, size_t Size, int Advice) {
+  const size_t PageSize = getPageSize();
+  const auto Addr = reinterpret_cast<uintptr_t>(Ptr);
+  const uintptr_t Begin = Addr / PageSize * PageSize;
+  const uintptr_t End = roundUp(Addr + Size, PageSize);
+  return madvise(reinterpret_cast<void *>(Begin), End - Begin, Advice);
+}
+#endif
+
+void usm_prefetch(const void *Ptr, size_t Size) {
+#ifdef __linux__
+  // Memory only migrates between the host and itself, so a prefetch faults
+  // the pages in ahead of the kernels that use them.
+#ifdef MADV_POPULATE_WRITE
+  if (advisePages(Ptr, Size, MADV_POPULATE_WRITE) == 0)
+    return;
+#endif
+  advisePages(Ptr, Size, MADV_WILLNEED);
+#else
+  std::ignore = Ptr;
+  std::ignore = Size;
+#endif
+}
+
+void usm_advise(const void *Ptr, size_t Size, ur_usm_advice_flags_t Advice) {
+#ifdef __linux__
+  if (Advice & UR_USM_ADVICE_FLAG_DEFAULT)
+    advisePages(Ptr, Size, MADV_NORMAL);
+  if (Advice & (UR_USM_ADVICE_FLAG_SET_ACCESSED_BY_HOST |
+                UR_USM_ADVICE_FLAG_SET_PREFERRED_LOCATION_HOST |
+                UR_USM_ADVICE_FLAG_BIAS_CACHED))
+    advisePages(Ptr, Size, MADV_WILLNEED);
+#ifdef MADV_COLD
+  // Unlike MADV_DONTNEED this keeps the contents of the pages
+  if (Advice & UR_USM_ADVICE_FLAG_BIAS_UNCACHED)
+    advisePages(Ptr, Size, MADV_COLD);
+#endif
+#else
+  std::ignore = Ptr;
+  std::ignore = Size;
+  std::ignore = Advice;
+#endif
+}
+
+} // namespace native_cpu
+
+ur_usm_pool_handle_t_::ur_usm_pool_handle_t_(ur_context_handle_t Context,
+                                             const ur_usm_pool_desc_t *PoolDesc)
+    : Context{Context},
+      DisjointPoolConfigs(native_cpu::InitializeDisjointPoolConfig()),
+      ZeroInitialize(PoolDesc->flags & UR_USM_POOL_FLAG_ZERO_INITIALIZE_BLOCK) {
+  const void *pNext = PoolDesc->pNext;
+  while (pNext != nullptr) {
+    const ur_base_desc_t *BaseDesc = static_cast<const ur_base_desc_t *>(pNext);
+    switch (BaseDesc->stype) {
+    case UR_STRUCTURE_TYPE_USM_POOL_LIMITS_DESC: {
+      const ur_usm_pool_limits_desc_t *Limits =
+          reinterpret_cast<const ur_usm_pool_limits_desc_t *>(BaseDesc);
+      for (auto &config : DisjointPoolConfigs.Configs) {
+        config.MaxPoolableSize = Limits->maxPoolableSize;
+        config.SlabMinSize = Limits->minDriverAllocSize;
+      }
+      break;
+    }
+    default:
+      throw UR_RESULT_ERROR_INVALID_ARGUMENT;
+    }
+    pNext = BaseDesc->pNext;
+  }
+
+  auto makePool = [&](usm::DisjointPoolMemType Type) {
+    auto [ProviderRet, Provider] =
+        umf::memoryProviderMakeUnique<native_cpu::usm_memory_provider>(
+            Context->_device);
+    if (ProviderRet != UMF_RESULT_SUCCESS)
+      throw umf::umf2urResult(ProviderRet);
+    auto [PoolRet, Pool] = umf::poolMakeUniqueFromOps(
+        umfDisjointPoolOps(), std::move(Provider),
+        &DisjointPoolConfigs.Configs[Type]);
+    if (PoolRet != UMF_RESULT_SUCCESS)
+      throw umf::umf2urResult(PoolRet);
+    return std::move(Pool);
+  };
+  HostMemPool = makePool(usm::DisjointPoolMemType::Host);
+  DeviceMemPool = makePool(usm::DisjointPoolMemType::Device);
+  SharedMemPool = makePool(usm::DisjointPoolMemType::Shared);
+}
+
+umf_memory_pool_handle_t
+ur_usm_pool_handle_t_::getUMFPool(ur_usm_type_t Type) const {
+  switch (Type) {
+  case UR_USM_TYPE_HOST:
+    return HostMemPool.get();
+  case UR_USM_TYPE_DEVICE:
+    return DeviceMemPool.get();
+  default:
+    return SharedMemPool.get();
+  }
+}
+
+ur_result_t ur_context_handle_t_::add_alloc(uint32_t alignment,
+                                            ur_usm_type_t type, size_t size,
+                                            ur_usm_pool_handle_t pool,
+                                            void **ppMem) {
+  ur_usm_pool_handle_t_ *Pool = pool ? pool : default_pool.get();
+  umf_memory_pool_handle_t UMFPool = Pool->getUMFPool(type);
+  void *ptr = umfPoolAlignedMalloc(UMFPool, size, alignment);
+  if (!ptr)
+    return umf::umf2urResult(umfPoolGetLastAllocationError(UMFPool));
+  if (Pool->ZeroInitialize)
+    std::memset(ptr, 0, size);
+  allocations.insert({type, ptr, size, _device, pool, UMFPool});
+  *ppMem = ptr;
+  return UR_RESULT_SUCCESS;
+}
+
+ur_result_t ur_context_handle_t_::remove_alloc(void *ptr) {
+  const native_cpu::usm_alloc_info info = allocations.erase(ptr);
+  UR_ASSERT(info.type != UR_USM_TYPE_UNKNOWN,
+            UR_RESULT_ERROR_INVALID_MEM_OBJECT);
+  return umf::umf2urResult(umfPoolFree(info.umf_pool, ptr));
+}
+
 static ur_result_t alloc_helper(ur_context_handle_t hContext,
                                 const ur_usm_desc_t *pUSMDesc, size_t size,
-                                void **ppMem, ur_usm_type_t type) {
+                                void **ppMem, ur_usm_type_t type,
+                                ur_usm_pool_handle_t pool) {
   auto alignment = (pUSMDesc && pUSMDesc->align) ? pUSMDesc->align : 1u;
   UR_ASSERT(isPowerOf2(alignment), UR_RESULT_ERROR_UNSUPPORTED_ALIGNMENT);
   UR_ASSERT(ppMem, UR_RESULT_ERROR_INVALID_NULL_POINTER);
   // TODO: Check Max size when UR_DEVICE_INFO_MAX_MEM_ALLOC_SIZE is implemented
   UR_ASSERT(size > 0, UR_RESULT_ERROR_INVALID_USM_SIZE);
 
-  auto *ptr = hContext->add_alloc(alignment, type, size, nullptr);
-  UR_ASSERT(ptr != nullptr, UR_RESULT_ERROR_OUT_OF_RESOURCES);
-  *ppMem = ptr;
-
-  return UR_RESULT_SUCCESS;
+  return hContext->add_alloc(alignment, type, size, pool, ppMem);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL
 urUSMHostAlloc(ur_context_handle_t hContext, const ur_usm_desc_t *pUSMDesc,
                ur_usm_pool_handle_t pool, size_t size, void **ppMem) {
-  std::ignore = pool;
-
-  return alloc_helper(hContext, pUSMDesc, size, ppMem, UR_USM_TYPE_HOST);
+  return alloc_helper(hContext, pUSMDesc, size, ppMem, UR_USM_TYPE_HOST, pool);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL
@@ -50,9 +373,9 @@ urUSMDeviceAlloc(ur_context_handle_t hContext, ur_device_handle_t hDevice,
                  const ur_usm_desc_t *pUSMDesc, ur_usm_pool_handle_t pool,
                  size_t size, void **ppMem) {
   std::ignore = hDevice;
-  std::ignore = pool;
 
-  return alloc_helper(hContext, pUSMDesc, size, ppMem, UR_USM_TYPE_DEVICE);
+  return alloc_helper(hContext, pUSMDesc, size, ppMem, UR_USM_TYPE_DEVICE,
+                      pool);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL
@@ -60,9 +383,9 @@ urUSMSharedAlloc(ur_context_handle_t hContext, ur_device_handle_t hDevice,
                  const ur_usm_desc_t *pUSMDesc, ur_usm_pool_handle_t pool,
                  size_t size, void **ppMem) {
   std::ignore = hDevice;
-  std::ignore = pool;
 
-  return alloc_helper(hContext, pUSMDesc, size, ppMem, UR_USM_TYPE_SHARED);
+  return alloc_helper(hContext, pUSMDesc, size, ppMem, UR_USM_TYPE_SHARED,
+                      pool);
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urUSMFree(ur_context_handle_t hContext,
@@ -83,16 +406,14 @@ urUSMGetMemAllocInfo(ur_context_handle_t hContext, const void *pMem,
 
   UR_ASSERT(pMem != nullptr, UR_RESULT_ERROR_INVALID_NULL_POINTER);
   UrReturnHelper ReturnValue(propSize, pPropValue, pPropSizeRet);
-  if (propName == UR_USM_ALLOC_INFO_BASE_PTR) {
-    // TODO: logic to compute base ptr given ptr
-    DIE_NO_IMPLEMENTATION;
-  }
 
-  const native_cpu::usm_alloc_info &alloc_info =
+  const native_cpu::usm_alloc_info alloc_info =
       hContext->get_alloc_info_entry(pMem);
   switch (propName) {
   case UR_USM_ALLOC_INFO_TYPE:
     return ReturnValue(alloc_info.type);
+  case UR_USM_ALLOC_INFO_BASE_PTR:
+    return ReturnValue(alloc_info.base_ptr);
   case UR_USM_ALLOC_INFO_SIZE:
     return ReturnValue(alloc_info.size);
   case UR_USM_ALLOC_INFO_DEVICE:
@@ -108,37 +429,49 @@ urUSMGetMemAllocInfo(ur_context_handle_t hContext, const void *pMem,
 UR_APIEXPORT ur_result_t UR_APICALL
 urUSMPoolCreate(ur_context_handle_t hContext, ur_usm_pool_desc_t *pPoolDesc,
                 ur_usm_pool_handle_t *ppPool) {
-  std::ignore = hContext;
-  std::ignore = pPoolDesc;
-  std::ignore = ppPool;
-
-  DIE_NO_IMPLEMENTATION;
+  try {
+    *ppPool = new ur_usm_pool_handle_t_(hContext, pPoolDesc);
+  } catch (ur_result_t Err) {
+    return Err;
+  } catch (const std::bad_alloc &) {
+    return UR_RESULT_ERROR_OUT_OF_HOST_MEMORY;
+  }
+  // Released with the pool, which frees its allocations through the context
+  hContext->incrementReferenceCount();
+  return UR_RESULT_SUCCESS;
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL
 urUSMPoolRetain(ur_usm_pool_handle_t pPool) {
-  std::ignore = pPool;
-
-  DIE_NO_IMPLEMENTATION;
+  pPool->incrementReferenceCount();
+  return UR_RESULT_SUCCESS;
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL
 urUSMPoolRelease(ur_usm_pool_handle_t pPool) {
-  std::ignore = pPool;
-
-  DIE_NO_IMPLEMENTATION;
+  if (pPool->decrementReferenceCount() > 0)
+    return UR_RESULT_SUCCESS;
+  // Destroying the pool frees the allocations that are still live.
+  ur_context_handle_t Context = pPool->Context;
+  Context->remove_pool_allocs(pPool);
+  delete pPool;
+  decrementOrDelete(Context);
+  return UR_RESULT_SUCCESS;
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL
 urUSMPoolGetInfo(ur_usm_pool_handle_t hPool, ur_usm_pool_info_t propName,
                  size_t propSize, void *pPropValue, size_t *pPropSizeRet) {
-  std::ignore = hPool;
-  std::ignore = propName;
-  std::ignore = propSize;
-  std::ignore = pPropValue;
-  std::ignore = pPropSizeRet;
+  UrReturnHelper ReturnValue(propSize, pPropValue, pPropSizeRet);
 
-  DIE_NO_IMPLEMENTATION;
+  switch (propName) {
+  case UR_USM_POOL_INFO_REFERENCE_COUNT:
+    return ReturnValue(hPool->getReferenceCount());
+  case UR_USM_POOL_INFO_CONTEXT:
+    return ReturnValue(hPool->Context);
+  default:
+    return UR_RESULT_ERROR_UNSUPPORTED_ENUMERATION;
+  }
 }
 
 UR_APIEXPORT ur_result_t UR_APICALL urUSMImportExp(ur_context_handle_t Context,
@@ -0,0 +1,109 @@
+//===------------- usm.hpp - NATIVE CPU Adapter ---------------------------===//
+//
+// Copyright (C) 2024 Intel Corporation
+//
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM
+// Exceptions. See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "common.hpp"
+
+#include <mutex>
+#include <unordered_map>
+#include <umf_helpers.hpp>
+#include <umf_pools/disjoint_pool_config_parser.hpp>
+
+namespace native_cpu {
+
+// Reads the pool configuration from UR_NATIVE_CPU_USM_ALLOCATOR, using the
+// same syntax as the other adapters.
+usm::DisjointPoolAllConfigs InitializeDisjointPoolConfig();
+
+// How the memory handed out by usm_memory_provider is backed.
+enum class usm_backing {
+  // The C heap, used for small allocations and pool slabs
+  heap,
+  // An anonymous mapping advised to use transparent huge pages
+  transparent_huge_pages,
+  // An explicit mapping of pages from the hugetlbfs pool
+  hugetlb,
+};
+
+// Hands out host memory to the UMF pools. All USM types live in host memory,
+// they only differ in what urUSMGetMemAllocInfo reports.
+//
+// Allocations of at least a huge page bypass the heap and are mapped directly
+// so that they can be backed by huge pages, which cuts down on TLB misses
+// when kernels sweep over large buffers. UR_NATIVE_CPU_USM_HUGE_PAGES selects
+// the policy: "0" keeps everything on the heap, "hugetlb" maps explicit huge
+// pages and falls back to transparent ones when none are reserved, and by
+// default transparent huge pages are used.
+class usm_memory_provider {
+public:
+  umf_result_t initialize(ur_device_handle_t Device);
+  umf_result_t alloc(size_t Size, size_t Align, void **Ptr);
+  umf_result_t free(void *Ptr, size_t Size);
+  void get_last_native_error(const char **ErrMsg, int32_t *ErrCode);
+  umf_result_t get_min_page_size(void *, size_t *PageSize);
+  umf_result_t get_recommended_page_size(size_t, size_t *PageSize);
+  umf_result_t purge_lazy(void *, size_t) {
+    return UMF_RESULT_ERROR_NOT_SUPPORTED;
+  }
+  umf_result_t purge_force(void *, size_t) {
+    return UMF_RESULT_ERROR_NOT_SUPPORTED;
+  }
+  umf_result_t allocation_merge(void *, void *, size_t) {
+    return UMF_RESULT_ERROR_UNKNOWN;
+  }
+  umf_result_t allocation_split(void *, size_t, size_t) {
+    return UMF_RESULT_ERROR_UNKNOWN;
+  }
+  const char *get_name() { return "NativeCPUMemoryProvider"; }
+
+private:
+  struct mapping {
+    void *base;
+    size_t size;
+  };
+
+  void *map(size_t Size, size_t Align, usm_backing Backing);
+
+  ur_device_handle_t Device = nullptr;
+
+  // The allocations that were mapped rather than taken from the heap, by the
+  // address handed out.
+  std::mutex MappingsMutex;
+  std::unordered_map<void *, mapping> Mappings;
+};
+
+// Applies USM prefetch and advice hints to the pages of [Ptr, Ptr + Size).
+// They are only hints, so failures are ignored.
+void usm_prefetch(const void *Ptr, size_t Size);
+void usm_advise(const void *Ptr, size_t Size, ur_usm_advice_flags_t Advice);
+
+} // namespace native_cpu
+
+struct ur_usm_pool_handle_t_ : RefCounted {
+  // Throws a ur_result_t if the descriptor is invalid or a pool can't be
+  // created.
+  ur_usm_pool_handle_t_(ur_context_handle_t Context,
+                        const ur_usm_pool_desc_t *PoolDesc);
+
+  // Returns the UMF pool that serves allocations of the given type.
+  umf_memory_pool_handle_t getUMFPool(ur_usm_type_t Type) const;
+
+  ur_context_handle_t Context;
+
+  usm::DisjointPoolAllConfigs DisjointPoolConfigs;
+
+  // Set by UR_USM_POOL_FLAG_ZERO_INITIALIZE_BLOCK
+  const bool ZeroInitialize;
+
+  umf::pool_unique_handle_t HostMemPool;
+  umf::pool_unique_handle_t DeviceMemPool;
+  umf::pool_unique_handle_t SharedMemPool;
+};
@@ -8,47 +8,196 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "virtual_mem.hpp"
 #include "common.hpp"
 #include "context.hpp"
 #include "physical_mem.hpp"
 
+#include <fstream>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace native_cpu {
+
+size_t virtual_mem_page_size() {
+#ifdef __linux__
+  static const size_t size = sysconf(_SC_PAGESIZE);
+  return size;
+#else
+  return 4096;
+#endif
+}
+
+size_t virtual_mem_huge_page_size() {
+  static const size_t size = [] {
+    size_t pmdSize = 0;
+    std::ifstream("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size") >>
+        pmdSize;
+    return pmdSize ? pmdSize : size_t{2} << 20;
+  }();
+  return size;
+}
+
+} // namespace native_cpu
+
+namespace {
+
+uintptr_t toAddr(const void *ptr) { return reinterpret_cast<uintptr_t>(ptr); }
+
+#ifdef __linux__
+int getProtection(ur_virtual_mem_access_flags_t flags) {
+  if (flags & UR_VIRTUAL_MEM_ACCESS_FLAG_READ_WRITE)
+    return PROT_READ | PROT_WRITE;
+  if (flags & UR_VIRTUAL_MEM_ACCESS_FLAG_READ_ONLY)
+    return PROT_READ;
+  return PROT_NONE;
+}
+
+// Reserved ranges are inaccessible anonymous mappings that don't count
+// against the commit limit, so that nothing else gets mapped there.
+void *reserve(void *addr, size_t size, int extraFlags) {
+  return mmap(addr, size, PROT_NONE,
+              MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | extraFlags, -1, 0);
+}
+#endif
+
+} // namespace
+
 UR_APIEXPORT ur_result_t UR_APICALL urVirtualMemGranularityGetInfo(
-    ur_context_handle_t, ur_device_handle_t, ur_virtual_mem_granularity_info_t,
-    size_t, void *, size_t *) {
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+    ur_context_handle_t hContext, ur_device_handle_t hDevice,
+    ur_virtual_mem_granularity_info_t propName, size_t propSize,
+    void *pPropValue, size_t *pPropSizeRet) {
+  UR_ASSERT(hContext, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(hDevice, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+
+  UrReturnHelper ReturnValue(propSize, pPropValue, pPropSizeRet);
+  switch (propName) {
+  case UR_VIRTUAL_MEM_GRANULARITY_INFO_MINIMUM:
+    return ReturnValue(native_cpu::virtual_mem_page_size());
+  case UR_VIRTUAL_MEM_GRANULARITY_INFO_RECOMMENDED:
+    return ReturnValue(native_cpu::virtual_mem_huge_page_size());
+  default:
+    return UR_RESULT_ERROR_INVALID_ENUMERATION;
+  }
 }
 
-UR_APIEXPORT ur_result_t UR_APICALL urVirtualMemReserve(ur_context_handle_t,
-                                                        const void *, size_t,
-                                                        void **) {
+UR_APIEXPORT ur_result_t UR_APICALL
+urVirtualMemReserve(ur_context_handle_t hContext, const void *pStart,
+                    size_t size, void **ppStart) {
+  UR_ASSERT(hContext, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(ppStart, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+#ifdef __linux__
+  // pStart is only a hint
+  void *start = reserve(const_cast<void *>(pStart), size, 0);
+  if (start == MAP_FAILED)
+    return native_cpu::virtual_mem_error(errno);
+  *ppStart = start;
+  return UR_RESULT_SUCCESS;
+#else
+  std::ignore = pStart;
+  std::ignore = size;
   return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+#endif
 }
 
-UR_APIEXPORT ur_result_t UR_APICALL urVirtualMemFree(ur_context_handle_t,
-                                                     const void *, size_t) {
+UR_APIEXPORT ur_result_t UR_APICALL urVirtualMemFree(
+    ur_context_handle_t hContext, const void *pStart, size_t size) {
+  UR_ASSERT(hContext, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pStart, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+#ifdef __linux__
+  if (munmap(const_cast<void *>(pStart), size) != 0)
+    return native_cpu::virtual_mem_error(errno);
+  hContext->virtual_access.assign(toAddr(pStart), toAddr(pStart) + size,
+                                  std::nullopt);
+  return UR_RESULT_SUCCESS;
+#else
+  std::ignore = size;
   return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+#endif
 }
 
-UR_APIEXPORT ur_result_t UR_APICALL urVirtualMemSetAccess(
-    ur_context_handle_t, const void *, size_t, ur_virtual_mem_access_flags_t) {
+UR_APIEXPORT ur_result_t UR_APICALL
+urVirtualMemSetAccess(ur_context_handle_t hContext, const void *pStart,
+                      size_t size, ur_virtual_mem_access_flags_t flags) {
+  UR_ASSERT(hContext, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pStart, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  UR_ASSERT(!(flags & UR_VIRTUAL_MEM_ACCESS_FLAGS_MASK),
+            UR_RESULT_ERROR_INVALID_ENUMERATION);
+#ifdef __linux__
+  if (mprotect(const_cast<void *>(pStart), size, getProtection(flags)) != 0)
+    return native_cpu::virtual_mem_error(errno);
+  hContext->virtual_access.assign(toAddr(pStart), toAddr(pStart) + size,
+                                  flags);
+  return UR_RESULT_SUCCESS;
+#else
+  std::ignore = size;
   return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+#endif
 }
 
-UR_APIEXPORT ur_result_t UR_APICALL urVirtualMemMap(
-    ur_context_handle_t, const void *, size_t, ur_physical_mem_handle_t, size_t,
-    ur_virtual_mem_access_flags_t) {
+UR_APIEXPORT ur_result_t UR_APICALL
+urVirtualMemMap(ur_context_handle_t hContext, const void *pStart, size_t size,
+                ur_physical_mem_handle_t hPhysicalMem, size_t offset,
+                ur_virtual_mem_access_flags_t flags) {
+  UR_ASSERT(hContext, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(hPhysicalMem, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pStart, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+  UR_ASSERT(!(flags & UR_VIRTUAL_MEM_ACCESS_FLAGS_MASK),
+            UR_RESULT_ERROR_INVALID_ENUMERATION);
+#ifdef __linux__
+  UR_ASSERT(offset <= hPhysicalMem->size &&
+                size <= hPhysicalMem->size - offset,
+            UR_RESULT_ERROR_INVALID_VALUE);
+  // Replaces the reservation in place, the mapping shares the pages of the
+  // physical memory rather than copying them.
+  void *mapping = mmap(const_cast<void *>(pStart), size, getProtection(flags),
+                       MAP_SHARED | MAP_FIXED, hPhysicalMem->fd, offset);
+  if (mapping == MAP_FAILED)
+    return native_cpu::virtual_mem_error(errno);
+  hContext->virtual_access.assign(toAddr(pStart), toAddr(pStart) + size,
+                                  flags);
+  return UR_RESULT_SUCCESS;
+#else
+  std::ignore = size;
+  std::ignore = offset;
   return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+#endif
 }
 
-UR_APIEXPORT ur_result_t UR_APICALL urVirtualMemUnmap(ur_context_handle_t,
-                                                      const void *, size_t) {
+UR_APIEXPORT ur_result_t UR_APICALL urVirtualMemUnmap(
+    ur_context_handle_t hContext, const void *pStart, size_t size) {
+  UR_ASSERT(hContext, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pStart, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+#ifdef __linux__
+  // The range goes back to being reserved rather than being released
+  if (reserve(const_cast<void *>(pStart), size, MAP_FIXED) == MAP_FAILED)
+    return native_cpu::virtual_mem_error(errno);
+  hContext->virtual_access.assign(toAddr(pStart), toAddr(pStart) + size,
+                                  std::nullopt);
+  return UR_RESULT_SUCCESS;
+#else
+  std::ignore = size;
   return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+#endif
 }
 
-UR_APIEXPORT ur_result_t UR_APICALL urVirtualMemGetInfo(ur_context_handle_t,
-                                                        const void *, size_t,
-                                                        ur_virtual_mem_info_t,
-                                                        size_t, void *,
-                                                        size_t *) {
-  return UR_RESULT_ERROR_UNSUPPORTED_FEATURE;
+UR_APIEXPORT ur_result_t UR_APICALL urVirtualMemGetInfo(
+    ur_context_handle_t hContext, const void *pStart, size_t,
+    ur_virtual_mem_info_t propName, size_t propSize, void *pPropValue,
+    size_t *pPropSizeRet) {
+  UR_ASSERT(hContext, UR_RESULT_ERROR_INVALID_NULL_HANDLE);
+  UR_ASSERT(pStart, UR_RESULT_ERROR_INVALID_NULL_POINTER);
+
+  UrReturnHelper ReturnValue(propSize, pPropValue, pPropSizeRet);
+  switch (propName) {
+  case UR_VIRTUAL_MEM_INFO_ACCESS_MODE: {
+    auto flags = hContext->virtual_access.find(toAddr(pStart));
+    return ReturnValue(flags.value_or(ur_virtual_mem_access_flags_t{0}));
+  }
+  default:
+    return UR_RESULT_ERROR_INVALID_ENUMERATION;
+  }
 }
@@ -0,0 +1,86 @@
+//===---------- virtual_mem.hpp - NATIVE CPU Adapter ----------------------===//
+//
+// Copyright (C) 2024 Intel Corporation
+//
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM
+// Exceptions. See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <ur_api.h>
+
+namespace native_cpu {
+
+// Virtual memory ranges are reserved, mapped and protected in whole pages.
+size_t virtual_mem_page_size();
+
+// The size of transparent huge pages, mappings aligned to it can be backed by
+// them.
+size_t virtual_mem_huge_page_size();
+
+inline ur_result_t virtual_mem_error(int error) {
+  return error == ENOMEM ? UR_RESULT_ERROR_OUT_OF_HOST_MEMORY
+                         : UR_RESULT_ERROR_INVALID_VALUE;
+}
+
+// The access flags of the mapped virtual memory ranges of a context, so that
+// they can be queried without asking the kernel.
+class virtual_access_map {
+public:
+  // Sets the flags of [begin, end), or forgets them if `flags` is empty,
+  // splitting the ranges it overlaps.
+  void assign(uintptr_t begin, uintptr_t end,
+              std::optional<ur_virtual_mem_access_flags_t> flags) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_ranges.lower_bound(begin);
+    if (it != m_ranges.begin()) {
+      auto prev = std::prev(it);
+      if (prev->second.end > begin) {
+        if (prev->second.end > end)
+          m_ranges.emplace(end, prev->second);
+        prev->second.end = begin;
+      }
+    }
+    for (it = m_ranges.lower_bound(begin);
+         it != m_ranges.end() && it->first < end;) {
+      if (it->second.end > end)
+        m_ranges.emplace(end, it->second);
+      it = m_ranges.erase(it);
+    }
+    if (flags)
+      m_ranges.emplace(begin, range{end, *flags});
+  }
+
+  // Returns the flags of the range `addr` lies in, if it is mapped.
+  std::optional<ur_virtual_mem_access_flags_t> find(uintptr_t addr) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_ranges.upper_bound(addr);
+    if (it == m_ranges.begin())
+      return std::nullopt;
+    --it;
+    if (addr >= it->second.end)
+      return std::nullopt;
+    return it->second.flags;
+  }
+
+private:
+  struct range {
+    uintptr_t end;
+    ur_virtual_mem_access_flags_t flags;
+  };
+
+  mutable std::mutex m_mutex;
+  // Indexed by the start of each range, ranges don't overlap.
+  std::map<uintptr_t, range> m_ranges;
+};
+
+} // namespace native_cpu
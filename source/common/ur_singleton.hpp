@@ -11,23 +11,103 @@
 #ifndef UR_SINGLETON_H
 #define UR_SINGLETON_H 1
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <new>
 #include <unordered_map>
+#include <vector>
 
 //////////////////////////////////////////////////////////////////////////
 /// a abstract factory for creation of singleton objects
+///
+/// Keys are spread over independently locked shards, so threads creating
+/// or looking up different handles rarely contend. Each shard allocates the
+/// singletons in blocks and reuses the slots of released ones. A shard keeps
+/// at most one block that has no live singletons and frees the others, so
+/// the memory held follows the number of live handles.
 template <typename singleton_tn, typename key_tn> class singleton_factory_t {
   protected:
     using singleton_t = singleton_tn;
     using key_t = typename std::conditional<std::is_pointer<key_tn>::value,
                                             size_t, key_tn>::type;
 
-    using ptr_t = std::unique_ptr<singleton_t>;
-    using map_t = std::unordered_map<key_t, ptr_t>;
+    static constexpr size_t numShards = 32;
+    static constexpr size_t blockSize = 64;
 
-    std::mutex mut; ///< lock for thread-safety
-    map_t map;      ///< single instance of singleton for each unique key
+    struct block_t;
+
+    /// storage of a singleton, which starts the slot
+    struct slot_t {
+        alignas(singleton_t) std::byte storage[sizeof(singleton_t)];
+        block_t *block;
+    };
+
+    struct block_t {
+        std::array<slot_t, blockSize> slots;
+        size_t live = 0; ///< number of slots holding a singleton
+    };
+
+    struct alignas(64) shard_t {
+        std::mutex mut; ///< lock for thread-safety
+        /// single instance of singleton for each unique key
+        std::unordered_map<key_t, singleton_t *> map;
+        /// storage of the singletons, and the slots that are free
+        std::vector<std::unique_ptr<block_t>> blocks;
+        std::vector<slot_t *> freeSlots;
+        /// block without live singletons that is kept for reuse
+        block_t *spareBlock = nullptr;
+
+        slot_t *allocate() {
+            if (freeSlots.empty()) {
+                block_t *block =
+                    blocks.emplace_back(std::make_unique<block_t>()).get();
+                for (size_t i = blockSize; i > 0; i--) {
+                    block->slots[i - 1].block = block;
+                    freeSlots.push_back(&block->slots[i - 1]);
+                }
+            }
+            slot_t *slot = freeSlots.back();
+            freeSlots.pop_back();
+            if (slot->block->live++ == 0 && slot->block == spareBlock) {
+                spareBlock = nullptr;
+            }
+            return slot;
+        }
+
+        void deallocate(slot_t *slot) {
+            block_t *block = slot->block;
+            freeSlots.push_back(slot);
+            if (--block->live > 0) {
+                return;
+            }
+            if (!spareBlock) {
+                spareBlock = block;
+                return;
+            }
+            freeSlots.erase(std::remove_if(freeSlots.begin(), freeSlots.end(),
+                                           [block](slot_t *free) {
+                                               return free->block == block;
+                                           }),
+                            freeSlots.end());
+            blocks.erase(std::find_if(
+                blocks.begin(), blocks.end(),
+                [block](const std::unique_ptr<block_t> &owned) {
+                    return owned.get() == block;
+                }));
+        }
+
+        void destroy(singleton_t *ptr) {
+            ptr->~singleton_t();
+            deallocate(reinterpret_cast<slot_t *>(ptr));
+        }
+    };
+
+    std::array<shard_t, numShards> shards;
 
     //////////////////////////////////////////////////////////////////////////
     /// extract the key from parameter list and if necessary, convert type
@@ -36,11 +116,20 @@ template <typename singleton_tn, typename key_tn> class singleton_factory_t {
         return reinterpret_cast<key_t>(key);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    /// handles are aligned, so the low bits of the key are mixed in with a
+    /// multiplicative hash before picking the shard
+    shard_t &getShard(key_t key) {
+        uint64_t hash =
+            static_cast<uint64_t>(std::hash<key_t>{}(key)) * 0x9E3779B97F4A7C15;
+        return shards[(hash >> 32) % numShards];
+    }
+
   public:
     //////////////////////////////////////////////////////////////////////////
     /// default ctor/dtor
     singleton_factory_t() = default;
-    ~singleton_factory_t() = default;
+    ~singleton_factory_t() { clear(); }
 
     //////////////////////////////////////////////////////////////////////////
     /// gets a pointer to a unique instance of singleton
@@ -54,27 +143,45 @@ template <typename singleton_tn, typename key_tn> class singleton_factory_t {
             return static_cast<singleton_tn *>(0);
         }
 
-        std::lock_guard<std::mutex> lk(mut);
-        auto iter = map.find(key);
+        auto &shard = getShard(key);
+        std::lock_guard<std::mutex> lk(shard.mut);
+        auto iter = shard.map.find(key);
 
-        if (map.end() == iter) {
-            auto ptr =
-                std::make_unique<singleton_t>(std::forward<Ts>(params)...);
-            iter = map.emplace(key, std::move(ptr)).first;
+        if (shard.map.end() == iter) {
+            slot_t *slot = shard.allocate();
+            singleton_t *ptr;
+            try {
+                ptr = new (slot->storage)
+                    singleton_t(std::forward<Ts>(params)...);
+            } catch (...) {
+                shard.deallocate(slot);
+                throw;
+            }
+            iter = shard.map.emplace(key, ptr).first;
         }
-        return iter->second.get();
+        return iter->second;
     }
 
     //////////////////////////////////////////////////////////////////////////
     /// once the key is no longer valid, release the singleton
     void release(key_tn key) {
-        std::lock_guard<std::mutex> lk(mut);
-        map.erase(getKey(key));
+        auto &shard = getShard(getKey(key));
+        std::lock_guard<std::mutex> lk(shard.mut);
+        auto iter = shard.map.find(getKey(key));
+        if (iter != shard.map.end()) {
+            shard.destroy(iter->second);
+            shard.map.erase(iter);
+        }
     }
 
     void clear() {
-        std::lock_guard<std::mutex> lk(mut);
-        map.clear();
+        for (auto &shard : shards) {
+            std::lock_guard<std::mutex> lk(shard.mut);
+            for (auto &entry : shard.map) {
+                shard.destroy(entry.second);
+            }
+            shard.map.clear();
+        }
     }
 };
 
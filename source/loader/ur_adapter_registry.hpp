@@ -163,27 +163,31 @@ class AdapterRegistry {
         return paths.empty() ? std::nullopt : std::optional(paths);
     }
 
-    ur_result_t readPreFilterODS(std::string platformBackendName) {
-        // TODO: Refactor this to the common code such that both the prefilter and urDeviceGetSelected use the same functionality.
-        bool acceptLibrary = true;
+    // Parses ONEAPI_DEVICE_SELECTOR for the pre-filter. Returns std::nullopt
+    // if the selector is malformed, in which case it is ignored.
+    std::optional<EnvVarMap> readODS() {
         std::optional<EnvVarMap> odsEnvMap;
         try {
             odsEnvMap = getenv_to_map("ONEAPI_DEVICE_SELECTOR", false);
 
         } catch (...) {
-            // If the selector is malformed, then we ignore selector and return success.
             logger::error("ERROR: missing backend, format of filter = "
                           "'[!]backend:filterStrings'");
-            return UR_RESULT_SUCCESS;
+            return std::nullopt;
         }
         logger::debug(
             "getenv_to_map parsed env var and {} a map",
             (odsEnvMap.has_value() ? "produced" : "failed to produce"));
 
         // if the ODS env var is not set at all, then pretend it was set to the default
-        using EnvVarMap = std::map<std::string, std::vector<std::string>>;
-        EnvVarMap mapODS =
-            odsEnvMap.has_value() ? odsEnvMap.value() : EnvVarMap{{"*", {"*"}}};
+        return odsEnvMap.has_value() ? odsEnvMap.value()
+                                     : EnvVarMap{{"*", {"*"}}};
+    }
+
+    ur_result_t readPreFilterODS(const EnvVarMap &mapODS,
+                                 std::string platformBackendName) {
+        // TODO: Refactor this to the common code such that both the prefilter and urDeviceGetSelected use the same functionality.
+        bool acceptLibrary = true;
         for (auto &termPair : mapODS) {
             std::string backend = termPair.first;
             // TODO: Figure out how to process all ODS errors rather than returning
@@ -217,7 +221,8 @@ class AdapterRegistry {
                 (strcmp(backend.c_str(), "level_zero") != 0) &&
                 (strcmp(backend.c_str(), "opencl") != 0) &&
                 (strcmp(backend.c_str(), "cuda") != 0) &&
-                (strcmp(backend.c_str(), "hip") != 0)) {
+                (strcmp(backend.c_str(), "hip") != 0) &&
+                (strcmp(backend.c_str(), "native_cpu") != 0)) {
                 logger::debug("ONEAPI_DEVICE_SELECTOR Pre-Filter with illegal "
                               "backend '{}' ",
                               backend);
@@ -270,10 +275,17 @@ class AdapterRegistry {
 #else
         bool loaderPreFilter = getenv_tobool("UR_LOADER_PRELOAD_FILTER", true);
 #endif
+        // The selector is parsed once, and adapters it excludes are never
+        // opened.
+        std::optional<EnvVarMap> mapODS;
+        if (loaderPreFilter) {
+            mapODS = readODS();
+        }
         for (const auto &adapterName : knownAdapterNames) {
 
-            if (loaderPreFilter) {
-                if (readPreFilterODS(adapterName) != UR_RESULT_SUCCESS) {
+            if (mapODS.has_value()) {
+                if (readPreFilterODS(*mapODS, adapterName) !=
+                    UR_RESULT_SUCCESS) {
                     logger::debug("The adapter '{}' was removed based on the "
                                   "pre-filter from ONEAPI_DEVICE_SELECTOR.",
                                   adapterName);
@@ -861,7 +861,7 @@ __urdlllocal ur_result_t UR_APICALL urContextCreate(
     }
 
     // convert loader handles to platform handles
-    auto phDevicesLocal = std::vector<ur_device_handle_t>(DeviceCount);
+    local_array_t<ur_device_handle_t> phDevicesLocal(DeviceCount);
     for (size_t i = 0; i < DeviceCount; ++i) {
         phDevicesLocal[i] =
             reinterpret_cast<ur_device_object_t *>(phDevices[i])->handle;
@@ -1072,7 +1072,7 @@ __urdlllocal ur_result_t UR_APICALL urContextCreateWithNativeHandle(
     hAdapter = reinterpret_cast<ur_adapter_object_t *>(hAdapter)->handle;
 
     // convert loader handles to platform handles
-    auto phDevicesLocal = std::vector<ur_device_handle_t>(numDevices);
+    local_array_t<ur_device_handle_t> phDevicesLocal(numDevices);
     for (size_t i = 0; i < numDevices; ++i) {
         phDevicesLocal[i] =
             reinterpret_cast<ur_device_object_t *>(phDevices[i])->handle;
@@ -2593,7 +2593,7 @@ __urdlllocal ur_result_t UR_APICALL urProgramCreateWithBinary(
     hContext = reinterpret_cast<ur_context_object_t *>(hContext)->handle;
 
     // convert loader handles to platform handles
-    auto phDevicesLocal = std::vector<ur_device_handle_t>(numDevices);
+    local_array_t<ur_device_handle_t> phDevicesLocal(numDevices);
     for (size_t i = 0; i < numDevices; ++i) {
         phDevicesLocal[i] =
             reinterpret_cast<ur_device_object_t *>(phDevices[i])->handle;
@@ -2712,7 +2712,7 @@ __urdlllocal ur_result_t UR_APICALL urProgramLink(
     hContext = reinterpret_cast<ur_context_object_t *>(hContext)->handle;
 
     // convert loader handles to platform handles
-    auto phProgramsLocal = std::vector<ur_program_handle_t>(count);
+    local_array_t<ur_program_handle_t> phProgramsLocal(count);
     for (size_t i = 0; i < count; ++i) {
         phProgramsLocal[i] =
             reinterpret_cast<ur_program_object_t *>(phPrograms[i])->handle;
@@ -4154,7 +4154,7 @@ __urdlllocal ur_result_t UR_APICALL urEventWait(
     }
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal = std::vector<ur_event_handle_t>(numEvents);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEvents);
     for (size_t i = 0; i < numEvents; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -4370,8 +4370,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueKernelLaunch(
     hKernel = reinterpret_cast<ur_kernel_object_t *>(hKernel)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -4433,8 +4432,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueEventsWait(
     hQueue = reinterpret_cast<ur_queue_object_t *>(hQueue)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -4495,8 +4493,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueEventsWaitWithBarrier(
     hQueue = reinterpret_cast<ur_queue_object_t *>(hQueue)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -4564,8 +4561,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueMemBufferRead(
     hBuffer = reinterpret_cast<ur_mem_object_t *>(hBuffer)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -4636,8 +4632,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueMemBufferWrite(
     hBuffer = reinterpret_cast<ur_mem_object_t *>(hBuffer)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -4718,8 +4713,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueMemBufferReadRect(
     hBuffer = reinterpret_cast<ur_mem_object_t *>(hBuffer)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -4804,8 +4798,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueMemBufferWriteRect(
     hBuffer = reinterpret_cast<ur_mem_object_t *>(hBuffer)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -4879,8 +4872,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueMemBufferCopy(
     hBufferDst = reinterpret_cast<ur_mem_object_t *>(hBufferDst)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -4962,8 +4954,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueMemBufferCopyRect(
     hBufferDst = reinterpret_cast<ur_mem_object_t *>(hBufferDst)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -5033,8 +5024,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueMemBufferFill(
     hBuffer = reinterpret_cast<ur_mem_object_t *>(hBuffer)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -5108,8 +5098,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueMemImageRead(
     hImage = reinterpret_cast<ur_mem_object_t *>(hImage)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -5184,8 +5173,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueMemImageWrite(
     hImage = reinterpret_cast<ur_mem_object_t *>(hImage)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -5264,8 +5252,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueMemImageCopy(
     hImageDst = reinterpret_cast<ur_mem_object_t *>(hImageDst)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -5336,8 +5323,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueMemBufferMap(
     hBuffer = reinterpret_cast<ur_mem_object_t *>(hBuffer)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -5403,8 +5389,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueMemUnmap(
     hMem = reinterpret_cast<ur_mem_object_t *>(hMem)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -5471,8 +5456,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueUSMFill(
     hQueue = reinterpret_cast<ur_queue_object_t *>(hQueue)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -5538,8 +5522,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueUSMMemcpy(
     hQueue = reinterpret_cast<ur_queue_object_t *>(hQueue)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -5603,8 +5586,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueUSMPrefetch(
     hQueue = reinterpret_cast<ur_queue_object_t *>(hQueue)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -5723,8 +5705,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueUSMFill2D(
     hQueue = reinterpret_cast<ur_queue_object_t *>(hQueue)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -5795,8 +5776,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueUSMMemcpy2D(
     hQueue = reinterpret_cast<ur_queue_object_t *>(hQueue)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -5868,8 +5848,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueDeviceGlobalVariableWrite(
     hProgram = reinterpret_cast<ur_program_object_t *>(hProgram)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -5941,8 +5920,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueDeviceGlobalVariableRead(
     hProgram = reinterpret_cast<ur_program_object_t *>(hProgram)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -6018,8 +5996,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueReadHostPipe(
     hProgram = reinterpret_cast<ur_program_object_t *>(hProgram)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -6096,8 +6073,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueWriteHostPipe(
     hProgram = reinterpret_cast<ur_program_object_t *>(hProgram)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -6442,8 +6418,7 @@ __urdlllocal ur_result_t UR_APICALL urBindlessImagesImageCopyExp(
     hQueue = reinterpret_cast<ur_queue_object_t *>(hQueue)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -6883,8 +6858,7 @@ __urdlllocal ur_result_t UR_APICALL urBindlessImagesWaitExternalSemaphoreExp(
             ->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -6958,8 +6932,7 @@ __urdlllocal ur_result_t UR_APICALL urBindlessImagesSignalExternalSemaphoreExp(
             ->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -7192,8 +7165,8 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferAppendKernelLaunchExp(
     hKernel = reinterpret_cast<ur_kernel_object_t *>(hKernel)->handle;
 
     // convert loader handles to platform handles
-    auto phKernelAlternativesLocal =
-        std::vector<ur_kernel_handle_t>(numKernelAlternatives);
+    local_array_t<ur_kernel_handle_t> phKernelAlternativesLocal(
+        numKernelAlternatives);
     for (size_t i = 0; i < numKernelAlternatives; ++i) {
         phKernelAlternativesLocal[i] =
             reinterpret_cast<ur_kernel_object_t *>(phKernelAlternatives[i])
@@ -7201,8 +7174,7 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferAppendKernelLaunchExp(
     }
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -7292,8 +7264,7 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferAppendUSMMemcpyExp(
             ->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -7384,8 +7355,7 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferAppendUSMFillExp(
             ->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -7482,8 +7452,7 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferAppendMemBufferCopyExp(
     hDstMem = reinterpret_cast<ur_mem_object_t *>(hDstMem)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -7577,8 +7546,7 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferAppendMemBufferWriteExp(
     hBuffer = reinterpret_cast<ur_mem_object_t *>(hBuffer)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -7671,8 +7639,7 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferAppendMemBufferReadExp(
     hBuffer = reinterpret_cast<ur_mem_object_t *>(hBuffer)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -7776,8 +7743,7 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferAppendMemBufferCopyRectExp(
     hDstMem = reinterpret_cast<ur_mem_object_t *>(hDstMem)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -7885,8 +7851,7 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferAppendMemBufferWriteRectExp(
     hBuffer = reinterpret_cast<ur_mem_object_t *>(hBuffer)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -7992,8 +7957,7 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferAppendMemBufferReadRectExp(
     hBuffer = reinterpret_cast<ur_mem_object_t *>(hBuffer)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -8089,8 +8053,7 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferAppendMemBufferFillExp(
     hBuffer = reinterpret_cast<ur_mem_object_t *>(hBuffer)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -8179,8 +8142,7 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferAppendUSMPrefetchExp(
             ->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -8269,8 +8231,7 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferAppendUSMAdviseExp(
             ->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -8351,8 +8312,7 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferEnqueueExp(
     hQueue = reinterpret_cast<ur_queue_object_t *>(hQueue)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -8479,8 +8439,9 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferUpdateKernelLaunchExp(
                 ->handle;
     }
 
-    std::vector<ur_exp_command_buffer_update_memobj_arg_desc_t>
-        pUpdateKernelLaunchpNewMemObjArgList;
+    local_array_t<ur_exp_command_buffer_update_memobj_arg_desc_t>
+        pUpdateKernelLaunchpNewMemObjArgList(
+            pUpdateKernelLaunch->numNewMemObjArgs);
     for (uint32_t i = 0; i < pUpdateKernelLaunch->numNewMemObjArgs; i++) {
         ur_exp_command_buffer_update_memobj_arg_desc_t NewRangeStruct =
             pUpdateKernelLaunchLocal.pNewMemObjArgList[i];
@@ -8490,7 +8451,7 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferUpdateKernelLaunchExp(
                                                ->handle;
         }
 
-        pUpdateKernelLaunchpNewMemObjArgList.push_back(NewRangeStruct);
+        pUpdateKernelLaunchpNewMemObjArgList[i] = NewRangeStruct;
     }
     pUpdateKernelLaunchLocal.pNewMemObjArgList =
         pUpdateKernelLaunchpNewMemObjArgList.data();
@@ -8580,8 +8541,7 @@ __urdlllocal ur_result_t UR_APICALL urCommandBufferUpdateWaitEventsExp(
             ->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -8724,8 +8684,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueCooperativeKernelLaunchExp(
     hKernel = reinterpret_cast<ur_kernel_object_t *>(hKernel)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -8830,8 +8789,7 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueTimestampRecordingExp(
     hQueue = reinterpret_cast<ur_queue_object_t *>(hQueue)->handle;
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -8942,7 +8900,7 @@ __urdlllocal ur_result_t UR_APICALL urProgramBuildExp(
     hProgram = reinterpret_cast<ur_program_object_t *>(hProgram)->handle;
 
     // convert loader handles to platform handles
-    auto phDevicesLocal = std::vector<ur_device_handle_t>(numDevices);
+    local_array_t<ur_device_handle_t> phDevicesLocal(numDevices);
     for (size_t i = 0; i < numDevices; ++i) {
         phDevicesLocal[i] =
             reinterpret_cast<ur_device_object_t *>(phDevices[i])->handle;
@@ -8980,7 +8938,7 @@ __urdlllocal ur_result_t UR_APICALL urProgramCompileExp(
     hProgram = reinterpret_cast<ur_program_object_t *>(hProgram)->handle;
 
     // convert loader handles to platform handles
-    auto phDevicesLocal = std::vector<ur_device_handle_t>(numDevices);
+    local_array_t<ur_device_handle_t> phDevicesLocal(numDevices);
     for (size_t i = 0; i < numDevices; ++i) {
         phDevicesLocal[i] =
             reinterpret_cast<ur_device_object_t *>(phDevices[i])->handle;
@@ -9026,14 +8984,14 @@ __urdlllocal ur_result_t UR_APICALL urProgramLinkExp(
     hContext = reinterpret_cast<ur_context_object_t *>(hContext)->handle;
 
     // convert loader handles to platform handles
-    auto phDevicesLocal = std::vector<ur_device_handle_t>(numDevices);
+    local_array_t<ur_device_handle_t> phDevicesLocal(numDevices);
     for (size_t i = 0; i < numDevices; ++i) {
         phDevicesLocal[i] =
             reinterpret_cast<ur_device_object_t *>(phDevices[i])->handle;
     }
 
     // convert loader handles to platform handles
-    auto phProgramsLocal = std::vector<ur_program_handle_t>(count);
+    local_array_t<ur_program_handle_t> phProgramsLocal(count);
     for (size_t i = 0; i < count; ++i) {
         phProgramsLocal[i] =
             reinterpret_cast<ur_program_object_t *>(phPrograms[i])->handle;
@@ -9261,15 +9219,14 @@ __urdlllocal ur_result_t UR_APICALL urEnqueueNativeCommandExp(
     hQueue = reinterpret_cast<ur_queue_object_t *>(hQueue)->handle;
 
     // convert loader handles to platform handles
-    auto phMemListLocal = std::vector<ur_mem_handle_t>(numMemsInMemList);
+    local_array_t<ur_mem_handle_t> phMemListLocal(numMemsInMemList);
     for (size_t i = 0; i < numMemsInMemList; ++i) {
         phMemListLocal[i] =
             reinterpret_cast<ur_mem_object_t *>(phMemList[i])->handle;
     }
 
     // convert loader handles to platform handles
-    auto phEventWaitListLocal =
-        std::vector<ur_event_handle_t>(numEventsInWaitList);
+    local_array_t<ur_event_handle_t> phEventWaitListLocal(numEventsInWaitList);
     for (size_t i = 0; i < numEventsInWaitList; ++i) {
         phEventWaitListLocal[i] =
             reinterpret_cast<ur_event_object_t *>(phEventWaitList[i])->handle;
@@ -9349,8 +9306,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetGlobalProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnAdapterGet = ur_loader::urAdapterGet;
             pDdiTable->pfnAdapterRelease = ur_loader::urAdapterRelease;
@@ -9415,8 +9371,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetBindlessImagesExpProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnUnsampledImageHandleDestroyExp =
                 ur_loader::urBindlessImagesUnsampledImageHandleDestroyExp;
@@ -9512,8 +9467,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetCommandBufferExpProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnCreateExp = ur_loader::urCommandBufferCreateExp;
             pDdiTable->pfnRetainExp = ur_loader::urCommandBufferRetainExp;
@@ -9612,8 +9566,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetContextProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnCreate = ur_loader::urContextCreate;
             pDdiTable->pfnRetain = ur_loader::urContextRetain;
@@ -9678,8 +9631,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetEnqueueProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnKernelLaunch = ur_loader::urEnqueueKernelLaunch;
             pDdiTable->pfnEventsWait = ur_loader::urEnqueueEventsWait;
@@ -9767,8 +9719,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetEnqueueExpProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnKernelLaunchCustomExp =
                 ur_loader::urEnqueueKernelLaunchCustomExp;
@@ -9833,8 +9784,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetEventProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnGetInfo = ur_loader::urEventGetInfo;
             pDdiTable->pfnGetProfilingInfo = ur_loader::urEventGetProfilingInfo;
@@ -9899,8 +9849,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetKernelProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnCreate = ur_loader::urKernelCreate;
             pDdiTable->pfnGetInfo = ur_loader::urKernelGetInfo;
@@ -9976,8 +9925,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetKernelExpProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnSuggestMaxCooperativeGroupCountExp =
                 ur_loader::urKernelSuggestMaxCooperativeGroupCountExp;
@@ -10036,8 +9984,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetMemProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnImageCreate = ur_loader::urMemImageCreate;
             pDdiTable->pfnBufferCreate = ur_loader::urMemBufferCreate;
@@ -10106,8 +10053,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetPhysicalMemProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnCreate = ur_loader::urPhysicalMemCreate;
             pDdiTable->pfnRetain = ur_loader::urPhysicalMemRetain;
@@ -10167,8 +10113,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetPlatformProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnGet = ur_loader::urPlatformGet;
             pDdiTable->pfnGetInfo = ur_loader::urPlatformGetInfo;
@@ -10233,8 +10178,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetProgramProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnCreateWithIL = ur_loader::urProgramCreateWithIL;
             pDdiTable->pfnCreateWithBinary =
@@ -10310,8 +10254,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetProgramExpProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnBuildExp = ur_loader::urProgramBuildExp;
             pDdiTable->pfnCompileExp = ur_loader::urProgramCompileExp;
@@ -10371,8 +10314,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetQueueProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnGetInfo = ur_loader::urQueueGetInfo;
             pDdiTable->pfnCreate = ur_loader::urQueueCreate;
@@ -10437,8 +10379,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetSamplerProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnCreate = ur_loader::urSamplerCreate;
             pDdiTable->pfnRetain = ur_loader::urSamplerRetain;
@@ -10501,8 +10442,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetUSMProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnHostAlloc = ur_loader::urUSMHostAlloc;
             pDdiTable->pfnDeviceAlloc = ur_loader::urUSMDeviceAlloc;
@@ -10567,8 +10507,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetUSMExpProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnPitchedAllocExp = ur_loader::urUSMPitchedAllocExp;
             pDdiTable->pfnImportExp = ur_loader::urUSMImportExp;
@@ -10628,8 +10567,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetUsmP2PExpProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnEnablePeerAccessExp =
                 ur_loader::urUsmP2PEnablePeerAccessExp;
@@ -10693,8 +10631,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetVirtualMemProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnGranularityGetInfo =
                 ur_loader::urVirtualMemGranularityGetInfo;
@@ -10759,8 +10696,7 @@ UR_DLLEXPORT ur_result_t UR_APICALL urGetDeviceProcAddrTable(
     }
 
     if (UR_RESULT_SUCCESS == result) {
-        if (ur_loader::getContext()->platforms.size() != 1 ||
-            ur_loader::getContext()->forceIntercept) {
+        if (ur_loader::getContext()->intercept_enabled) {
             // return pointers to loader's DDIs
             pDdiTable->pfnGet = ur_loader::urDeviceGet;
             pDdiTable->pfnGetInfo = ur_loader::urDeviceGetInfo;
@@ -8,6 +8,10 @@
  *
  */
 #include "ur_loader.hpp"
+
+#include <algorithm>
+#include <system_error>
+#include <thread>
 #ifdef UR_STATIC_ADAPTER_LEVEL_ZERO
 #include "adapters/level_zero/ur_interface_loader.hpp"
 #endif
@@ -38,25 +42,78 @@ ur_result_t context_t::init() {
     }
 #endif
 
-    for (const auto &adapterPaths : adapter_registry) {
-        for (const auto &path : adapterPaths) {
-            auto handle = LibLoader::loadAdapterLibrary(path.string().c_str());
-            if (handle) {
-                platforms.emplace_back(std::move(handle));
+    // Adapters are opened concurrently, each on its own thread, since opening
+    // one runs its library constructors and those of its native runtime.
+    // The results are kept in registry order so that platforms are always
+    // enumerated in the same order.
+    std::vector<LibLoader::Lib> handles(adapter_registry.size());
+    auto loadAdapter = [this, &handles](size_t i) {
+        for (const auto &path : adapter_registry[i]) {
+            handles[i] = LibLoader::loadAdapterLibrary(path.string().c_str());
+            if (handles[i]) {
                 break;
             }
         }
+    };
+
+    std::vector<std::thread> loaders;
+    for (size_t i = 1; i < handles.size(); i++) {
+        try {
+            loaders.emplace_back(loadAdapter, i);
+        } catch (const std::system_error &) {
+            // Out of threads, load the remaining adapters on this one.
+            for (; i < handles.size(); i++) {
+                loadAdapter(i);
+            }
+        }
+    }
+    if (!handles.empty()) {
+        loadAdapter(0);
+    }
+    for (auto &loader : loaders) {
+        loader.join();
+    }
+
+    for (auto &handle : handles) {
+        if (handle) {
+            platforms.emplace_back(std::move(handle));
+        }
     }
 #ifdef _WIN32
     // Restore system error handling.
     (void)SetErrorMode(SavedMode);
 #endif
 
+    // Libraries without DDI tables can't serve any call, and keeping them
+    // would make the loader intercept calls just to tell them apart.
+    platforms.erase(
+        std::remove_if(platforms.begin(), platforms.end(),
+                       [](const platform_t &platform) {
+                           if (!platform.handle ||
+                               LibLoader::getFunctionPtr(
+                                   platform.handle.get(),
+                                   "urGetGlobalProcAddrTable")) {
+                               return false;
+                           }
+                           logger::warning("ignoring library 0x{} which "
+                                           "isn't a UR adapter",
+                                           platform.handle.get());
+                           return true;
+                       }),
+        platforms.end());
+
     forceIntercept = getenv_tobool("UR_ENABLE_LOADER_INTERCEPT");
 
-    if (forceIntercept || platforms.size() > 1) {
+    // With a single adapter there are no handles to tell apart, so the
+    // application is handed the adapter's DDI tables and calls go straight
+    // to the adapter, without any handle translation. Without any adapter
+    // there are no tables to hand out, so the loader's own are used.
+    if (forceIntercept || platforms.size() != 1) {
         intercept_enabled = true;
     }
+    logger::info("loader {} for {} adapter(s)",
+                 intercept_enabled ? "intercepting calls" : "in passthrough",
+                 platforms.size());
 
     return UR_RESULT_SUCCESS;
 }
@@ -39,6 +39,9 @@ class context_t : public AtomicSingleton<context_t> {
     bool forceIntercept = false;
 
     ur_result_t init();
+    /// Set by init when calls must go through the loader's intercepts, which
+    /// is when there isn't exactly one adapter or UR_ENABLE_LOADER_INTERCEPT
+    /// is set. Otherwise the DDI tables point straight at the adapter's.
     bool intercept_enabled = false;
 
     struct handle_factories factories;
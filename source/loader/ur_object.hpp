@@ -13,6 +13,10 @@
 #ifndef UR_OBJECT_H
 #define UR_OBJECT_H 1
 
+#include <cstddef>
+#include <utility>
+#include <vector>
+
 #include "ur_ddi.h"
 #include "ur_util.hpp"
 
@@ -37,4 +41,61 @@ template <typename _handle_t> class object_t {
     ~object_t() = default;
 };
 
+//////////////////////////////////////////////////////////////////////////
+/// Scratch space for an array of handles or structs translated from loader
+/// objects to adapter objects for the duration of one call. Arrays of up to
+/// `inline_size` elements live on the stack. Larger ones borrow a buffer
+/// from a small per-thread cache and give it back afterwards, so translating
+/// an array only allocates the first time a thread needs a bigger buffer.
+/// Buffers are borrowed rather than shared, so calls that re-enter the
+/// loader on the same thread get buffers of their own.
+template <typename T, size_t inline_size = 16> class local_array_t {
+  public:
+    explicit local_array_t(size_t size) {
+        // Empty arrays are passed on as null, as the spec requires of empty
+        // wait lists
+        if (size == 0) {
+            ptr = nullptr;
+            return;
+        }
+        if (size <= inline_size) {
+            ptr = inline_storage;
+            return;
+        }
+        auto &cache = buffer_cache();
+        if (!cache.empty()) {
+            buffer = std::move(cache.back());
+            cache.pop_back();
+        }
+        buffer.resize(size);
+        ptr = buffer.data();
+    }
+
+    ~local_array_t() {
+        auto &cache = buffer_cache();
+        if (buffer.capacity() != 0 && cache.size() < max_cached_buffers) {
+            buffer.clear();
+            cache.push_back(std::move(buffer));
+        }
+    }
+
+    local_array_t(const local_array_t &) = delete;
+    local_array_t &operator=(const local_array_t &) = delete;
+
+    T *data() { return ptr; }
+    T &operator[](size_t i) { return ptr[i]; }
+
+  private:
+    static constexpr size_t max_cached_buffers = 4;
+
+    static std::vector<std::vector<T>> &buffer_cache() {
+        thread_local std::vector<std::vector<T>> cache;
+        return cache;
+    }
+
+    T inline_storage[inline_size];
+    std::vector<T> buffer;
+    T *ptr;
+};
+
 #endif /* UR_OBJECT_H */
@@ -58,6 +58,8 @@ const ur_command_t UR_EXT_COMMAND_TYPE_USER =
 #define __SYCL_UR_PROGRAM_METADATA_TAG_MAX_LINEAR_WORK_GROUP_SIZE              \
   "@max_linear_work_group_size"
 #define __SYCL_UR_PROGRAM_METADATA_TAG_NEED_FINALIZATION "Requires finalization"
+#define __SYCL_UR_PROGRAM_METADATA_TAG_NATIVE_CPU_SHARED_LIBRARY              \
+  "@native_cpu_shared_library"
 
 // Terminates the process with a catastrophic error message.
 [[noreturn]] inline void die(const char *Message) {
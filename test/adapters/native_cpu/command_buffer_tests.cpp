@@ -0,0 +1,310 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "fixtures.hpp"
+#include "nativecpu_state.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+using nativeCpuCommandBufferTest = nativeCpuQueueTest;
+
+namespace {
+
+// out[id] = base + id, with `out` in argument 0 and `base` in argument 1.
+void writeIds(void *const *args, void *s) {
+    auto *out = static_cast<uint32_t *>(args[0]);
+    const size_t id = static_cast<native_cpu::state *>(s)->MGlobal_id[0];
+    out[id] = *static_cast<const uint32_t *>(args[1]) + uint32_t(id);
+}
+
+// The same, with the IDs doubled.
+void writeDoubleIds(void *const *args, void *s) {
+    auto *out = static_cast<uint32_t *>(args[0]);
+    const size_t id = static_cast<native_cpu::state *>(s)->MGlobal_id[0];
+    out[id] = *static_cast<const uint32_t *>(args[1]) + 2 * uint32_t(id);
+}
+
+struct nativeCpuCommandBufferKernelTest : nativeCpuQueueTest {
+    static constexpr size_t count = 64;
+
+    void SetUp() override {
+        ASSERT_NO_FATAL_FAILURE(nativeCpuQueueTest::SetUp());
+        static const struct {
+            const char *name;
+            const void *kernel;
+        } table[] = {
+            {"writeIds", reinterpret_cast<const void *>(writeIds)},
+            {"writeDoubleIds", reinterpret_cast<const void *>(writeDoubleIds)},
+            {nullptr, nullptr}};
+        const uint8_t *binary = reinterpret_cast<const uint8_t *>(table);
+        ASSERT_SUCCESS(urProgramCreateWithBinary(context, 1, &device, nullptr,
+                                                 &binary, nullptr, &program));
+        ASSERT_SUCCESS(urKernelCreate(program, "writeIds", &kernel));
+        ASSERT_SUCCESS(
+            urKernelCreate(program, "writeDoubleIds", &doubleKernel));
+        for (auto k : {kernel, doubleKernel}) {
+            ASSERT_SUCCESS(urKernelSetArgPointer(k, 0, nullptr, out.data()));
+            ASSERT_SUCCESS(
+                urKernelSetArgValue(k, 1, sizeof(base), nullptr, &base));
+        }
+        ur_exp_command_buffer_desc_t desc = {
+            UR_STRUCTURE_TYPE_EXP_COMMAND_BUFFER_DESC, nullptr, true, true,
+            false};
+        ASSERT_SUCCESS(
+            urCommandBufferCreateExp(context, device, &desc, &cmdBuf));
+    }
+
+    void TearDown() override {
+        if (cmdBuf) {
+            EXPECT_SUCCESS(urCommandBufferReleaseExp(cmdBuf));
+        }
+        for (auto k : {kernel, doubleKernel}) {
+            if (k) {
+                EXPECT_SUCCESS(urKernelRelease(k));
+            }
+        }
+        if (program) {
+            EXPECT_SUCCESS(urProgramRelease(program));
+        }
+        nativeCpuQueueTest::TearDown();
+    }
+
+    // Appends a launch of `kernel` over `size` items, with `doubleKernel` as
+    // its alternative.
+    void appendLaunch(size_t size, ur_exp_command_buffer_command_handle_t
+                                       *command = nullptr) {
+        const size_t offset = 0;
+        ASSERT_SUCCESS(urCommandBufferAppendKernelLaunchExp(
+            cmdBuf, kernel, 1, &offset, &size, nullptr, 1, &doubleKernel, 0,
+            nullptr, 0, nullptr, nullptr, nullptr, command));
+    }
+
+    // Runs the command-buffer once on a cleared output.
+    void run() {
+        std::fill(out.begin(), out.end(), 0);
+        ASSERT_SUCCESS(
+            urCommandBufferEnqueueExp(cmdBuf, queue, 0, nullptr, nullptr));
+        ASSERT_SUCCESS(urQueueFinish(queue));
+    }
+
+    // Checks out[i] == first + step * i for the first `size` items, and that
+    // the rest is untouched.
+    void expectOutput(size_t size, uint32_t first, uint32_t step) {
+        for (size_t i = 0; i < count; i++) {
+            const uint32_t expected =
+                i < size ? first + step * uint32_t(i) : 0;
+            ASSERT_EQ(out[i], expected) << "index " << i;
+        }
+    }
+
+    ur_exp_command_buffer_update_kernel_launch_desc_t updateDesc() {
+        ur_exp_command_buffer_update_kernel_launch_desc_t desc{};
+        desc.stype =
+            UR_STRUCTURE_TYPE_EXP_COMMAND_BUFFER_UPDATE_KERNEL_LAUNCH_DESC;
+        desc.newWorkDim = 1;
+        return desc;
+    }
+
+    std::vector<uint32_t> out = std::vector<uint32_t>(count, 0);
+    uint32_t base = 100;
+    ur_program_handle_t program = nullptr;
+    ur_kernel_handle_t kernel = nullptr;
+    ur_kernel_handle_t doubleKernel = nullptr;
+    ur_exp_command_buffer_handle_t cmdBuf = nullptr;
+};
+
+} // namespace
+
+// Replaying a command-buffer runs every command again.
+TEST_F(nativeCpuCommandBufferKernelTest, ReplayTwice) {
+    ASSERT_NO_FATAL_FAILURE(appendLaunch(count));
+    ASSERT_SUCCESS(urCommandBufferFinalizeExp(cmdBuf));
+    for (int replay = 0; replay < 2; replay++) {
+        ASSERT_NO_FATAL_FAILURE(run());
+        ASSERT_NO_FATAL_FAILURE(expectOutput(count, base, 1));
+    }
+}
+
+// Commands of an out-of-order command-buffer run after the sync-points they
+// wait on.
+TEST_F(nativeCpuCommandBufferKernelTest, SyncPointOrdering) {
+    ur_exp_command_buffer_handle_t outOfOrder = nullptr;
+    ur_exp_command_buffer_desc_t desc = {
+        UR_STRUCTURE_TYPE_EXP_COMMAND_BUFFER_DESC, nullptr, false, false,
+        false};
+    ASSERT_SUCCESS(
+        urCommandBufferCreateExp(context, device, &desc, &outOfOrder));
+
+    const uint32_t pattern = 0xFFFFFFFF;
+    std::vector<uint32_t> copy(count, 0);
+    ur_exp_command_buffer_sync_point_t filled, written;
+    ASSERT_SUCCESS(urCommandBufferAppendUSMFillExp(
+        outOfOrder, out.data(), &pattern, sizeof(pattern),
+        count * sizeof(uint32_t), 0, nullptr, 0, nullptr, &filled, nullptr,
+        nullptr));
+    const size_t offset = 0, size = count;
+    ASSERT_SUCCESS(urCommandBufferAppendKernelLaunchExp(
+        outOfOrder, kernel, 1, &offset, &size, nullptr, 0, nullptr, 1,
+        &filled, 0, nullptr, &written, nullptr, nullptr));
+    ASSERT_SUCCESS(urCommandBufferAppendUSMMemcpyExp(
+        outOfOrder, copy.data(), out.data(), count * sizeof(uint32_t), 1,
+        &written, 0, nullptr, nullptr, nullptr, nullptr));
+    ASSERT_SUCCESS(urCommandBufferFinalizeExp(outOfOrder));
+
+    ASSERT_SUCCESS(
+        urCommandBufferEnqueueExp(outOfOrder, queue, 0, nullptr, nullptr));
+    ASSERT_SUCCESS(urQueueFinish(queue));
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_EQ(copy[i], base + uint32_t(i)) << "index " << i;
+    }
+    ASSERT_SUCCESS(urCommandBufferReleaseExp(outOfOrder));
+}
+
+// Arguments and sizes can be updated in place, and later replays use them.
+TEST_F(nativeCpuCommandBufferKernelTest, UpdateArgsAndSizes) {
+    ur_exp_command_buffer_command_handle_t command = nullptr;
+    ASSERT_NO_FATAL_FAILURE(appendLaunch(count / 2, &command));
+    ASSERT_SUCCESS(urCommandBufferFinalizeExp(cmdBuf));
+    ASSERT_NO_FATAL_FAILURE(run());
+    ASSERT_NO_FATAL_FAILURE(expectOutput(count / 2, base, 1));
+
+    const uint32_t newBase = 7;
+    ur_exp_command_buffer_update_value_arg_desc_t valueArg = {
+        UR_STRUCTURE_TYPE_EXP_COMMAND_BUFFER_UPDATE_VALUE_ARG_DESC,
+        nullptr,
+        1,
+        sizeof(newBase),
+        nullptr,
+        &newBase};
+    size_t newSize = count;
+    auto desc = updateDesc();
+    desc.numNewValueArgs = 1;
+    desc.pNewValueArgList = &valueArg;
+    desc.pNewGlobalWorkSize = &newSize;
+    ASSERT_SUCCESS(urCommandBufferUpdateKernelLaunchExp(command, &desc));
+
+    for (int replay = 0; replay < 2; replay++) {
+        ASSERT_NO_FATAL_FAILURE(run());
+        ASSERT_NO_FATAL_FAILURE(expectOutput(count, newBase, 1));
+    }
+    ASSERT_SUCCESS(urCommandBufferReleaseCommandExp(command));
+}
+
+// Swapping in a registered alternative kernel runs it with its own
+// arguments, and swapping back restores the original.
+TEST_F(nativeCpuCommandBufferKernelTest, SwapKernel) {
+    ur_exp_command_buffer_command_handle_t command = nullptr;
+    ASSERT_NO_FATAL_FAILURE(appendLaunch(count, &command));
+    ASSERT_SUCCESS(urCommandBufferFinalizeExp(cmdBuf));
+
+    auto desc = updateDesc();
+    desc.hNewKernel = doubleKernel;
+    ASSERT_SUCCESS(urCommandBufferUpdateKernelLaunchExp(command, &desc));
+    ASSERT_NO_FATAL_FAILURE(run());
+    ASSERT_NO_FATAL_FAILURE(expectOutput(count, base, 2));
+
+    desc.hNewKernel = kernel;
+    ASSERT_SUCCESS(urCommandBufferUpdateKernelLaunchExp(command, &desc));
+    ASSERT_NO_FATAL_FAILURE(run());
+    ASSERT_NO_FATAL_FAILURE(expectOutput(count, base, 1));
+    ASSERT_SUCCESS(urCommandBufferReleaseCommandExp(command));
+}
+
+// Commands hold a reference to their command-buffer, so they can be updated
+// after the application has released it.
+TEST_F(nativeCpuCommandBufferKernelTest, CommandOutlivesCommandBuffer) {
+    ur_exp_command_buffer_command_handle_t command = nullptr;
+    ASSERT_NO_FATAL_FAILURE(appendLaunch(count, &command));
+    ASSERT_SUCCESS(urCommandBufferFinalizeExp(cmdBuf));
+    ASSERT_SUCCESS(urCommandBufferReleaseExp(cmdBuf));
+    cmdBuf = nullptr;
+
+    const uint32_t newBase = 7;
+    ur_exp_command_buffer_update_value_arg_desc_t valueArg = {
+        UR_STRUCTURE_TYPE_EXP_COMMAND_BUFFER_UPDATE_VALUE_ARG_DESC,
+        nullptr,
+        1,
+        sizeof(newBase),
+        nullptr,
+        &newBase};
+    auto desc = updateDesc();
+    desc.numNewValueArgs = 1;
+    desc.pNewValueArgList = &valueArg;
+    ASSERT_SUCCESS(urCommandBufferUpdateKernelLaunchExp(command, &desc));
+    ASSERT_SUCCESS(urCommandBufferReleaseCommandExp(command));
+}
+
+// An update that can't be planned leaves the command as it was, arguments
+// included.
+TEST_F(nativeCpuCommandBufferKernelTest, FailedUpdateKeepsCommand) {
+    ur_exp_command_buffer_command_handle_t command = nullptr;
+    ASSERT_NO_FATAL_FAILURE(appendLaunch(count, &command));
+    ASSERT_SUCCESS(urCommandBufferFinalizeExp(cmdBuf));
+
+    uint64_t localMemSize = 0;
+    ASSERT_SUCCESS(urDeviceGetInfo(device, UR_DEVICE_INFO_LOCAL_MEM_SIZE,
+                                   sizeof(localMemSize), &localMemSize,
+                                   nullptr));
+    const uint32_t newBase = 7;
+    const ur_exp_command_buffer_update_value_arg_desc_t valueArgs[] = {
+        {UR_STRUCTURE_TYPE_EXP_COMMAND_BUFFER_UPDATE_VALUE_ARG_DESC, nullptr,
+         1, sizeof(newBase), nullptr, &newBase},
+        // A local argument bigger than the device's local memory
+        {UR_STRUCTURE_TYPE_EXP_COMMAND_BUFFER_UPDATE_VALUE_ARG_DESC, nullptr,
+         2, uint32_t(localMemSize + 1), nullptr, nullptr}};
+    size_t newSize = count / 2;
+    auto desc = updateDesc();
+    desc.numNewValueArgs = 2;
+    desc.pNewValueArgList = valueArgs;
+    desc.pNewGlobalWorkSize = &newSize;
+    ASSERT_EQ(urCommandBufferUpdateKernelLaunchExp(command, &desc),
+              UR_RESULT_ERROR_OUT_OF_RESOURCES);
+
+    ASSERT_NO_FATAL_FAILURE(run());
+    ASSERT_NO_FATAL_FAILURE(expectOutput(count, base, 1));
+    ASSERT_SUCCESS(urCommandBufferReleaseCommandExp(command));
+}
+
+// Prefetch and advice nodes run as part of the graph and order the commands
+// that depend on them.
+TEST_F(nativeCpuCommandBufferTest, PrefetchAndAdviseNodes) {
+    constexpr size_t count = 1 << 16;
+    constexpr size_t size = count * sizeof(uint32_t);
+    void *ptr = nullptr;
+    ASSERT_SUCCESS(
+        urUSMSharedAlloc(context, device, nullptr, nullptr, size, &ptr));
+
+    ur_exp_command_buffer_handle_t cmdBuf = nullptr;
+    ASSERT_SUCCESS(urCommandBufferCreateExp(context, device, nullptr, &cmdBuf));
+    ur_exp_command_buffer_sync_point_t prefetched, advised;
+    ASSERT_SUCCESS(urCommandBufferAppendUSMPrefetchExp(
+        cmdBuf, ptr, size, UR_USM_MIGRATION_FLAG_DEFAULT, 0, nullptr, 0,
+        nullptr, &prefetched, nullptr, nullptr));
+    ASSERT_SUCCESS(urCommandBufferAppendUSMAdviseExp(
+        cmdBuf, ptr, size, UR_USM_ADVICE_FLAG_SET_PREFERRED_LOCATION_HOST, 1,
+        &prefetched, 0, nullptr, &advised, nullptr, nullptr));
+    const uint32_t pattern = 0xC0FFEE;
+    ASSERT_SUCCESS(urCommandBufferAppendUSMFillExp(
+        cmdBuf, ptr, &pattern, sizeof(pattern), size, 1, &advised, 0, nullptr,
+        nullptr, nullptr, nullptr));
+    ASSERT_SUCCESS(urCommandBufferFinalizeExp(cmdBuf));
+
+    // Replaying the graph runs the hints again
+    for (int run = 0; run < 2; run++) {
+        ASSERT_SUCCESS(urCommandBufferEnqueueExp(cmdBuf, queue, 0, nullptr,
+                                                 nullptr));
+        ASSERT_SUCCESS(urQueueFinish(queue));
+        auto values = static_cast<uint32_t *>(ptr);
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_EQ(values[i], pattern) << "index " << i;
+        }
+        values[0] = 0;
+    }
+
+    ASSERT_SUCCESS(urCommandBufferReleaseExp(cmdBuf));
+    ASSERT_SUCCESS(urUSMFree(context, ptr));
+}
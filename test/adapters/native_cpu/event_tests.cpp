@@ -0,0 +1,206 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "fixtures.hpp"
+
+#include "event.hpp"
+#include "queue.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using nativeCpuEventTest = nativeCpuQueueTest;
+
+namespace {
+
+void writeOne(void *const *args, void *) {
+    *static_cast<uint32_t *>(args[0]) = 1;
+}
+
+// Events of a queue created with profiling enabled.
+struct nativeCpuProfilingTest : nativeCpuContextTest {
+    void SetUp() override {
+        ASSERT_NO_FATAL_FAILURE(nativeCpuContextTest::SetUp());
+        ur_queue_properties_t props = {UR_STRUCTURE_TYPE_QUEUE_PROPERTIES,
+                                       nullptr, UR_QUEUE_FLAG_PROFILING_ENABLE};
+        ASSERT_SUCCESS(urQueueCreate(context, device, &props, &queue));
+    }
+
+    void TearDown() override {
+        if (queue) {
+            EXPECT_SUCCESS(urQueueRelease(queue));
+        }
+        nativeCpuContextTest::TearDown();
+    }
+
+    uint64_t timestamp(ur_event_handle_t event, ur_profiling_info_t info) {
+        uint64_t value = 0;
+        EXPECT_SUCCESS(urEventGetProfilingInfo(event, info, sizeof(value),
+                                               &value, nullptr));
+        return value;
+    }
+
+    // Checks that the timestamps of a completed command are in order.
+    void expectOrderedTimestamps(ur_event_handle_t event) {
+        const uint64_t queued =
+            timestamp(event, UR_PROFILING_INFO_COMMAND_QUEUED);
+        const uint64_t submit =
+            timestamp(event, UR_PROFILING_INFO_COMMAND_SUBMIT);
+        const uint64_t start =
+            timestamp(event, UR_PROFILING_INFO_COMMAND_START);
+        const uint64_t end = timestamp(event, UR_PROFILING_INFO_COMMAND_END);
+        EXPECT_NE(queued, 0u);
+        EXPECT_LE(queued, submit);
+        EXPECT_LE(submit, start);
+        EXPECT_LE(start, end);
+    }
+
+    ur_queue_handle_t queue = nullptr;
+};
+
+} // namespace
+
+TEST_F(nativeCpuEventTest, EventKeepsQueueAlive) {
+    ur_event_handle_t event = nullptr;
+    ASSERT_SUCCESS(urEnqueueEventsWait(queue, 0, nullptr, &event));
+    ASSERT_SUCCESS(urQueueRelease(queue));
+    ur_queue_handle_t released = queue;
+    queue = nullptr;
+
+    ur_queue_handle_t eventQueue = nullptr;
+    ASSERT_SUCCESS(urEventGetInfo(event, UR_EVENT_INFO_COMMAND_QUEUE,
+                                  sizeof(eventQueue), &eventQueue, nullptr));
+    EXPECT_EQ(eventQueue, released);
+    uint32_t refCount = 0;
+    ASSERT_SUCCESS(urQueueGetInfo(eventQueue, UR_QUEUE_INFO_REFERENCE_COUNT,
+                                  sizeof(refCount), &refCount, nullptr));
+    EXPECT_EQ(refCount, 1u);
+    ASSERT_SUCCESS(urEventRelease(event));
+}
+
+// Completing the head of a long chain of commands completes the rest of them
+// without recursing once per command.
+TEST_F(nativeCpuEventTest, LongChainCompletes) {
+    ur_event_handle_t head = nullptr;
+    ASSERT_SUCCESS(queue->enqueue(UR_COMMAND_EVENTS_WAIT, 0, nullptr, nullptr,
+                                  [&head](ur_event_handle_t event) {
+                                      head = event;
+                                  }));
+    ASSERT_NE(head, nullptr);
+
+    constexpr size_t chainLength = 200000;
+    for (size_t i = 0; i < chainLength; i++) {
+        ASSERT_SUCCESS(urEnqueueEventsWait(queue, 0, nullptr, nullptr));
+    }
+    ur_event_handle_t last = nullptr;
+    ASSERT_SUCCESS(urEnqueueEventsWait(queue, 0, nullptr, &last));
+
+    bool isEmpty = true;
+    ASSERT_SUCCESS(urQueueGetInfo(queue, UR_QUEUE_INFO_EMPTY, sizeof(isEmpty),
+                                  &isEmpty, nullptr));
+    EXPECT_FALSE(isEmpty);
+
+    head->complete();
+    decrementOrDelete(head);
+    ASSERT_SUCCESS(urEventWait(1, &last));
+    ASSERT_SUCCESS(urQueueGetInfo(queue, UR_QUEUE_INFO_EMPTY, sizeof(isEmpty),
+                                  &isEmpty, nullptr));
+    EXPECT_TRUE(isEmpty);
+    ASSERT_SUCCESS(urEventRelease(last));
+}
+
+// Callbacks may wait for an event that is only completed by a continuation
+// deferred behind them.
+TEST_F(nativeCpuEventTest, CallbackWaitsOnLaterEvent) {
+    ur_event_handle_t head = nullptr;
+    ASSERT_SUCCESS(queue->enqueue(UR_COMMAND_EVENTS_WAIT, 0, nullptr, nullptr,
+                                  [&head](ur_event_handle_t event) {
+                                      head = event;
+                                  }));
+    ur_event_handle_t first = nullptr;
+    ASSERT_SUCCESS(urEnqueueEventsWait(queue, 0, nullptr, &first));
+
+    // Registered before `second` is enqueued, so that it runs before the
+    // continuation submitting `second`.
+    struct callback_data {
+        ur_event_handle_t second;
+        bool secondComplete;
+    } data = {nullptr, false};
+    ASSERT_SUCCESS(urEventSetCallback(
+        first, UR_EXECUTION_INFO_COMPLETE,
+        [](ur_event_handle_t, ur_execution_info_t, void *userData) {
+            auto data = static_cast<callback_data *>(userData);
+            urEventWait(1, &data->second);
+            data->secondComplete = data->second->isComplete();
+        },
+        &data));
+    ASSERT_SUCCESS(urEnqueueEventsWait(queue, 0, nullptr, &data.second));
+
+    head->complete();
+    decrementOrDelete(head);
+    EXPECT_TRUE(data.secondComplete);
+    ASSERT_SUCCESS(urEventRelease(first));
+    ASSERT_SUCCESS(urEventRelease(data.second));
+}
+
+TEST_F(nativeCpuProfilingTest, KernelTimestampsAreOrdered) {
+    static const struct {
+        const char *name;
+        const void *kernel;
+    } table[] = {{"writeOne", reinterpret_cast<const void *>(writeOne)},
+                 {nullptr, nullptr}};
+    const uint8_t *binary = reinterpret_cast<const uint8_t *>(table);
+    ur_program_handle_t program = nullptr;
+    ASSERT_SUCCESS(urProgramCreateWithBinary(context, 1, &device, nullptr,
+                                             &binary, nullptr, &program));
+    ur_kernel_handle_t kernel = nullptr;
+    ASSERT_SUCCESS(urKernelCreate(program, "writeOne", &kernel));
+    uint32_t value = 0;
+    ASSERT_SUCCESS(urKernelSetArgPointer(kernel, 0, nullptr, &value));
+
+    const size_t offset = 0, size = 1;
+    ur_event_handle_t event = nullptr;
+    ASSERT_SUCCESS(urEnqueueKernelLaunch(queue, kernel, 1, &offset, &size,
+                                         nullptr, 0, nullptr, &event));
+    ASSERT_SUCCESS(urEventWait(1, &event));
+    ASSERT_EQ(value, 1u);
+    expectOrderedTimestamps(event);
+
+    ASSERT_SUCCESS(urEventRelease(event));
+    ASSERT_SUCCESS(urKernelRelease(kernel));
+    ASSERT_SUCCESS(urProgramRelease(program));
+}
+
+TEST_F(nativeCpuProfilingTest, CopyTimestampsAreOrdered) {
+    std::vector<uint32_t> src(1024, 7), dst(1024, 0);
+    ur_event_handle_t event = nullptr;
+    ASSERT_SUCCESS(urEnqueueUSMMemcpy(queue, false, dst.data(), src.data(),
+                                      src.size() * sizeof(uint32_t), 0,
+                                      nullptr, &event));
+    ASSERT_SUCCESS(urEventWait(1, &event));
+    ASSERT_EQ(dst, src);
+    expectOrderedTimestamps(event);
+    ASSERT_SUCCESS(urEventRelease(event));
+}
+
+TEST_F(nativeCpuProfilingTest, TimestampRecordingHasEnd) {
+    ur_event_handle_t event = nullptr;
+    ASSERT_SUCCESS(
+        urEnqueueTimestampRecordingExp(queue, true, 0, nullptr, &event));
+    EXPECT_NE(timestamp(event, UR_PROFILING_INFO_COMMAND_END), 0u);
+    ASSERT_SUCCESS(urEventRelease(event));
+}
+
+// Queues created without profiling don't record timestamps for their events.
+TEST_F(nativeCpuEventTest, NoProfilingWithoutProfilingQueue) {
+    ur_event_handle_t event = nullptr;
+    ASSERT_SUCCESS(urEnqueueEventsWait(queue, 0, nullptr, &event));
+    ASSERT_SUCCESS(urEventWait(1, &event));
+    uint64_t value = 0;
+    ASSERT_EQ(urEventGetProfilingInfo(event, UR_PROFILING_INFO_COMMAND_END,
+                                      sizeof(value), &value, nullptr),
+              UR_RESULT_ERROR_PROFILING_INFO_NOT_AVAILABLE);
+    ASSERT_SUCCESS(urEventRelease(event));
+}
@@ -0,0 +1,65 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef UR_TEST_ADAPTERS_NATIVE_CPU_FIXTURES_HPP_INCLUDED
+#define UR_TEST_ADAPTERS_NATIVE_CPU_FIXTURES_HPP_INCLUDED
+
+#include <gtest/gtest.h>
+#include <ur_api.h>
+
+#ifndef ASSERT_SUCCESS
+#define ASSERT_SUCCESS(ACTUAL) ASSERT_EQ(UR_RESULT_SUCCESS, ACTUAL)
+#endif
+
+#ifndef EXPECT_SUCCESS
+#define EXPECT_SUCCESS(ACTUAL) EXPECT_EQ(UR_RESULT_SUCCESS, ACTUAL)
+#endif
+
+// The tests are linked with the adapter itself rather than the loader, so
+// entry points are called on the adapter directly.
+struct nativeCpuContextTest : ::testing::Test {
+    void SetUp() override {
+        ASSERT_SUCCESS(urAdapterGet(1, &adapter, nullptr));
+        ASSERT_SUCCESS(urPlatformGet(&adapter, 1, 1, &platform, nullptr));
+        ASSERT_SUCCESS(
+            urDeviceGet(platform, UR_DEVICE_TYPE_ALL, 1, &device, nullptr));
+        ASSERT_SUCCESS(urContextCreate(1, &device, nullptr, &context));
+    }
+
+    void TearDown() override {
+        if (context) {
+            EXPECT_SUCCESS(urContextRelease(context));
+        }
+        if (device) {
+            EXPECT_SUCCESS(urDeviceRelease(device));
+        }
+        if (adapter) {
+            EXPECT_SUCCESS(urAdapterRelease(adapter));
+        }
+    }
+
+    ur_adapter_handle_t adapter = nullptr;
+    ur_platform_handle_t platform = nullptr;
+    ur_device_handle_t device = nullptr;
+    ur_context_handle_t context = nullptr;
+};
+
+struct nativeCpuQueueTest : nativeCpuContextTest {
+    void SetUp() override {
+        ASSERT_NO_FATAL_FAILURE(nativeCpuContextTest::SetUp());
+        ASSERT_SUCCESS(urQueueCreate(context, device, nullptr, &queue));
+    }
+
+    void TearDown() override {
+        if (queue) {
+            EXPECT_SUCCESS(urQueueRelease(queue));
+        }
+        nativeCpuContextTest::TearDown();
+    }
+
+    ur_queue_handle_t queue = nullptr;
+};
+
+#endif // UR_TEST_ADAPTERS_NATIVE_CPU_FIXTURES_HPP_INCLUDED
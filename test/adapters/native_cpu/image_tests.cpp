@@ -0,0 +1,124 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "fixtures.hpp"
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+constexpr ur_image_format_t format = {UR_IMAGE_CHANNEL_ORDER_RGBA,
+                                      UR_IMAGE_CHANNEL_TYPE_UNSIGNED_INT32};
+
+ur_image_desc_t makeDesc(ur_mem_type_t type, size_t width, size_t height,
+                         size_t depth) {
+    return {UR_STRUCTURE_TYPE_IMAGE_DESC,
+            nullptr,
+            type,
+            width,
+            height,
+            depth,
+            1,
+            0,
+            0,
+            0,
+            0};
+}
+
+} // namespace
+
+using nativeCpuImageTest = nativeCpuQueueTest;
+
+// Images with a single row are laid out linearly rather than in tiles.
+TEST_F(nativeCpuImageTest, Image1DCopyWriteRead) {
+    constexpr size_t width = 1000;
+    std::vector<uint32_t> initial(width * 4);
+    std::iota(initial.begin(), initial.end(), 0);
+
+    const auto desc = makeDesc(UR_MEM_TYPE_IMAGE1D, width, 1, 1);
+    ur_mem_handle_t image = nullptr;
+    ASSERT_SUCCESS(urMemImageCreate(context,
+                                    UR_MEM_FLAG_READ_WRITE |
+                                        UR_MEM_FLAG_ALLOC_COPY_HOST_POINTER,
+                                    &format, &desc, initial.data(), &image));
+
+    const ur_rect_offset_t origin = {0, 0, 0};
+    const ur_rect_region_t region = {width, 1, 1};
+    std::vector<uint32_t> result(initial.size());
+    ASSERT_SUCCESS(urEnqueueMemImageRead(queue, image, true, origin, region, 0,
+                                         0, result.data(), 0, nullptr,
+                                         nullptr));
+    EXPECT_EQ(result, initial);
+
+    std::vector<uint32_t> written(initial.rbegin(), initial.rend());
+    ASSERT_SUCCESS(urEnqueueMemImageWrite(queue, image, true, origin, region,
+                                          0, 0, written.data(), 0, nullptr,
+                                          nullptr));
+    ASSERT_SUCCESS(urEnqueueMemImageRead(queue, image, true, origin, region, 0,
+                                         0, result.data(), 0, nullptr,
+                                         nullptr));
+    EXPECT_EQ(result, written);
+
+    ASSERT_SUCCESS(urMemRelease(image));
+}
+
+TEST_F(nativeCpuImageTest, Image2DSingleRowWriteRead) {
+    constexpr size_t width = 77;
+    std::vector<uint32_t> data(width * 4);
+    std::iota(data.begin(), data.end(), 7);
+
+    const auto desc = makeDesc(UR_MEM_TYPE_IMAGE2D, width, 1, 1);
+    ur_mem_handle_t image = nullptr;
+    ASSERT_SUCCESS(urMemImageCreate(context, UR_MEM_FLAG_READ_WRITE, &format,
+                                    &desc, nullptr, &image));
+
+    const ur_rect_offset_t origin = {0, 0, 0};
+    const ur_rect_region_t region = {width, 1, 1};
+    ASSERT_SUCCESS(urEnqueueMemImageWrite(queue, image, true, origin, region,
+                                          0, 0, data.data(), 0, nullptr,
+                                          nullptr));
+    std::vector<uint32_t> result(data.size());
+    ASSERT_SUCCESS(urEnqueueMemImageRead(queue, image, true, origin, region, 0,
+                                         0, result.data(), 0, nullptr,
+                                         nullptr));
+    EXPECT_EQ(result, data);
+
+    ASSERT_SUCCESS(urMemRelease(image));
+}
+
+// Host data used in place keeps its linear layout, with the pitch given.
+TEST_F(nativeCpuImageTest, Image2DUseHostPointerPitch) {
+    constexpr size_t width = 5, height = 3, pitchElements = 8;
+    std::vector<uint32_t> host(pitchElements * 4 * height, 0);
+    for (size_t y = 0; y < height; y++) {
+        for (size_t i = 0; i < width * 4; i++) {
+            host[y * pitchElements * 4 + i] = uint32_t(y * 100 + i);
+        }
+    }
+
+    auto desc = makeDesc(UR_MEM_TYPE_IMAGE2D, width, height, 1);
+    desc.rowPitch = pitchElements * 4 * sizeof(uint32_t);
+    ur_mem_handle_t image = nullptr;
+    ASSERT_SUCCESS(urMemImageCreate(context,
+                                    UR_MEM_FLAG_READ_WRITE |
+                                        UR_MEM_FLAG_USE_HOST_POINTER,
+                                    &format, &desc, host.data(), &image));
+
+    const ur_rect_offset_t origin = {0, 0, 0};
+    const ur_rect_region_t region = {width, height, 1};
+    std::vector<uint32_t> result(width * 4 * height);
+    ASSERT_SUCCESS(urEnqueueMemImageRead(queue, image, true, origin, region, 0,
+                                         0, result.data(), 0, nullptr,
+                                         nullptr));
+    for (size_t y = 0; y < height; y++) {
+        for (size_t i = 0; i < width * 4; i++) {
+            EXPECT_EQ(result[y * width * 4 + i], uint32_t(y * 100 + i));
+        }
+    }
+
+    ASSERT_SUCCESS(urMemRelease(image));
+}
@@ -0,0 +1,190 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "fixtures.hpp"
+#include "kernel.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using native_cpu::arg_arena;
+
+namespace {
+
+// Value arguments as the kernel would see them
+template <typename T> T argValue(const arg_arena &arena, uint32_t index) {
+    T value;
+    std::memcpy(&value, arena.getArgs()[index].MPtr, sizeof(T));
+    return value;
+}
+
+bool isInArena(const arg_arena &arena, uint32_t index) {
+    auto begin = reinterpret_cast<const char *>(&arena);
+    auto ptr = static_cast<const char *>(arena.getArgs()[index].MPtr);
+    return ptr >= begin && ptr < begin + sizeof(arena);
+}
+
+bool isAligned(const arg_arena &arena, uint32_t index, size_t alignment) {
+    return reinterpret_cast<uintptr_t>(arena.getArgs()[index].MPtr) %
+               alignment ==
+           0;
+}
+
+} // namespace
+
+TEST(ArgArenaTest, SmallValuesAreInline) {
+    arg_arena arena;
+    uint32_t a = 7;
+    uint64_t b = 42;
+    arena.setValue(0, &a, sizeof(a));
+    arena.setValue(1, &b, sizeof(b));
+    ASSERT_TRUE(isInArena(arena, 0));
+    ASSERT_TRUE(isInArena(arena, 1));
+    ASSERT_TRUE(isAligned(arena, 1, sizeof(b)));
+    ASSERT_EQ(argValue<uint32_t>(arena, 0), 7u);
+    ASSERT_EQ(argValue<uint64_t>(arena, 1), 42u);
+
+    // Setting the same argument again reuses its slot
+    const void *slot = arena.getArgs()[0].MPtr;
+    a = 8;
+    arena.setValue(0, &a, sizeof(a));
+    ASSERT_EQ(arena.getArgs()[0].MPtr, slot);
+    ASSERT_EQ(argValue<uint32_t>(arena, 0), 8u);
+}
+
+TEST(ArgArenaTest, GrowingKeepsValues) {
+    arg_arena arena;
+    constexpr uint32_t numArgs = 64;
+    for (uint32_t i = 0; i < numArgs; i++) {
+        uint64_t value = i * 3;
+        arena.setValue(i, &value, sizeof(value));
+    }
+    // A value bigger than the inline storage, and one whose size changes
+    std::array<char, 1000> big;
+    big.fill('x');
+    arena.setValue(numArgs, big.data(), big.size());
+    uint32_t small = 5;
+    arena.setValue(1, &small, sizeof(small));
+
+    ASSERT_FALSE(isInArena(arena, numArgs));
+    ASSERT_TRUE(isAligned(arena, numArgs, 64));
+    ASSERT_EQ(std::memcmp(arena.getArgs()[numArgs].MPtr, big.data(),
+                          big.size()),
+              0);
+    ASSERT_EQ(argValue<uint32_t>(arena, 1), 5u);
+    for (uint32_t i = 0; i < numArgs; i++) {
+        if (i != 1) {
+            ASSERT_EQ(argValue<uint64_t>(arena, i), i * 3) << "arg " << i;
+            ASSERT_TRUE(isAligned(arena, i, sizeof(uint64_t)));
+        }
+    }
+}
+
+TEST(ArgArenaTest, CopiesPointIntoTheirOwnStorage) {
+    for (size_t size : {sizeof(uint32_t), size_t{1000}}) {
+        arg_arena arena;
+        std::vector<char> value(size, 'a');
+        int pointee = 0;
+        arena.setValue(0, value.data(), size);
+        arena.setPointer(1, &pointee);
+        arena.setLocal(2, 128);
+
+        arg_arena copy(arena);
+        ASSERT_EQ(copy.getReferenceCount(), 1u);
+        ASSERT_NE(copy.getArgs()[0].MPtr, arena.getArgs()[0].MPtr);
+        ASSERT_EQ(copy.getArgs()[1].MPtr, &pointee);
+        ASSERT_EQ(copy.getLocalArgInfo().size(), 1u);
+        ASSERT_EQ(std::memcmp(copy.getArgs()[0].MPtr, value.data(), size), 0);
+
+        // Changing the copy leaves the original alone
+        std::vector<char> other(size, 'b');
+        copy.setValue(0, other.data(), size);
+        ASSERT_EQ(std::memcmp(arena.getArgs()[0].MPtr, value.data(), size),
+                  0);
+    }
+}
+
+TEST(ArgArenaTest, ArgumentKinds) {
+    arg_arena arena;
+    uint32_t value = 3;
+    arena.setLocal(0, 64);
+    arena.setLocal(0, 256);
+    ASSERT_EQ(arena.getLocalArgInfo().size(), 1u);
+    ASSERT_EQ(arena.getLocalArgInfo()[0].argSize, 256u);
+    ASSERT_EQ(arena.getArgs()[0].MPtr, nullptr);
+
+    // A local argument set to a value is no longer local
+    arena.setValue(0, &value, sizeof(value));
+    ASSERT_TRUE(arena.getLocalArgInfo().empty());
+    ASSERT_EQ(argValue<uint32_t>(arena, 0), 3u);
+
+    arena.setPointer(0, &value);
+    ASSERT_EQ(arena.getArgs()[0].MPtr, &value);
+}
+
+namespace {
+
+void noop(void *const *, void *) {}
+
+struct nativeCpuKernelTest : nativeCpuContextTest {
+    void SetUp() override {
+        ASSERT_NO_FATAL_FAILURE(nativeCpuContextTest::SetUp());
+        static const struct {
+            const char *name;
+            const void *kernel;
+        } table[] = {{"noop", reinterpret_cast<const void *>(noop)},
+                     {nullptr, nullptr}};
+        const uint8_t *binary = reinterpret_cast<const uint8_t *>(table);
+        ASSERT_SUCCESS(urProgramCreateWithBinary(context, 1, &device, nullptr,
+                                                 &binary, nullptr, &program));
+        ASSERT_SUCCESS(urKernelCreate(program, "noop", &kernel));
+    }
+
+    void TearDown() override {
+        if (kernel) {
+            EXPECT_SUCCESS(urKernelRelease(kernel));
+        }
+        if (program) {
+            EXPECT_SUCCESS(urProgramRelease(program));
+        }
+        nativeCpuContextTest::TearDown();
+    }
+
+    ur_program_handle_t program = nullptr;
+    ur_kernel_handle_t kernel = nullptr;
+};
+
+} // namespace
+
+TEST_F(nativeCpuKernelTest, SetArgCopiesOnlyWhenShared) {
+    uint32_t value = 1;
+    ASSERT_SUCCESS(
+        urKernelSetArgValue(kernel, 0, sizeof(value), nullptr, &value));
+    arg_arena *arena = kernel->getArgArena();
+    value = 2;
+    ASSERT_SUCCESS(
+        urKernelSetArgValue(kernel, 0, sizeof(value), nullptr, &value));
+    ASSERT_EQ(kernel->getArgArena(), arena);
+
+    {
+        // A launch that hasn't run yet keeps the arguments it was enqueued
+        // with, while the kernel moves on to a copy
+        native_cpu::kernel_launch launch(kernel, kernel->getArgArena());
+        value = 3;
+        ASSERT_SUCCESS(
+            urKernelSetArgValue(kernel, 0, sizeof(value), nullptr, &value));
+        ASSERT_NE(kernel->getArgArena(), arena);
+        ASSERT_EQ(argValue<uint32_t>(*arena, 0), 2u);
+        ASSERT_EQ(argValue<uint32_t>(*kernel->getArgArena(), 0), 3u);
+        ASSERT_EQ(arena->getReferenceCount(), 1u);
+    }
+
+    // Once the launch is gone the kernel's arena isn't shared anymore
+    arena = kernel->getArgArena();
+    ASSERT_SUCCESS(urKernelSetArgPointer(kernel, 1, nullptr, &value));
+    ASSERT_EQ(kernel->getArgArena(), arena);
+}
@@ -0,0 +1,79 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "latch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using native_cpu::latch;
+
+TEST(nativeCpuLatch, CountDown) {
+    latch l(3);
+    ASSERT_FALSE(l.try_wait());
+    ASSERT_FALSE(l.count_down());
+    ASSERT_FALSE(l.count_down());
+    ASSERT_FALSE(l.try_wait());
+    // Only the last count down reports it
+    ASSERT_TRUE(l.count_down());
+    ASSERT_TRUE(l.try_wait());
+    l.wait();
+}
+
+TEST(nativeCpuLatch, ZeroCount) {
+    latch l(0);
+    ASSERT_TRUE(l.try_wait());
+    l.wait();
+}
+
+// The waiter runs out of spins and sleeps, and is woken by the last count
+// down.
+TEST(nativeCpuLatch, WaiterSleepsUntilLastCountDown) {
+    latch l(2);
+    std::atomic<bool> woken = false;
+    std::thread waiter([&]() {
+        l.wait();
+        woken = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    l.count_down();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_FALSE(woken);
+    ASSERT_TRUE(l.count_down());
+    waiter.join();
+    ASSERT_TRUE(woken);
+}
+
+// What threads write before counting down is visible once wait() returns,
+// and the waiter may free the latch straight away while the last count down
+// is still returning.
+TEST(nativeCpuLatch, WaiterFreesLatch) {
+    constexpr size_t numThreads = 4;
+    constexpr size_t numRounds = 200;
+    for (size_t round = 0; round < numRounds; round++) {
+        auto l = std::make_unique<latch>(numThreads);
+        std::vector<size_t> results(numThreads, 0);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < numThreads; t++) {
+            threads.emplace_back([&, t, l = l.get()]() {
+                results[t] = round + t;
+                l->count_down();
+            });
+        }
+        l->wait();
+        l.reset();
+        for (size_t t = 0; t < numThreads; t++) {
+            ASSERT_EQ(results[t], round + t) << "round " << round;
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+}
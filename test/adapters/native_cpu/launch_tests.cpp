@@ -0,0 +1,149 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "fixtures.hpp"
+#include "nativecpu_state.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr size_t localSize = 4096;
+
+// Fills its local argument and counts the work-items that ran. Arguments are
+// passed as an array of pointers, the local one pointing into the local
+// memory of the work-group.
+void fillLocal(void *const *args, void *) {
+    std::memset(args[0], 0xAB, localSize);
+    static_cast<std::atomic<uint32_t> *>(args[1])->fetch_add(1);
+}
+
+// Counts the runs of each work-item, indexed by its linear global ID, and the
+// items whose IDs don't add up.
+struct item_counts {
+    size_t range[3];
+    size_t offset[3];
+    std::vector<std::atomic<uint32_t>> runs;
+    std::atomic<uint32_t> mismatches;
+};
+
+void countItem(void *const *args, void *s) {
+    auto *counts = static_cast<item_counts *>(args[0]);
+    auto *st = static_cast<native_cpu::state *>(s);
+    size_t linear = 0;
+    for (int dim = 2; dim >= 0; dim--) {
+        const size_t id = st->MWorkGroup_id[dim] * st->MWorkGroup_size[dim] +
+                          st->MLocal_id[dim] + counts->offset[dim];
+        if (id != st->MGlobal_id[dim] ||
+            st->MLocal_id[dim] >= st->MWorkGroup_size[dim]) {
+            counts->mismatches++;
+        }
+        linear = linear * counts->range[dim] + id - counts->offset[dim];
+    }
+    counts->runs[linear]++;
+}
+
+struct nativeCpuLaunchTest : nativeCpuQueueTest {
+    void SetUp() override {
+        ASSERT_NO_FATAL_FAILURE(nativeCpuQueueTest::SetUp());
+        // A program created from a table of kernels linked into the host
+        static const struct {
+            const char *name;
+            const void *kernel;
+        } table[] = {{"fillLocal", reinterpret_cast<const void *>(fillLocal)},
+                     {"countItem", reinterpret_cast<const void *>(countItem)},
+                     {nullptr, nullptr}};
+        const uint8_t *binary = reinterpret_cast<const uint8_t *>(table);
+        ASSERT_SUCCESS(urProgramCreateWithBinary(context, 1, &device, nullptr,
+                                                 &binary, nullptr, &program));
+        ASSERT_SUCCESS(urKernelCreate(program, "fillLocal", &kernel));
+        ASSERT_SUCCESS(urKernelSetArgPointer(kernel, 1, nullptr, &count));
+    }
+
+    void TearDown() override {
+        if (kernel) {
+            EXPECT_SUCCESS(urKernelRelease(kernel));
+        }
+        if (program) {
+            EXPECT_SUCCESS(urProgramRelease(program));
+        }
+        nativeCpuQueueTest::TearDown();
+    }
+
+    ur_program_handle_t program = nullptr;
+    ur_kernel_handle_t kernel = nullptr;
+    std::atomic<uint32_t> count = 0;
+};
+
+} // namespace
+
+TEST_F(nativeCpuLaunchTest, LocalMemoryWithinDeviceLimit) {
+    ASSERT_SUCCESS(urKernelSetArgLocal(kernel, 0, localSize, nullptr));
+    const size_t offset = 0;
+    const size_t globalSize = 64;
+    const size_t groupSize = 8;
+    ur_event_handle_t event = nullptr;
+    ASSERT_SUCCESS(urEnqueueKernelLaunch(queue, kernel, 1, &offset,
+                                         &globalSize, &groupSize, 0, nullptr,
+                                         &event));
+    ASSERT_SUCCESS(urEventWait(1, &event));
+    EXPECT_EQ(count.load(), globalSize);
+
+    ur_event_status_t status;
+    ASSERT_SUCCESS(urEventGetInfo(event, UR_EVENT_INFO_COMMAND_EXECUTION_STATUS,
+                                  sizeof(status), &status, nullptr));
+    EXPECT_EQ(status, UR_EVENT_STATUS_COMPLETE);
+    ASSERT_SUCCESS(urEventRelease(event));
+}
+
+// Launches whose local arguments don't fit in the device's local memory are
+// rejected when they are enqueued rather than failing when they run.
+TEST_F(nativeCpuLaunchTest, LocalMemoryOverDeviceLimit) {
+    uint64_t deviceLocalMemSize = 0;
+    ASSERT_SUCCESS(urDeviceGetInfo(device, UR_DEVICE_INFO_LOCAL_MEM_SIZE,
+                                   sizeof(deviceLocalMemSize),
+                                   &deviceLocalMemSize, nullptr));
+    ASSERT_SUCCESS(
+        urKernelSetArgLocal(kernel, 0, deviceLocalMemSize + 1, nullptr));
+    const size_t offset = 0;
+    const size_t globalSize = 1;
+    EXPECT_EQ(urEnqueueKernelLaunch(queue, kernel, 1, &offset, &globalSize,
+                                    nullptr, 0, nullptr, nullptr),
+              UR_RESULT_ERROR_OUT_OF_RESOURCES);
+
+    ur_exp_command_buffer_handle_t cmdBuf = nullptr;
+    ASSERT_SUCCESS(urCommandBufferCreateExp(context, device, nullptr, &cmdBuf));
+    EXPECT_EQ(urCommandBufferAppendKernelLaunchExp(
+                  cmdBuf, kernel, 1, &offset, &globalSize, nullptr, 0,
+                  nullptr, 0, nullptr, 0, nullptr, nullptr, nullptr, nullptr),
+              UR_RESULT_ERROR_OUT_OF_RESOURCES);
+    ASSERT_SUCCESS(urCommandBufferReleaseExp(cmdBuf));
+    EXPECT_EQ(count.load(), 0u);
+}
+
+// Work-groups are linearized and claimed in chunks, every item of every
+// group still runs once with its own IDs.
+TEST_F(nativeCpuLaunchTest, NDRangeRunsEveryItemOnce) {
+    ur_kernel_handle_t countKernel = nullptr;
+    ASSERT_SUCCESS(urKernelCreate(program, "countItem", &countKernel));
+    const size_t offset[3] = {3, 0, 5};
+    const size_t globalSize[3] = {64, 6, 10};
+    const size_t groupSize[3] = {4, 3, 2};
+    item_counts counts{{64, 6, 10}, {3, 0, 5}, {}, 0};
+    counts.runs = std::vector<std::atomic<uint32_t>>(64 * 6 * 10);
+    ASSERT_SUCCESS(urKernelSetArgPointer(countKernel, 0, nullptr, &counts));
+    ASSERT_SUCCESS(urEnqueueKernelLaunch(queue, countKernel, 3, offset,
+                                         globalSize, groupSize, 0, nullptr,
+                                         nullptr));
+    ASSERT_SUCCESS(urQueueFinish(queue));
+    EXPECT_EQ(counts.mismatches.load(), 0u);
+    for (size_t i = 0; i < counts.runs.size(); i++) {
+        ASSERT_EQ(counts.runs[i].load(), 1u) << "item " << i;
+    }
+    ASSERT_SUCCESS(urKernelRelease(countKernel));
+}
@@ -0,0 +1,129 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "fixtures.hpp"
+#include "memory.hpp"
+#include "transfer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using native_cpu::lazy_host_copy;
+using native_cpu::transfer_chunk_size;
+
+namespace {
+
+std::vector<char> makeHostData(size_t size) {
+    std::vector<char> data(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = char(i % 251 + 1);
+    }
+    return data;
+}
+
+struct nativeCpuLazyCopyTest : ::testing::Test {
+    // Several chunks, the last of them partial
+    static constexpr size_t size = 5 * transfer_chunk_size + 1000;
+
+    bool isCopied(size_t begin, size_t end) {
+        return std::equal(dst.begin() + begin, dst.begin() + end,
+                          src.begin() + begin);
+    }
+
+    bool isUntouched(size_t begin, size_t end) {
+        return std::all_of(dst.begin() + begin, dst.begin() + end,
+                           [](char c) { return c == 0; });
+    }
+
+    native_cpu::threadpool_t pool{
+        std::vector<native_cpu::worker_placement>(4)};
+    std::vector<char> src = makeHostData(size);
+    std::vector<char> dst = std::vector<char>(size, 0);
+};
+
+} // namespace
+
+TEST_F(nativeCpuLazyCopyTest, CopiesOnlyTheChunksUsed) {
+    lazy_host_copy copy(pool, dst.data(), src.data(), size);
+    ASSERT_TRUE(isUntouched(0, size));
+
+    // A range within chunk 1 and one straddling chunks 3 and 4
+    copy.materialize(transfer_chunk_size + 10, 100);
+    copy.materialize(4 * transfer_chunk_size - 1, 2);
+    ASSERT_TRUE(isUntouched(0, transfer_chunk_size));
+    ASSERT_TRUE(isCopied(transfer_chunk_size, 2 * transfer_chunk_size));
+    ASSERT_TRUE(isUntouched(2 * transfer_chunk_size, 3 * transfer_chunk_size));
+    ASSERT_TRUE(isCopied(3 * transfer_chunk_size, 5 * transfer_chunk_size));
+    ASSERT_TRUE(isUntouched(5 * transfer_chunk_size, size));
+
+    // Ranges past the end are clamped, empty ones do nothing
+    copy.materialize(size, 10);
+    copy.materialize(0, 0);
+    ASSERT_TRUE(isUntouched(0, transfer_chunk_size));
+    copy.materialize(size - 1, SIZE_MAX);
+    ASSERT_TRUE(isCopied(5 * transfer_chunk_size, size));
+
+    copy.materialize(0, SIZE_MAX);
+    ASSERT_TRUE(isCopied(0, size));
+}
+
+// Chunks are copied once, whichever thread claims them, and materialize only
+// returns once the whole range has been copied.
+TEST_F(nativeCpuLazyCopyTest, ConcurrentMaterialize) {
+    lazy_host_copy copy(pool, dst.data(), src.data(), size);
+    constexpr size_t numThreads = 8;
+    std::vector<std::thread> threads;
+    std::vector<bool> copied(numThreads);
+    for (size_t t = 0; t < numThreads; t++) {
+        threads.emplace_back([&, t]() {
+            // Overlapping ranges that start in different chunks
+            const size_t begin = t * size / numThreads;
+            const size_t len = size / 2;
+            copy.materialize(begin, len);
+            copied[t] = isCopied(begin, std::min(size, begin + len));
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (size_t t = 0; t < numThreads; t++) {
+        ASSERT_TRUE(copied[t]) << "thread " << t;
+    }
+    ASSERT_TRUE(isCopied(0, size));
+}
+
+// Buffers created from host data read back the data, whether or not it was
+// copied up front.
+TEST_F(nativeCpuQueueTest, LazyCopyHostPointer) {
+    setenv("UR_NATIVE_CPU_LAZY_COPY_HOST_POINTER", "1", 1);
+    ASSERT_TRUE(native_cpu::lazy_copy_host_pointer());
+    unsetenv("UR_NATIVE_CPU_LAZY_COPY_HOST_POINTER");
+
+    const size_t size = 2 * native_cpu::mapped_buffer_threshold + 123;
+    auto host = makeHostData(size);
+    ur_buffer_properties_t properties = {UR_STRUCTURE_TYPE_BUFFER_PROPERTIES,
+                                         nullptr, host.data()};
+    ur_mem_handle_t buffer = nullptr;
+    ASSERT_SUCCESS(urMemBufferCreate(context, UR_MEM_FLAG_ALLOC_COPY_HOST_POINTER,
+                                     size, &properties, &buffer));
+    // Nothing is copied until a command uses the buffer
+    ASSERT_EQ(buffer->_mem[0], 0);
+
+    std::vector<char> part(1000);
+    const size_t offset = native_cpu::mapped_buffer_threshold - 500;
+    ASSERT_SUCCESS(urEnqueueMemBufferRead(queue, buffer, true, offset,
+                                          part.size(), part.data(), 0, nullptr,
+                                          nullptr));
+    ASSERT_TRUE(std::equal(part.begin(), part.end(), host.begin() + offset));
+
+    std::vector<char> all(size);
+    ASSERT_SUCCESS(urEnqueueMemBufferRead(queue, buffer, true, 0, size,
+                                          all.data(), 0, nullptr, nullptr));
+    ASSERT_EQ(all, host);
+    ASSERT_SUCCESS(urMemRelease(buffer));
+}
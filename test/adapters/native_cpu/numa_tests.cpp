@@ -0,0 +1,174 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "device.hpp"
+#include "fixtures.hpp"
+#include "numa.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+using native_cpu::affinity_policy;
+using native_cpu::get_numa_nodes;
+using native_cpu::get_worker_placement;
+using native_cpu::numa_node;
+
+namespace {
+
+// A fake /sys/devices/system/node, removed when the test ends
+struct NumaNodesTest : ::testing::Test {
+    void SetUp() override {
+        root = fs::temp_directory_path() /
+               ("native_cpu_numa_" + std::to_string(getpid()));
+        fs::create_directories(root);
+        // Without NUMA information every CPU we may run on is in one node
+        auto fallback = get_numa_nodes((root / "missing").string());
+        ASSERT_EQ(fallback.size(), 1u);
+        allowed = fallback[0].cpus;
+        ASSERT_FALSE(allowed.empty());
+    }
+
+    void TearDown() override { fs::remove_all(root); }
+
+    void write(const std::string &path, const std::string &contents) {
+        fs::create_directories((root / path).parent_path());
+        std::ofstream(root / path) << contents << "\n";
+    }
+
+    std::vector<numa_node> read() { return get_numa_nodes(root.string()); }
+
+    fs::path root;
+    std::vector<unsigned> allowed;
+};
+
+} // namespace
+
+TEST_F(NumaNodesTest, ParsesRangesAndSingleValues) {
+    write("online", "0,2-3");
+    write("node0/cpulist", "0-3,8,10-11");
+    // Every CPU we may run on, as single values and as a range
+    std::string singles;
+    for (unsigned cpu : allowed) {
+        singles += (singles.empty() ? "" : ",") + std::to_string(cpu);
+    }
+    write("node2/cpulist", singles);
+    write("node3/cpulist", "0-" + std::to_string(allowed.back()));
+
+    std::vector<unsigned> first;
+    for (unsigned cpu : {0u, 1u, 2u, 3u, 8u, 10u, 11u}) {
+        if (std::binary_search(allowed.begin(), allowed.end(), cpu)) {
+            first.push_back(cpu);
+        }
+    }
+    // Node 0 is skipped if we may run on none of its CPUs
+    const size_t i = first.empty() ? 0 : 1;
+    auto nodes = read();
+    ASSERT_EQ(nodes.size(), i + 2);
+    if (i) {
+        ASSERT_EQ(nodes[0].id, 0u);
+        ASSERT_EQ(nodes[0].cpus, first);
+    }
+    ASSERT_EQ(nodes[i].id, 2u);
+    ASSERT_EQ(nodes[i].cpus, allowed);
+    ASSERT_EQ(nodes[i + 1].id, 3u);
+    ASSERT_EQ(nodes[i + 1].cpus, allowed);
+}
+
+TEST_F(NumaNodesTest, SkipsNodesWithoutUsableCpus) {
+    write("online", "0-2");
+    // A memory-only node, and one whose CPUs we aren't allowed to run on
+    write("node0/cpulist", "");
+    write("node1/cpulist", std::to_string(allowed.back() + 1000));
+    write("node2/cpulist", "0-" + std::to_string(allowed.back()));
+    auto nodes = read();
+    ASSERT_EQ(nodes.size(), 1u);
+    ASSERT_EQ(nodes[0].id, 2u);
+    ASSERT_EQ(nodes[0].cpus, allowed);
+}
+
+TEST_F(NumaNodesTest, MissingNodesFallBackToOneNode) {
+    write("online", "0-1");
+    auto nodes = read();
+    ASSERT_EQ(nodes.size(), 1u);
+    ASSERT_EQ(nodes[0].id, 0u);
+    ASSERT_EQ(nodes[0].cpus, allowed);
+}
+
+TEST(WorkerPlacementTest, Policies) {
+    const std::vector<numa_node> nodes = {{0, {0, 1}}, {1, {4, 5}}};
+
+    auto none = get_worker_placement(3, affinity_policy::none, nodes);
+    ASSERT_EQ(none.size(), 3u);
+    for (auto &worker : none) {
+        ASSERT_TRUE(worker.cpus.empty());
+    }
+
+    // Fill the first node, then the next, then start over
+    auto compact = get_worker_placement(5, affinity_policy::compact, nodes);
+    const unsigned compactCpus[] = {0, 1, 4, 5, 0};
+    const size_t compactNodes[] = {0, 0, 1, 1, 0};
+    for (size_t i = 0; i < 5; i++) {
+        ASSERT_EQ(compact[i].cpus, std::vector<unsigned>{compactCpus[i]});
+        ASSERT_EQ(compact[i].node, compactNodes[i]);
+    }
+
+    // Round-robin across the nodes
+    auto scatter = get_worker_placement(5, affinity_policy::scatter, nodes);
+    const unsigned scatterCpus[] = {0, 4, 1, 5, 0};
+    for (size_t i = 0; i < 5; i++) {
+        ASSERT_EQ(scatter[i].cpus, std::vector<unsigned>{scatterCpus[i]});
+        ASSERT_EQ(scatter[i].node, i % 2);
+    }
+
+    // Split like compact, but free to run anywhere on the node
+    auto numa = get_worker_placement(4, affinity_policy::numa, nodes);
+    for (size_t i = 0; i < 4; i++) {
+        ASSERT_EQ(numa[i].node, i / 2);
+        ASSERT_EQ(numa[i].cpus, nodes[i / 2].cpus);
+    }
+}
+
+// The partitioning queries are answered from the device's NUMA nodes, and
+// agree with what partitioning then creates.
+TEST_F(nativeCpuContextTest, PartitionInfoMatchesPartition) {
+    uint32_t maxSubDevices = 0;
+    ASSERT_SUCCESS(urDeviceGetInfo(device,
+                                   UR_DEVICE_INFO_PARTITION_MAX_SUB_DEVICES,
+                                   sizeof(maxSubDevices), &maxSubDevices,
+                                   nullptr));
+    ASSERT_EQ(maxSubDevices, device->getNumSubDevices());
+    size_t partitionsSize = 0;
+    ASSERT_SUCCESS(urDeviceGetInfo(device, UR_DEVICE_INFO_SUPPORTED_PARTITIONS,
+                                   0, nullptr, &partitionsSize));
+    ur_device_affinity_domain_flags_t domains = 0;
+    ASSERT_SUCCESS(urDeviceGetInfo(device,
+                                   UR_DEVICE_INFO_PARTITION_AFFINITY_DOMAIN,
+                                   sizeof(domains), &domains, nullptr));
+
+    ur_device_partition_property_t property = {
+        UR_DEVICE_PARTITION_BY_AFFINITY_DOMAIN, {}};
+    property.value.affinity_domain = UR_DEVICE_AFFINITY_DOMAIN_FLAG_NUMA;
+    ur_device_partition_properties_t properties = {
+        UR_STRUCTURE_TYPE_DEVICE_PARTITION_PROPERTIES, nullptr, &property, 1};
+    uint32_t numSubDevices = 0;
+    auto result =
+        urDevicePartition(device, &properties, 0, nullptr, &numSubDevices);
+    if (maxSubDevices == 0) {
+        ASSERT_EQ(partitionsSize, 0u);
+        ASSERT_EQ(domains, 0u);
+        ASSERT_EQ(result, UR_RESULT_ERROR_DEVICE_PARTITION_FAILED);
+    } else {
+        ASSERT_EQ(partitionsSize, sizeof(ur_device_partition_t));
+        ASSERT_NE(domains & UR_DEVICE_AFFINITY_DOMAIN_FLAG_NUMA, 0u);
+        ASSERT_SUCCESS(result);
+        ASSERT_EQ(numSubDevices, maxSubDevices);
+    }
+}
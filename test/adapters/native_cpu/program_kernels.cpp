@@ -0,0 +1,14 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <atomic>
+#include <cstdint>
+
+// Kernels of the library that program_tests.cpp loads from its image. Like
+// ahead-of-time compiled kernels, they are exported under their own name and
+// take their arguments as an array of pointers.
+extern "C" void countItems(void *const *args, void *) {
+    static_cast<std::atomic<uint32_t> *>(args[0])->fetch_add(1);
+}
@@ -0,0 +1,88 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "fixtures.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> readKernelLibrary() {
+    std::ifstream file(KERNEL_LIBRARY, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>()};
+}
+
+// Marks the binary as a shared library of kernels
+const ur_program_metadata_t libraryMetadata = {
+    "@native_cpu_shared_library", UR_PROGRAM_METADATA_TYPE_UINT32, 0, {1}};
+const ur_program_properties_t libraryProperties = {
+    UR_STRUCTURE_TYPE_PROGRAM_PROPERTIES, nullptr, 1, &libraryMetadata};
+
+using nativeCpuProgramTest = nativeCpuQueueTest;
+
+} // namespace
+
+TEST_F(nativeCpuProgramTest, LoadsSharedLibrary) {
+    auto image = readKernelLibrary();
+    ASSERT_FALSE(image.empty());
+    const uint8_t *binary = image.data();
+    size_t length = image.size();
+    ur_program_handle_t program = nullptr;
+    ASSERT_SUCCESS(urProgramCreateWithBinary(context, 1, &device, &length,
+                                             &binary, &libraryProperties,
+                                             &program));
+    // The library is loaded from its own copy of the image
+    image.assign(image.size(), 0);
+
+    ur_kernel_handle_t missing = nullptr;
+    ASSERT_EQ(urKernelCreate(program, "notAKernel", &missing),
+              UR_RESULT_ERROR_INVALID_KERNEL);
+
+    ur_kernel_handle_t kernel = nullptr;
+    ASSERT_SUCCESS(urKernelCreate(program, "countItems", &kernel));
+    // Kernels keep the library loaded
+    ASSERT_SUCCESS(urProgramRelease(program));
+
+    std::atomic<uint32_t> count = 0;
+    ASSERT_SUCCESS(urKernelSetArgPointer(kernel, 0, nullptr, &count));
+    const size_t offset = 0;
+    const size_t globalSize = 100;
+    ASSERT_SUCCESS(urEnqueueKernelLaunch(queue, kernel, 1, &offset,
+                                         &globalSize, nullptr, 0, nullptr,
+                                         nullptr));
+    ASSERT_SUCCESS(urQueueFinish(queue));
+    ASSERT_EQ(count.load(), globalSize);
+    ASSERT_SUCCESS(urKernelRelease(kernel));
+}
+
+TEST_F(nativeCpuProgramTest, SharedLibraryAsIL) {
+    auto image = readKernelLibrary();
+    ur_program_handle_t program = nullptr;
+    // Without the metadata the image isn't known to be a library
+    ASSERT_EQ(urProgramCreateWithIL(context, image.data(), image.size(),
+                                    nullptr, &program),
+              UR_RESULT_ERROR_UNSUPPORTED_FEATURE);
+    ASSERT_SUCCESS(urProgramCreateWithIL(context, image.data(), image.size(),
+                                         &libraryProperties, &program));
+    ur_kernel_handle_t kernel = nullptr;
+    ASSERT_SUCCESS(urKernelCreate(program, "countItems", &kernel));
+    ASSERT_SUCCESS(urKernelRelease(kernel));
+    ASSERT_SUCCESS(urProgramRelease(program));
+}
+
+TEST_F(nativeCpuProgramTest, InvalidSharedLibrary) {
+    std::vector<uint8_t> image(256, 0xAB);
+    const uint8_t *binary = image.data();
+    size_t length = image.size();
+    ur_program_handle_t program = nullptr;
+    ASSERT_EQ(urProgramCreateWithBinary(context, 1, &device, &length, &binary,
+                                        &libraryProperties, &program),
+              UR_RESULT_ERROR_INVALID_BINARY);
+}
@@ -0,0 +1,165 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "fixtures.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Waits, for up to a few seconds, until both of the kernels in argument 0 have
+// arrived, and records in argument 1 whether they did.
+void rendezvous(void *const *args, void *) {
+    auto *arrived = static_cast<std::atomic<uint32_t> *>(args[0]);
+    arrived->fetch_add(1);
+    using clock = std::chrono::steady_clock;
+    const auto deadline = clock::now() + std::chrono::seconds(5);
+    while (arrived->load() < 2 && clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    *static_cast<bool *>(args[1]) = arrived->load() >= 2;
+}
+
+// Sets the flag in argument 0, after giving later commands time to overtake.
+void setFlagLate(void *const *args, void *) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    static_cast<std::atomic<uint32_t> *>(args[0])->store(1);
+}
+
+// Copies the flag in argument 0 to argument 1.
+void readFlag(void *const *args, void *) {
+    *static_cast<uint32_t *>(args[1]) =
+        static_cast<std::atomic<uint32_t> *>(args[0])->load();
+}
+
+struct nativeCpuOutOfOrderQueueTest : nativeCpuContextTest {
+    void SetUp() override {
+        ASSERT_NO_FATAL_FAILURE(nativeCpuContextTest::SetUp());
+        ur_queue_properties_t props = {
+            UR_STRUCTURE_TYPE_QUEUE_PROPERTIES, nullptr,
+            UR_QUEUE_FLAG_OUT_OF_ORDER_EXEC_MODE_ENABLE};
+        ASSERT_SUCCESS(urQueueCreate(context, device, &props, &queue));
+
+        static const struct {
+            const char *name;
+            const void *kernel;
+        } table[] = {
+            {"rendezvous", reinterpret_cast<const void *>(rendezvous)},
+            {"setFlagLate", reinterpret_cast<const void *>(setFlagLate)},
+            {"readFlag", reinterpret_cast<const void *>(readFlag)},
+            {nullptr, nullptr}};
+        const uint8_t *binary = reinterpret_cast<const uint8_t *>(table);
+        ASSERT_SUCCESS(urProgramCreateWithBinary(context, 1, &device, nullptr,
+                                                 &binary, nullptr, &program));
+    }
+
+    void TearDown() override {
+        if (program) {
+            EXPECT_SUCCESS(urProgramRelease(program));
+        }
+        if (queue) {
+            EXPECT_SUCCESS(urQueueRelease(queue));
+        }
+        nativeCpuContextTest::TearDown();
+    }
+
+    // Launches a single work-item of `kernel`, whose arguments are pointers.
+    void launch(ur_kernel_handle_t kernel, void *arg0, void *arg1 = nullptr) {
+        ASSERT_SUCCESS(urKernelSetArgPointer(kernel, 0, nullptr, arg0));
+        if (arg1) {
+            ASSERT_SUCCESS(urKernelSetArgPointer(kernel, 1, nullptr, arg1));
+        }
+        const size_t offset = 0, size = 1;
+        ASSERT_SUCCESS(urEnqueueKernelLaunch(queue, kernel, 1, &offset, &size,
+                                             nullptr, 0, nullptr, nullptr));
+    }
+
+    ur_queue_handle_t queue = nullptr;
+    ur_program_handle_t program = nullptr;
+};
+
+} // namespace
+
+// Independent commands of an out-of-order queue run at the same time, each
+// of the two kernels only finishes in time if the other one runs with it.
+TEST_F(nativeCpuOutOfOrderQueueTest, IndependentCommandsOverlap) {
+    uint32_t numThreads = 0;
+    ASSERT_SUCCESS(urDeviceGetInfo(device, UR_DEVICE_INFO_MAX_COMPUTE_UNITS,
+                                   sizeof(numThreads), &numThreads, nullptr));
+    if (numThreads < 2) {
+        GTEST_SKIP() << "needs at least two threads, set "
+                        "SYCL_NATIVE_CPU_HOST_THREADS";
+    }
+
+    ur_kernel_handle_t kernel = nullptr;
+    ASSERT_SUCCESS(urKernelCreate(program, "rendezvous", &kernel));
+    std::atomic<uint32_t> arrived{0};
+    bool met[2] = {false, false};
+    ASSERT_NO_FATAL_FAILURE(launch(kernel, &arrived, &met[0]));
+    ASSERT_NO_FATAL_FAILURE(launch(kernel, &arrived, &met[1]));
+    ASSERT_SUCCESS(urQueueFinish(queue));
+    ASSERT_TRUE(met[0]);
+    ASSERT_TRUE(met[1]);
+    ASSERT_SUCCESS(urKernelRelease(kernel));
+}
+
+// Commands enqueued after a barrier wait for the ones enqueued before it.
+TEST_F(nativeCpuOutOfOrderQueueTest, BarrierOrdersLaterCommands) {
+    ur_kernel_handle_t setFlag = nullptr, read = nullptr;
+    ASSERT_SUCCESS(urKernelCreate(program, "setFlagLate", &setFlag));
+    ASSERT_SUCCESS(urKernelCreate(program, "readFlag", &read));
+    std::atomic<uint32_t> flag{0};
+    uint32_t seen = 0;
+    ASSERT_NO_FATAL_FAILURE(launch(setFlag, &flag));
+    ASSERT_SUCCESS(
+        urEnqueueEventsWaitWithBarrier(queue, 0, nullptr, nullptr));
+    ASSERT_NO_FATAL_FAILURE(launch(read, &flag, &seen));
+    ASSERT_SUCCESS(urQueueFinish(queue));
+    ASSERT_EQ(seen, 1u);
+    ASSERT_SUCCESS(urKernelRelease(setFlag));
+    ASSERT_SUCCESS(urKernelRelease(read));
+}
+
+using nativeCpuNativeCommandTest = nativeCpuQueueTest;
+
+// Native commands of an in-order queue run on the device's thread pool once
+// the commands before them have completed, and complete their event.
+TEST_F(nativeCpuNativeCommandTest, RunsOnPoolAfterEarlierCommands) {
+    std::vector<uint32_t> values(1 << 20, 0);
+    const uint32_t pattern = 42;
+    ASSERT_SUCCESS(urEnqueueUSMFill(queue, values.data(), sizeof(pattern),
+                                    &pattern, values.size() * sizeof(pattern),
+                                    0, nullptr, nullptr));
+
+    struct command_data {
+        const std::vector<uint32_t> *values;
+        std::thread::id thread;
+        bool sawFill;
+    } data = {&values, {}, false};
+    ur_event_handle_t event = nullptr;
+    ASSERT_SUCCESS(urEnqueueNativeCommandExp(
+        queue,
+        [](ur_queue_handle_t, void *userData) {
+            auto data = static_cast<command_data *>(userData);
+            data->thread = std::this_thread::get_id();
+            data->sawFill = data->values->back() == 42;
+        },
+        &data, 0, nullptr, nullptr, 0, nullptr, &event));
+    ASSERT_SUCCESS(urEventWait(1, &event));
+
+    ur_event_status_t status = UR_EVENT_STATUS_QUEUED;
+    ASSERT_SUCCESS(urEventGetInfo(event,
+                                  UR_EVENT_INFO_COMMAND_EXECUTION_STATUS,
+                                  sizeof(status), &status, nullptr));
+    ASSERT_EQ(status, UR_EVENT_STATUS_COMPLETE);
+    ASSERT_TRUE(data.sawFill);
+    ASSERT_NE(data.thread, std::thread::id{});
+    ASSERT_NE(data.thread, std::this_thread::get_id());
+    ASSERT_SUCCESS(urEventRelease(event));
+}
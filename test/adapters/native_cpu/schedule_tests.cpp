@@ -0,0 +1,165 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "schedule.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using native_cpu::guided_schedule;
+using native_cpu::node_schedule;
+
+namespace {
+
+// Claims every range on the calling thread, checking that they are
+// contiguous, and returns their sizes.
+template <typename Next> std::vector<size_t> claimAll(size_t size, Next next) {
+    std::vector<size_t> chunks;
+    size_t expected = 0, begin, end;
+    while (next(begin, end)) {
+        EXPECT_EQ(begin, expected);
+        EXPECT_LT(begin, end);
+        chunks.push_back(end - begin);
+        expected = end;
+    }
+    EXPECT_EQ(expected, size);
+    return chunks;
+}
+
+} // namespace
+
+TEST(GuidedScheduleTest, ChunksShrink) {
+    constexpr size_t size = 100000;
+    constexpr size_t numThreads = 4;
+    guided_schedule schedule(size, numThreads);
+    auto chunks = claimAll(size, [&](size_t &begin, size_t &end) {
+        return schedule.next(begin, end);
+    });
+    // The first claim takes a share of the whole range, later ones less
+    ASSERT_EQ(chunks.front(), size / (2 * numThreads));
+    for (size_t i = 1; i < chunks.size(); i++) {
+        ASSERT_LE(chunks[i], chunks[i - 1]) << "claim " << i;
+    }
+    // but never drop below the minimum, except for the last one
+    const size_t minChunk = size / (2 * numThreads * 16);
+    for (size_t i = 0; i + 1 < chunks.size(); i++) {
+        ASSERT_GE(chunks[i], minChunk) << "claim " << i;
+    }
+}
+
+TEST(GuidedScheduleTest, SmallAndEmptyRanges) {
+    guided_schedule single(1, 8);
+    auto chunks = claimAll(1, [&](size_t &begin, size_t &end) {
+        return single.next(begin, end);
+    });
+    ASSERT_EQ(chunks, std::vector<size_t>{1});
+
+    guided_schedule empty(0, 8);
+    size_t begin, end;
+    ASSERT_FALSE(empty.next(begin, end));
+}
+
+TEST(GuidedScheduleTest, Reset) {
+    constexpr size_t size = 1000;
+    guided_schedule schedule(size, 2);
+    auto next = [&](size_t &begin, size_t &end) {
+        return schedule.next(begin, end);
+    };
+    auto first = claimAll(size, next);
+    schedule.reset();
+    ASSERT_EQ(claimAll(size, next), first);
+}
+
+TEST(GuidedScheduleTest, ConcurrentClaimsCoverRangeOnce) {
+    constexpr size_t size = 1 << 20;
+    constexpr size_t numThreads = 8;
+    guided_schedule schedule(size, numThreads);
+    std::vector<std::atomic<uint8_t>> claimed(size);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++) {
+        threads.emplace_back([&]() {
+            size_t begin, end;
+            while (schedule.next(begin, end)) {
+                for (size_t i = begin; i < end; i++) {
+                    claimed[i].fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (size_t i = 0; i < size; i++) {
+        ASSERT_EQ(claimed[i].load(), 1) << "unit " << i;
+    }
+}
+
+TEST(NodeScheduleTest, SingleNode) {
+    constexpr size_t size = 5000;
+    node_schedule schedule(size, {4});
+    claimAll(size, [&](size_t &begin, size_t &end) {
+        return schedule.next(0, begin, end);
+    });
+}
+
+TEST(NodeScheduleTest, WorkersClaimTheirNodeFirst) {
+    constexpr size_t size = 9000;
+    // Node 1 has twice the workers, so it gets twice the range
+    node_schedule schedule(size, {2, 4});
+    const size_t split = size / 3;
+
+    size_t begin, end;
+    size_t claimed = 0;
+    while (claimed < size - split) {
+        ASSERT_TRUE(schedule.next(1, begin, end));
+        ASSERT_GE(begin, split);
+        ASSERT_LE(end, size);
+        claimed += end - begin;
+    }
+    // Once its part is exhausted, node 1 helps with node 0's part
+    ASSERT_TRUE(schedule.next(1, begin, end));
+    ASSERT_LE(end, split);
+    claimed += end - begin;
+    while (schedule.next(0, begin, end)) {
+        ASSERT_LE(end, split);
+        claimed += end - begin;
+    }
+    ASSERT_EQ(claimed, size);
+    ASSERT_FALSE(schedule.next(1, begin, end));
+
+    schedule.reset();
+    ASSERT_TRUE(schedule.next(0, begin, end));
+    ASSERT_EQ(begin, 0u);
+}
+
+TEST(NodeScheduleTest, ConcurrentClaimsCoverRangeOnce) {
+    constexpr size_t size = 100003;
+    const std::vector<size_t> workersPerNode = {3, 1, 4};
+    node_schedule schedule(size, workersPerNode);
+    std::vector<std::atomic<uint8_t>> claimed(size);
+    std::vector<std::thread> threads;
+    for (size_t node = 0; node < workersPerNode.size(); node++) {
+        for (size_t w = 0; w < workersPerNode[node]; w++) {
+            threads.emplace_back([&, node]() {
+                size_t begin, end;
+                while (schedule.next(node, begin, end)) {
+                    for (size_t i = begin; i < end; i++) {
+                        claimed[i].fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            });
+        }
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (size_t i = 0; i < size; i++) {
+        ASSERT_EQ(claimed[i].load(), 1) << "unit " << i;
+    }
+}
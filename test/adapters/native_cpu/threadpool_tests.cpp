@@ -0,0 +1,217 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "threadpool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using native_cpu::detail::work_stealing_deque;
+
+TEST(nativeCpuWorkStealingDeque, OwnerPopsNewestFirst) {
+    work_stealing_deque<int> deque;
+    EXPECT_TRUE(deque.empty());
+    for (int i = 0; i < 3; i++) {
+        deque.push(i);
+    }
+    EXPECT_EQ(deque.pop(), 2);
+    EXPECT_EQ(deque.pop(), 1);
+    EXPECT_EQ(deque.pop(), 0);
+    EXPECT_FALSE(deque.pop().has_value());
+    EXPECT_TRUE(deque.empty());
+}
+
+TEST(nativeCpuWorkStealingDeque, ThievesStealOldestFirst) {
+    work_stealing_deque<int> deque;
+    for (int i = 0; i < 3; i++) {
+        deque.push(i);
+    }
+    EXPECT_EQ(deque.steal(), 0);
+    EXPECT_EQ(deque.steal(), 1);
+    EXPECT_EQ(deque.pop(), 2);
+    EXPECT_FALSE(deque.steal().has_value());
+}
+
+TEST(nativeCpuWorkStealingDeque, GrowsPastItsCapacity) {
+    work_stealing_deque<int> deque(4);
+    // Steal a few first, so that the live range wraps around the ring
+    for (int i = 0; i < 3; i++) {
+        deque.push(i);
+    }
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(deque.steal(), i);
+    }
+    for (int i = 0; i < 100; i++) {
+        deque.push(i);
+    }
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(deque.steal(), i);
+    }
+    EXPECT_TRUE(deque.empty());
+}
+
+// Every item is taken exactly once, by the owner or by one of the thieves.
+TEST(nativeCpuWorkStealingDeque, ConcurrentStealsTakeEachItemOnce) {
+    constexpr int numItems = 100000;
+    constexpr int numThieves = 3;
+    work_stealing_deque<int> deque(16);
+    std::vector<std::atomic<int>> taken(numItems);
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < numThieves; t++) {
+        thieves.emplace_back([&]() {
+            while (!done.load(std::memory_order_acquire) || !deque.empty()) {
+                if (auto item = deque.steal()) {
+                    taken[*item]++;
+                }
+            }
+        });
+    }
+    for (int i = 0; i < numItems; i++) {
+        deque.push(i);
+        if (i % 3 == 0) {
+            if (auto item = deque.pop()) {
+                taken[*item]++;
+            }
+        }
+    }
+    while (auto item = deque.pop()) {
+        taken[*item]++;
+    }
+    done.store(true, std::memory_order_release);
+    for (auto &thief : thieves) {
+        thief.join();
+    }
+
+    for (int i = 0; i < numItems; i++) {
+        ASSERT_EQ(taken[i].load(), 1) << "item " << i;
+    }
+}
+
+namespace {
+
+void setNumThreads(const char *value) {
+    if (value) {
+        setenv("SYCL_NATIVE_CPU_HOST_THREADS", value, 1);
+    } else {
+        unsetenv("SYCL_NATIVE_CPU_HOST_THREADS");
+    }
+}
+
+// Schedules `numTasks` tasks, with every priority, and waits for them.
+template <typename PoolT> void runTasks(PoolT &pool, size_t numTasks) {
+    std::atomic<size_t> count{0};
+    const native_cpu::task_priority priorities[] = {
+        native_cpu::task_priority::high, native_cpu::task_priority::normal,
+        native_cpu::task_priority::low};
+    for (size_t i = 0; i < numTasks; i++) {
+        pool.schedule(
+            [&count, &pool](size_t threadId) {
+                EXPECT_LT(threadId, pool.num_threads());
+                count++;
+            },
+            priorities[i % 3]);
+    }
+    native_cpu::worker_task_t bulk = [&count](size_t) { count++; };
+    pool.schedule_bulk(bulk, numTasks);
+    while (count.load() < 2 * numTasks) {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace
+
+template <typename PoolT> struct nativeCpuThreadPool : ::testing::Test {};
+
+using ThreadPoolTypes = ::testing::Types<native_cpu::work_stealing_threadpool_t,
+                                         native_cpu::simple_threadpool_t>;
+TYPED_TEST_SUITE(nativeCpuThreadPool, ThreadPoolTypes);
+
+TYPED_TEST(nativeCpuThreadPool, RunsEveryTask) {
+    setNumThreads("4");
+    TypeParam pool;
+    EXPECT_EQ(pool.num_threads(), 4u);
+    runTasks(pool, 1000);
+    setNumThreads(nullptr);
+}
+
+// Asking for no threads, or running where the number of hardware threads is
+// unknown, still gives a pool that runs tasks.
+TYPED_TEST(nativeCpuThreadPool, AtLeastOneWorker) {
+    setNumThreads("0");
+    EXPECT_EQ(native_cpu::detail::get_num_threads(), 1u);
+    TypeParam pool;
+    EXPECT_EQ(pool.num_threads(), 1u);
+    runTasks(pool, 100);
+    setNumThreads(nullptr);
+}
+
+TYPED_TEST(nativeCpuThreadPool, EmptyPlacementGetsOneWorker) {
+    TypeParam pool{std::vector<native_cpu::worker_placement>{}};
+    EXPECT_EQ(pool.num_threads(), 1u);
+    ASSERT_EQ(pool.workers_per_node().size(), 1u);
+    EXPECT_EQ(pool.workers_per_node()[0], 1u);
+    runTasks(pool, 100);
+}
+
+TYPED_TEST(nativeCpuThreadPool, WorkersKeepTheirNodes) {
+    std::vector<native_cpu::worker_placement> placement(3);
+    placement[1].node = 1;
+    placement[2].node = 1;
+    TypeParam pool{std::move(placement)};
+    EXPECT_EQ(pool.workers_per_node(), (std::vector<size_t>{1, 2}));
+    EXPECT_EQ(pool.worker_node(0), 0u);
+    EXPECT_EQ(pool.worker_node(1), 1u);
+    EXPECT_EQ(pool.worker_node(2), 1u);
+    runTasks(pool, 100);
+}
+
+// Injected tasks of high priority are taken before normal ones, whichever
+// were scheduled first, and low priority ones come last.
+TEST(nativeCpuWorkStealingThreadPool, HighPriorityTasksRunFirst) {
+    native_cpu::work_stealing_threadpool_t pool{
+        std::vector<native_cpu::worker_placement>(1)};
+    // Keep the only worker busy while the other tasks are queued
+    std::atomic<bool> started{false}, release{false};
+    pool.schedule([&](size_t) {
+        started = true;
+        while (!release) {
+            std::this_thread::yield();
+        }
+    });
+    while (!started) {
+        std::this_thread::yield();
+    }
+
+    std::mutex mutex;
+    std::vector<native_cpu::task_priority> order;
+    std::atomic<size_t> done{0};
+    for (auto priority :
+         {native_cpu::task_priority::low, native_cpu::task_priority::normal,
+          native_cpu::task_priority::high}) {
+        pool.schedule(
+            [&, priority](size_t) {
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(priority);
+                done++;
+            },
+            priority);
+    }
+    release = true;
+    while (done.load() < 3) {
+        std::this_thread::yield();
+    }
+
+    const std::vector<native_cpu::task_priority> expected = {
+        native_cpu::task_priority::high, native_cpu::task_priority::normal,
+        native_cpu::task_priority::low};
+    ASSERT_EQ(order, expected);
+}
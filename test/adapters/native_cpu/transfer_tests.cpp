@@ -0,0 +1,137 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "fixtures.hpp"
+#include "transfer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using native_cpu::transfer_chunk_size;
+
+namespace {
+
+// Big enough to be split into chunks, and not a multiple of the patterns
+constexpr size_t fillSize = 2 * transfer_chunk_size + 1001;
+
+std::vector<uint8_t> makePattern(size_t size) {
+    std::vector<uint8_t> pattern(size);
+    std::iota(pattern.begin(), pattern.end(), uint8_t{1});
+    return pattern;
+}
+
+struct nativeCpuTransferTest : ::testing::TestWithParam<size_t> {
+    // Workers that aren't pinned, so fills are spread over several threads
+    native_cpu::threadpool_t pool{
+        std::vector<native_cpu::worker_placement>(4)};
+};
+
+} // namespace
+
+// The pattern carries on across the chunks, which each start at a different
+// point of it.
+TEST_P(nativeCpuTransferTest, FillBytes) {
+    const auto pattern = makePattern(GetParam());
+    std::vector<uint8_t> dst(fillSize + 2, 0);
+    native_cpu::fill_bytes(pool, dst.data() + 1, fillSize, pattern.data(),
+                           pattern.size());
+    ASSERT_EQ(dst.front(), 0);
+    ASSERT_EQ(dst.back(), 0);
+    for (size_t i = 0; i < fillSize; i++) {
+        ASSERT_EQ(dst[i + 1], pattern[i % pattern.size()]) << "byte " << i;
+    }
+}
+
+// Rows continue the pattern where the previous row left off, and the
+// padding between rows is left alone.
+TEST_P(nativeCpuTransferTest, Fill2D) {
+    const auto pattern = makePattern(GetParam());
+    const size_t width = 4099;
+    const size_t pitch = width + 13;
+    const size_t height = 2 * transfer_chunk_size / width + 3;
+    std::vector<uint8_t> dst(pitch * height, 0);
+    native_cpu::fill_2d(pool, dst.data(), pitch, width, height,
+                        pattern.data(), pattern.size());
+    for (size_t row = 0; row < height; row++) {
+        for (size_t x = 0; x < pitch; x++) {
+            const uint8_t expected =
+                x < width ? pattern[(row * width + x) % pattern.size()] : 0;
+            ASSERT_EQ(dst[row * pitch + x], expected)
+                << "row " << row << " byte " << x;
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(PatternSizes, nativeCpuTransferTest,
+                         ::testing::Values(1, 2, 3, 4, 7, 16, 100, 128, 255,
+                                           256, 300),
+                         ::testing::PrintToStringParamName());
+
+TEST(nativeCpuTransfer, CopyBytes) {
+    native_cpu::threadpool_t pool{
+        std::vector<native_cpu::worker_placement>(4)};
+    std::vector<uint8_t> src(fillSize);
+    std::iota(src.begin(), src.end(), uint8_t{0});
+    std::vector<uint8_t> dst(fillSize, 0);
+    native_cpu::copy_bytes(pool, dst.data(), src.data(), fillSize);
+    ASSERT_EQ(dst, src);
+
+    // Overlapping ranges copy as if through a temporary
+    std::vector<uint8_t> expected(src.begin(), src.end() - 7);
+    native_cpu::copy_bytes(pool, src.data() + 7, src.data(), fillSize - 7);
+    ASSERT_TRUE(std::equal(expected.begin(), expected.end(), src.begin() + 7));
+}
+
+using nativeCpuTransferQueueTest = nativeCpuQueueTest;
+
+// Transfers are queued behind the commands before them rather than waited for
+// on the calling thread, unless they are blocking.
+TEST_F(nativeCpuTransferQueueTest, TransfersDontBlockUnlessAsked) {
+    // Holds up the queue until the test lets it go
+    std::atomic<bool> release{false};
+    ASSERT_SUCCESS(urEnqueueNativeCommandExp(
+        queue,
+        [](ur_queue_handle_t, void *userData) {
+            auto release = static_cast<std::atomic<bool> *>(userData);
+            while (!release->load()) {
+                std::this_thread::yield();
+            }
+        },
+        &release, 0, nullptr, nullptr, 0, nullptr, nullptr));
+
+    std::vector<uint8_t> src(fillSize);
+    std::iota(src.begin(), src.end(), uint8_t{0});
+    std::vector<uint8_t> dst(fillSize, 0), copy(fillSize, 0);
+    const uint8_t pattern = 0xAB;
+    ur_event_handle_t copied = nullptr;
+    ASSERT_SUCCESS(urEnqueueUSMMemcpy(queue, false, dst.data(), src.data(),
+                                      fillSize, 0, nullptr, &copied));
+    ASSERT_SUCCESS(urEnqueueUSMFill(queue, src.data(), sizeof(pattern),
+                                    &pattern, fillSize, 0, nullptr, nullptr));
+    ur_event_status_t status = UR_EVENT_STATUS_COMPLETE;
+    ASSERT_SUCCESS(urEventGetInfo(copied,
+                                  UR_EVENT_INFO_COMMAND_EXECUTION_STATUS,
+                                  sizeof(status), &status, nullptr));
+    ASSERT_NE(status, UR_EVENT_STATUS_COMPLETE);
+
+    // A blocking copy returns once it, and so everything before it, has run
+    release = true;
+    ASSERT_SUCCESS(urEnqueueUSMMemcpy(queue, true, copy.data(), src.data(),
+                                      fillSize, 0, nullptr, nullptr));
+    ASSERT_SUCCESS(urEventGetInfo(copied,
+                                  UR_EVENT_INFO_COMMAND_EXECUTION_STATUS,
+                                  sizeof(status), &status, nullptr));
+    ASSERT_EQ(status, UR_EVENT_STATUS_COMPLETE);
+    for (size_t i = 0; i < fillSize; i++) {
+        ASSERT_EQ(dst[i], uint8_t(i)) << "index " << i;
+        ASSERT_EQ(copy[i], pattern) << "index " << i;
+    }
+    ASSERT_SUCCESS(urEventRelease(copied));
+}
@@ -0,0 +1,50 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "fixtures.hpp"
+
+#include "usm.hpp"
+
+using nativeCpuUSMPoolTest = nativeCpuContextTest;
+
+namespace {
+
+uint32_t contextRefCount(ur_context_handle_t context) {
+    uint32_t refCount = 0;
+    EXPECT_SUCCESS(urContextGetInfo(context, UR_CONTEXT_INFO_REFERENCE_COUNT,
+                                    sizeof(refCount), &refCount, nullptr));
+    return refCount;
+}
+
+} // namespace
+
+TEST_F(nativeCpuUSMPoolTest, PoolKeepsContextAlive) {
+    ur_usm_pool_desc_t desc{UR_STRUCTURE_TYPE_USM_POOL_DESC, nullptr, 0};
+    ur_usm_pool_handle_t pool = nullptr;
+    ASSERT_SUCCESS(urUSMPoolCreate(context, &desc, &pool));
+    EXPECT_EQ(contextRefCount(context), 2u);
+
+    void *ptr = nullptr;
+    ur_usm_desc_t usmDesc{UR_STRUCTURE_TYPE_USM_DESC, nullptr, 0, 0};
+    ASSERT_SUCCESS(urUSMHostAlloc(context, &usmDesc, pool, 64, &ptr));
+
+    // Releasing the pool frees the allocation through the context
+    ASSERT_SUCCESS(urUSMPoolRelease(pool));
+    EXPECT_EQ(contextRefCount(context), 1u);
+}
+
+// Device and shared allocations keep the disjoint pool's own defaults.
+TEST(nativeCpuUSMPoolConfig, DefaultsArePerMemoryType) {
+    auto configs = native_cpu::InitializeDisjointPoolConfig();
+    usm::DisjointPoolAllConfigs defaults;
+    for (int type = 0; type < usm::DisjointPoolMemType::All; type++) {
+        EXPECT_EQ(configs.Configs[type].MaxPoolableSize,
+                  defaults.Configs[type].MaxPoolableSize);
+        EXPECT_EQ(configs.Configs[type].Capacity,
+                  defaults.Configs[type].Capacity);
+        EXPECT_EQ(configs.Configs[type].SlabMinSize,
+                  defaults.Configs[type].SlabMinSize);
+    }
+}
@@ -0,0 +1,113 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "fixtures.hpp"
+#include "virtual_mem.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+using native_cpu::virtual_access_map;
+
+namespace {
+
+constexpr auto readWrite = UR_VIRTUAL_MEM_ACCESS_FLAG_READ_WRITE;
+constexpr auto readOnly = UR_VIRTUAL_MEM_ACCESS_FLAG_READ_ONLY;
+
+} // namespace
+
+TEST(nativeCpuVirtualAccessMap, FindsContainingRange) {
+    virtual_access_map map;
+    ASSERT_FALSE(map.find(100).has_value());
+    map.assign(100, 200, readWrite);
+    map.assign(300, 400, readOnly);
+    ASSERT_FALSE(map.find(99).has_value());
+    ASSERT_EQ(map.find(100), readWrite);
+    ASSERT_EQ(map.find(199), readWrite);
+    ASSERT_FALSE(map.find(200).has_value());
+    ASSERT_EQ(map.find(350), readOnly);
+    ASSERT_FALSE(map.find(400).has_value());
+}
+
+TEST(nativeCpuVirtualAccessMap, AssignSplitsRanges) {
+    virtual_access_map map;
+    map.assign(100, 400, readWrite);
+    // The middle of the range changes, both ends keep their flags
+    map.assign(200, 300, readOnly);
+    ASSERT_EQ(map.find(150), readWrite);
+    ASSERT_EQ(map.find(200), readOnly);
+    ASSERT_EQ(map.find(299), readOnly);
+    ASSERT_EQ(map.find(300), readWrite);
+    ASSERT_EQ(map.find(399), readWrite);
+
+    // A range overlapping the ends of two others
+    map.assign(250, 350, readWrite);
+    ASSERT_EQ(map.find(249), readOnly);
+    ASSERT_EQ(map.find(250), readWrite);
+    ASSERT_EQ(map.find(349), readWrite);
+
+    // Forgetting a range covering several others
+    map.assign(120, 380, std::nullopt);
+    ASSERT_EQ(map.find(119), readWrite);
+    ASSERT_FALSE(map.find(120).has_value());
+    ASSERT_FALSE(map.find(300).has_value());
+    ASSERT_FALSE(map.find(379).has_value());
+    ASSERT_EQ(map.find(380), readWrite);
+}
+
+#ifdef __linux__
+TEST_F(nativeCpuContextTest, VirtualMemMapping) {
+    bool supported = false;
+    ASSERT_SUCCESS(urDeviceGetInfo(device,
+                                   UR_DEVICE_INFO_VIRTUAL_MEMORY_SUPPORT,
+                                   sizeof(supported), &supported, nullptr));
+    ASSERT_TRUE(supported);
+
+    size_t pageSize = 0;
+    ASSERT_SUCCESS(urVirtualMemGranularityGetInfo(
+        context, device, UR_VIRTUAL_MEM_GRANULARITY_INFO_MINIMUM,
+        sizeof(pageSize), &pageSize, nullptr));
+    ASSERT_GT(pageSize, 0u);
+
+    void *start = nullptr;
+    ASSERT_SUCCESS(urVirtualMemReserve(context, nullptr, 4 * pageSize, &start));
+    auto *bytes = static_cast<char *>(start);
+    ur_physical_mem_handle_t physical = nullptr;
+    ASSERT_SUCCESS(
+        urPhysicalMemCreate(context, device, pageSize, nullptr, &physical));
+
+    // Both mappings share the physical page
+    ASSERT_SUCCESS(urVirtualMemMap(context, bytes + pageSize, pageSize,
+                                   physical, 0, readWrite));
+    ASSERT_SUCCESS(urVirtualMemMap(context, bytes + 3 * pageSize, pageSize,
+                                   physical, 0, readOnly));
+    // Mappings keep the physical memory alive
+    ASSERT_SUCCESS(urPhysicalMemRelease(physical));
+    std::memset(bytes + pageSize, 0x5A, pageSize);
+    ASSERT_EQ(bytes[3 * pageSize + pageSize - 1], 0x5A);
+
+    auto access = [&](size_t page) {
+        ur_virtual_mem_access_flags_t flags = ~0u;
+        EXPECT_SUCCESS(urVirtualMemGetInfo(
+            context, bytes + page * pageSize, pageSize,
+            UR_VIRTUAL_MEM_INFO_ACCESS_MODE, sizeof(flags), &flags, nullptr));
+        return flags;
+    };
+    ASSERT_EQ(access(0), 0u);
+    ASSERT_EQ(access(1), readWrite);
+    ASSERT_EQ(access(3), readOnly);
+
+    ASSERT_SUCCESS(
+        urVirtualMemSetAccess(context, bytes + pageSize, pageSize, readOnly));
+    ASSERT_EQ(access(1), readOnly);
+    ASSERT_SUCCESS(urVirtualMemUnmap(context, bytes + pageSize, pageSize));
+    ASSERT_EQ(access(1), 0u);
+    ASSERT_EQ(access(3), readOnly);
+
+    ASSERT_SUCCESS(urVirtualMemFree(context, start, 4 * pageSize));
+    ASSERT_EQ(access(3), 0u);
+}
+#endif
@@ -265,8 +265,13 @@ struct TestKernel {
     virtual void setUpKernel() = 0;
 
     virtual void destroyKernel() {
-        ASSERT_SUCCESS(urKernelRelease(Kernel));
-        ASSERT_SUCCESS(urProgramRelease(Program));
+        // The kernel may not have been built if SetUp failed
+        if (Kernel) {
+            ASSERT_SUCCESS(urKernelRelease(Kernel));
+        }
+        if (Program) {
+            ASSERT_SUCCESS(urProgramRelease(Program));
+        }
     };
 
     virtual void validate() = 0;
@@ -275,8 +280,8 @@ struct TestKernel {
     ur_platform_handle_t Platform;
     ur_context_handle_t Context;
     ur_device_handle_t Device;
-    ur_program_handle_t Program;
-    ur_kernel_handle_t Kernel;
+    ur_program_handle_t Program = nullptr;
+    ur_kernel_handle_t Kernel = nullptr;
 };
 
 struct urCommandBufferMultipleKernelUpdateTest
@@ -212,7 +212,7 @@ struct TestFill2DKernel : public uur::command_buffer::TestKernel {
     std::vector<size_t> GlobalOffset = {0, 0};
     uint32_t NDimensions = 2;
 
-    void *Memory;
+    void *Memory = nullptr;
     uint32_t Val = 42;
 };
 
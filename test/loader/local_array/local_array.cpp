@@ -0,0 +1,82 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "ur_object.hpp"
+
+#include <cstddef>
+#include <gtest/gtest.h>
+
+namespace {
+
+// Arrays of up to 16 elements are inline by default
+constexpr size_t inlineSize = 16;
+using array_t = local_array_t<size_t>;
+
+bool isInline(array_t &array) {
+    auto begin = reinterpret_cast<char *>(&array);
+    auto data = reinterpret_cast<char *>(array.data());
+    return data >= begin && data < begin + sizeof(array);
+}
+
+void fill(array_t &array, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        array[i] = i * 3;
+    }
+}
+
+void check(array_t &array, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        ASSERT_EQ(array[i], i * 3) << "index " << i;
+    }
+}
+
+} // namespace
+
+TEST(LocalArrayTest, Empty) {
+    array_t array(0);
+    ASSERT_EQ(array.data(), nullptr);
+}
+
+TEST(LocalArrayTest, Inline) {
+    array_t array(inlineSize);
+    ASSERT_TRUE(isInline(array));
+    fill(array, inlineSize);
+    check(array, inlineSize);
+}
+
+TEST(LocalArrayTest, Borrowed) {
+    array_t array(inlineSize + 1);
+    ASSERT_NE(array.data(), nullptr);
+    ASSERT_FALSE(isInline(array));
+    fill(array, inlineSize + 1);
+    check(array, inlineSize + 1);
+}
+
+TEST(LocalArrayTest, BufferIsReused) {
+    size_t *first;
+    {
+        array_t array(inlineSize + 1);
+        first = array.data();
+    }
+    // The buffer went back to the thread's cache, and is big enough
+    array_t array(inlineSize + 1);
+    ASSERT_EQ(array.data(), first);
+    fill(array, inlineSize + 1);
+    check(array, inlineSize + 1);
+}
+
+TEST(LocalArrayTest, NestedArraysDontShare) {
+    array_t outer(inlineSize + 1);
+    fill(outer, inlineSize + 1);
+    {
+        // As when a call re-enters the loader on the same thread
+        array_t inner(inlineSize * 4);
+        ASSERT_NE(inner.data(), outer.data());
+        for (size_t i = 0; i < inlineSize * 4; i++) {
+            inner[i] = 0;
+        }
+    }
+    check(outer, inlineSize + 1);
+}
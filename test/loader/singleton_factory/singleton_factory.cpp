@@ -0,0 +1,149 @@
+// Copyright (C) 2024 Intel Corporation
+// Part of the Unified-Runtime Project, under the Apache License v2.0 with LLVM Exceptions.
+// See LICENSE.TXT
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "ur_singleton.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct handle_t_;
+using handle_t = handle_t_ *;
+
+handle_t makeHandle(size_t i) {
+    // Handles are aligned pointers, so the low bits of the keys are clear
+    return reinterpret_cast<handle_t>((i + 1) * 64);
+}
+
+struct object_t {
+    object_t(handle_t handle, int value) : handle(handle), value(value) {
+        if (value < 0) {
+            throw std::runtime_error("invalid value");
+        }
+        live++;
+    }
+    ~object_t() { live--; }
+
+    static inline std::atomic<int> live = 0;
+
+    handle_t handle;
+    int value;
+};
+
+// Exposes the storage the factory holds on to
+struct test_factory_t : singleton_factory_t<object_t, handle_t> {
+    using singleton_factory_t::blockSize;
+    using singleton_factory_t::numShards;
+
+    size_t numBlocks() {
+        size_t count = 0;
+        for (auto &shard : shards) {
+            count += shard.blocks.size();
+        }
+        return count;
+    }
+};
+
+struct SingletonFactoryTest : ::testing::Test {
+    void TearDown() override {
+        factory.clear();
+        ASSERT_EQ(object_t::live, 0);
+    }
+
+    test_factory_t factory;
+};
+
+} // namespace
+
+TEST_F(SingletonFactoryTest, SameKeySameInstance) {
+    object_t *first = factory.getInstance(makeHandle(0), 1);
+    ASSERT_NE(first, nullptr);
+    ASSERT_EQ(first->value, 1);
+    // Later calls don't construct another instance
+    ASSERT_EQ(factory.getInstance(makeHandle(0), 2), first);
+    ASSERT_EQ(first->value, 1);
+    ASSERT_NE(factory.getInstance(makeHandle(1), 2), first);
+    ASSERT_EQ(object_t::live, 2);
+}
+
+TEST_F(SingletonFactoryTest, NullKey) {
+    ASSERT_EQ(factory.getInstance(handle_t{nullptr}, 1), nullptr);
+    ASSERT_EQ(object_t::live, 0);
+}
+
+TEST_F(SingletonFactoryTest, ShardedLookupFromThreads) {
+    constexpr size_t numThreads = 8;
+    constexpr size_t numKeys = 4096;
+    std::vector<std::vector<object_t *>> found(numThreads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; t++) {
+        threads.emplace_back([&, t]() {
+            // Every thread walks the keys from a different starting point
+            for (size_t i = 0; i < numKeys; i++) {
+                size_t key = (i + t * numKeys / numThreads) % numKeys;
+                found[t].push_back(
+                    factory.getInstance(makeHandle(key), int(key)));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(object_t::live, int(numKeys));
+    for (size_t key = 0; key < numKeys; key++) {
+        object_t *object = factory.getInstance(makeHandle(key), 0);
+        ASSERT_EQ(object->handle, makeHandle(key));
+        ASSERT_EQ(object->value, int(key));
+        for (size_t t = 0; t < numThreads; t++) {
+            size_t i = (key + numKeys - t * numKeys / numThreads) % numKeys;
+            ASSERT_EQ(found[t][i], object) << "thread " << t << " key " << key;
+        }
+    }
+}
+
+TEST_F(SingletonFactoryTest, ReleaseReusesStorage) {
+    object_t *first = factory.getInstance(makeHandle(0), 1);
+    factory.release(makeHandle(0));
+    ASSERT_EQ(object_t::live, 0);
+    // Released keys may come back, with a new instance in the same slot
+    object_t *second = factory.getInstance(makeHandle(0), 2);
+    ASSERT_EQ(second, first);
+    ASSERT_EQ(second->value, 2);
+    ASSERT_EQ(factory.numBlocks(), 1u);
+}
+
+TEST_F(SingletonFactoryTest, EmptyBlocksAreFreed) {
+    // Enough handles for several blocks in every shard
+    constexpr size_t numKeys =
+        test_factory_t::numShards * test_factory_t::blockSize * 4;
+    for (size_t key = 0; key < numKeys; key++) {
+        factory.getInstance(makeHandle(key), 1);
+    }
+    ASSERT_GT(factory.numBlocks(), test_factory_t::numShards * 2);
+
+    for (size_t key = 0; key < numKeys; key++) {
+        factory.release(makeHandle(key));
+    }
+    ASSERT_EQ(object_t::live, 0);
+    // Each shard keeps at most one empty block for reuse
+    ASSERT_LE(factory.numBlocks(), test_factory_t::numShards);
+
+    for (size_t key = 0; key < numKeys; key++) {
+        ASSERT_EQ(factory.getInstance(makeHandle(key), 2)->value, 2);
+    }
+}
+
+TEST_F(SingletonFactoryTest, ThrowingConstructor) {
+    ASSERT_THROW(factory.getInstance(makeHandle(0), -1), std::runtime_error);
+    ASSERT_EQ(object_t::live, 0);
+    ASSERT_EQ(factory.getInstance(makeHandle(0), 1)->value, 1);
+}